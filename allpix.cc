@@ -41,8 +41,15 @@
 
 using namespace std;
 
+#ifdef ALLPIX_MT
+#include "G4MTRunManager.hh"
+#include "G4Threading.hh"
+#include "TROOT.h"
+#else
 #include "G4RunManager.hh"
+#endif
 #include "G4UImanager.hh"
+#include "G4SDManager.hh"
 #include "G4UIterminal.hh"
 #include "G4UItcsh.hh"
 #include "G4ios.hh"
@@ -56,12 +63,14 @@ using namespace std;
 #include "AllPixEventAction.hh"
 #include "AllPixRun.hh"
 #include "AllPixRunAction.hh"
+#include "AllPixActionInitialization.hh"
 
 // digits, frames
 #include "AllPix_Frames_WriteToEntuple.h"
 // hits
 #include "AllPix_Hits_WriteToEntuple.h"
 #include "AllPixWriteROOTFile.hh" //nalipour
+#include "AllPixOutputQueue.hh"
 #include "Randomize.hh"
 
 
@@ -125,7 +134,17 @@ int main(int argc, char** argv)
 	G4VSteppingVerbose* verbosity = new AllPixSteppingVerbose;
 	G4VSteppingVerbose::SetInstance(verbosity);
 
+#ifdef ALLPIX_MT
+	// ROOT output is written from the master thread but the hits ntuple
+	//  and the digitizers' ROOT objects are touched by the workers
+	ROOT::EnableThreadSafety();
+	G4MTRunManager * runManager = new G4MTRunManager;
+	// default is one thread per core, can be overridden from the
+	//  macro with /run/numberOfThreads before /run/initialize
+	runManager->SetNumberOfThreads( G4Threading::G4GetNumberOfCores() );
+#else
 	G4RunManager* runManager = new G4RunManager;
+#endif
 
 	// UserInitialization classes - mandatory;
 	AllPixDetectorConstruction * detector =
@@ -136,27 +155,14 @@ int main(int argc, char** argv)
 	G4VUserPhysicsList * physics = new AllPixPhysicsList;
 	runManager->SetUserInitialization(physics);
 
-	// Hits ! --> Ntuple to store hits
-	// creates AllPixRun to analyze hits at the end of event
+	// User actions: run action (hits ntuple, AllPixRun to analyze hits at
+	//  the end of event), particle gun and event action (digits).
+	//  In MT mode these are built once per worker thread.  See AllPixActionInitialization.
 	TString dataset = "allPix";
 	TString tempdir = "";
-	AllPixRunAction * run_action = new AllPixRunAction(detector, dataset, tempdir,
-			"lciobridge_allpix.txt",
-			"lciobridge_allpix_dut.txt"); // dataset
-	runManager->SetUserAction(run_action);
-
-	// Particle gun
-	SourceType st = _GeneralParticleSource;
-	//SourceType st = _HEPEvtInterface;
-	AllPixPrimaryGeneratorAction * gen_action = new AllPixPrimaryGeneratorAction(st);
-	runManager->SetUserAction(gen_action);
-
-	// Get the PrimaryGeneratorMessenger to get a hold of some of its member variables
-	run_action->GetPrimaryGeneratorMessenger(gen_action);
-
-	// Digits ! --> calls Digitize, and makes ntuple to store digits
-	AllPixEventAction * event_action = new AllPixEventAction(run_action);
-	runManager->SetUserAction(event_action);
+	runManager->SetUserInitialization( new AllPixActionInitialization(detector, dataset, tempdir,
+			"lciobridge_allpix",
+			"lciobridge_allpix_dut") );
 
 	// Initialize G4 kernel
 	//
@@ -240,10 +246,15 @@ int main(int argc, char** argv)
 #endif
 
 	// Geo description
-	extern ReadGeoDescription * g_GeoDsc; // already loaded ! :)
-	map<int, AllPixGeoDsc *> * geoMap = g_GeoDsc->GetDetectorsMap();
+	map<int, AllPixGeoDsc *> * geoMap = ReadGeoDescription::GetInstance()->GetDetectorsMap(); // already loaded ! :)
 	map<int, AllPixGeoDsc *>::iterator detItr;
 
+	// master run action in MT mode
+	AllPixRunAction * run_action = (AllPixRunAction *) runManager->GetUserRunAction();
+
+	// writer thread done before closing the files
+	AllPixOutputQueue::GetInstance()->Stop();
+
 	// Frames ntuple closing
 	// G4int nDigitizers = event_action->GetNumberOfDigitizers();
 	for( detItr = geoMap->begin() ; detItr != geoMap->end() ; detItr++) {
@@ -257,7 +268,7 @@ int main(int argc, char** argv)
 	}
 
 	// hits ntuple closing
-	G4int nHC = event_action->GetNumberOfHC();
+	G4int nHC = G4SDManager::GetSDMpointer()->GetHCtable()->entries();
 	for(G4int i = 0 ; i < nHC ; i++)
 		Hits_WriteToNtuple::GetInstance("", "", "", nHC, i)->closeNtuple();
 
@@ -0,0 +1,56 @@
+#ifndef AllPixActionInitialization_h
+#define AllPixActionInitialization_h 1
+
+#include "G4VUserActionInitialization.hh"
+#include "globals.hh"
+
+#include "AllPixPrimaryGeneratorAction.hh"
+
+#include <TString.h>
+
+#include <fstream>
+
+using namespace std;
+
+class AllPixDetectorConstruction;
+class AllPixLCIOBridgeWriter;
+
+/**
+ *  Builds the user actions.  In sequential mode Build() is called
+ *  once, right away.  With a G4MTRunManager Build() is called once
+ *  per worker thread (each worker owns its run, event and primary
+ *  generator actions, hence its own AllPixRun record buffers and
+ *  digitizers), and BuildForMaster() builds the master run action
+ *  which receives the merged AllPixRun and writes the end-of-run output.
+ */
+class AllPixActionInitialization : public G4VUserActionInitialization {
+
+public:
+
+	AllPixActionInitialization(AllPixDetectorConstruction *, TString, TString, TString, TString);
+	virtual ~AllPixActionInitialization();
+
+	virtual void Build() const;
+	virtual void BuildForMaster() const;
+	virtual G4VSteppingVerbose * InitializeSteppingVerbose() const;
+
+private:
+
+	AllPixDetectorConstruction * m_detectorPtr;
+	TString m_dataset;
+	TString m_tempdir;
+
+	// lcio bridge files, shared by all threads
+	AllPixLCIOBridgeWriter * m_lciobridge_f;
+	AllPixLCIOBridgeWriter * m_lciobridge_dut_f;
+
+	SourceType m_sourceType;
+
+	// Only used in MT mode.  The master thread doesn't generate primaries
+	//  but needs a generator (and its messenger) to execute /allpix/beam/
+	//  and /gps/ commands.
+	mutable AllPixPrimaryGeneratorAction * m_masterGenAction;
+
+};
+
+#endif
@@ -14,6 +14,8 @@
 #include "AllPixDigitizerInterface.hh"
 // digits for this digitizer
 #include "AllPixCMSp1Digit.hh"
+#include "AllPixDriftEngine.hh"
+#include "AllPixCarrierBatch.hh"
 #include "G4PrimaryVertex.hh"
 
 #include <map>
@@ -65,6 +67,9 @@ private:
   G4double Target_Spatial_Precision;
   G4double Timestep_max;
   G4double Timestep_min;
+  G4double Drift_Time_Max;  // [s] a group drifting longer is lost
+  G4int Drift_Steps_Max;    // lockstep iterations per batch
+  G4int m_nCutOff;          // groups lost to the two above, this event
   
   G4int Electron_Scaling;
 
@@ -90,18 +95,23 @@ private:
 	G4double Electron_Trap_T0;
 	G4double Electron_Trap_TauNoFluence;
   G4double Electron_Trap_TauEff;
+
+  // drift models, see AllPixDriftEngine.hh.  SI units (m, s, V/m, m2/V/s).
+  AllPixMapField3D m_driftField;
+  AllPixCaugheyThomasMobility m_electronMobility;
+
+  // electron groups of the hit being digitized, propagated together
+  AllPixCarrierBatch m_carriers;
   
   void InitVariables();
   
-  vector<G4double> RKF5Integration(G4ThreeVector position, G4double dt);
-  G4double MobilityElectron(const G4ThreeVector efield);
-  G4ThreeVector ElectronSpeed(const G4ThreeVector efield);
-  G4ThreeVector DiffusionStep(const G4double timestep, const G4ThreeVector position);
   void SetDt(G4double& dt, const G4double uncertainty, const G4double z, const G4double dz);
-  G4double GetTrappingTime();
   inline G4int ADC(const G4double digital);
   
   G4double Propagation(G4ThreeVector& pos, G4double& drifttime, G4bool& trapped);
+  void Propagation(AllPixCarrierBatch & batch);
+  template <class Engine>
+  void Propagation(const Engine & engine, AllPixCarrierBatch & batch);
 
 
 
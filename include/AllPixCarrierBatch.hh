@@ -0,0 +1,116 @@
+#ifndef AllPixCarrierBatch_h
+#define AllPixCarrierBatch_h 1
+
+#include "globals.hh"
+
+#include "CLHEP/Random/RandGauss.h"
+#include "CLHEP/Random/RandFlat.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ *  A batch of charge carriers propagated in lockstep.  The lanes are
+ *  kept in SoA form (one array per coordinate).  A lane leaving the
+ *  sensor or getting trapped is switched off in the alive mask; the
+ *  loops go on until no lane is alive.
+ *
+ *  The propagation loops are not vectorized: every lane does its own
+ *  field lookup (a gather in the 3D map, a ROOT histogram for the 1D
+ *  one), its own adaptive step and the alive test.  The gain is in the
+ *  block random draws and in no allocation per carrier.
+ *
+ *  Random numbers are drawn in blocks (Gauss, Flat) through the
+ *  CLHEP shootArray calls instead of one shoot per lane and step.
+ *
+ *  The arrays only grow: a digitizer keeps one batch and Reset()s it
+ *  per hit, nothing is allocated once the largest batch has been seen.
+ */
+class AllPixCarrierBatch {
+
+public:
+
+	AllPixCarrierBatch() : m_n(0), m_nAlive(0) { };
+	~AllPixCarrierBatch() { };
+
+	// n lanes, all alive and not trapped, starting at (x0, y0, z0), t = 0
+	void Reset(G4int n, G4double x0 = 0., G4double y0 = 0., G4double z0 = 0.) {
+		m_n = n;
+		m_nAlive = n;
+		if ( (G4int)m_x.size() < n ) {
+			m_x.resize(n); m_y.resize(n); m_z.resize(n);
+			m_t.resize(n); m_dt.resize(n); m_tTrap.resize(n);
+			m_alive.resize(n); m_trapped.resize(n);
+		}
+		for ( G4int i = 0 ; i < n ; i++ ) {
+			m_x[i] = x0;
+			m_y[i] = y0;
+			m_z[i] = z0;
+			m_t[i] = 0.;
+			m_dt[i] = 0.;
+			m_tTrap[i] = 0.;
+			m_alive[i] = 1;
+			m_trapped[i] = 0;
+		}
+	};
+
+	G4int Size() const { return m_n; };
+	G4int NAlive() const { return m_nAlive; };
+
+	bool IsAlive(G4int i) const { return m_alive[i] != 0; };
+	bool IsTrapped(G4int i) const { return m_trapped[i] != 0; };
+
+	void Kill(G4int i) {
+		if ( m_alive[i] ) {
+			m_alive[i] = 0;
+			m_nAlive--;
+		}
+	};
+	void Trap(G4int i) {
+		m_trapped[i] = 1;
+		Kill(i);
+	};
+
+	// Lane arrays, Size() entries
+	G4double * X() { return m_x.data(); };
+	G4double * Y() { return m_y.data(); };
+	G4double * Z() { return m_z.data(); };
+	G4double * T() { return m_t.data(); };
+	G4double * Dt() { return m_dt.data(); };
+	G4double * TTrap() { return m_tTrap.data(); };
+
+	// n Gaussian (0, 1) / flat (0, 1) numbers, valid until the next call
+	const G4double * Gauss(G4int n) {
+		if ( n <= 0 ) return 0x0;
+		if ( (G4int)m_rnd.size() < n ) m_rnd.resize(n);
+		CLHEP::RandGauss::shootArray(n, &m_rnd[0], 0., 1.);
+		return m_rnd.data();
+	};
+	const G4double * Flat(G4int n) {
+		if ( n <= 0 ) return 0x0;
+		if ( (G4int)m_rnd.size() < n ) m_rnd.resize(n);
+		CLHEP::RandFlat::shootArray(n, &m_rnd[0]);
+		return m_rnd.data();
+	};
+
+private:
+
+	G4int m_n;
+	G4int m_nAlive;
+
+	vector<G4double> m_x;
+	vector<G4double> m_y;
+	vector<G4double> m_z;
+	vector<G4double> m_t;
+	vector<G4double> m_dt;
+	vector<G4double> m_tTrap;
+	vector<unsigned char> m_alive;
+	vector<unsigned char> m_trapped;
+
+	// random numbers scratch
+	vector<G4double> m_rnd;
+
+};
+
+#endif
@@ -63,6 +63,8 @@ class G4LogicalVolume;
 class G4VPhysicalVolume;
 class AllPixGeoDsc;
 class G4UniformMagField;
+class G4Region;
+class G4ProductionCuts;
 class G4QuadrupoleMagField;
 class MorourgoMagField;
 
@@ -114,6 +116,12 @@ public:
 	void SetLowTHL(G4double);
 	void SetTemperature(G4double);
 	void SetFlux(G4double);
+	void SetSingleSensitiveBox(G4bool);
+	void SetDriftTable(G4bool);
+	void SetBumpModel(G4String);
+	void SetRegionCut(G4double);
+	void SetRegionMaxStep(G4double);
+	void SetFastSimulation(G4String);
 	void UpdateGeometry();
 
   // others
@@ -134,10 +142,13 @@ public:
 public:
 
 	G4VPhysicalVolume* Construct();
+	void ConstructSDandField();
 
 private:
 	// flags
 	bool m_clearanceToBuildGeometry;
+	G4bool m_geometryBuilt;       // Construct() returns the world of the last update
+	G4int m_geometryGeneration;   // counts the updates, SDs built once per update and thread
 
 	// pos rot detector
 	vector<G4int>              m_detId;
@@ -154,8 +165,14 @@ private:
 	vector<G4double>           m_lowThlVector; // lowTHL
 	map<int, G4double>	m_temperatures;
 	map<int, G4double>	m_fluxes;
+	map<int, G4bool>	m_singleSensitiveBox; // no pixel volumes, analytic pixel index
+	map<int, G4bool>	m_driftTable; // tabulated drift in the digitizers
+	map<int, G4String>	m_bumpModel; // parameterised (default), replica or slab
 	// for user information.  Absolute position (center) of the Si wafers
 	vector<G4ThreeVector>      m_absolutePosSiWafer;
+	// needed to build the SDs in ConstructSDandField
+	map<int, G4ThreeVector>      m_absolutePosSD;
+	map<int, G4ThreeVector>      m_relativePosSD;
 
 
 	// pos,rot test structure
@@ -258,14 +275,21 @@ private:
 	bool m_userDefinedWorldMaterial;
 
 	// mad field
-	G4UniformMagField * m_magField;      // pointer to the magnetic field
-	G4ThreeVector m_magField_cartesian;
+	G4ThreeVector m_magField_cartesian;  // [T], built per thread in ConstructSDandField
 	//MorourgoMagField * m_magField;
 
 	// user limits
 	G4UserLimits * m_ulim;
 	G4double m_maxStepLengthSensor;
 
+	// a region per sensor (Sensor_<id>), cuts and max step from the macro
+	map<int, G4Region *> m_sensorRegion;
+	map<int, G4double> m_regionCut;
+	map<int, G4double> m_regionMaxStep;
+	map<int, G4ProductionCuts *> m_regionCuts;  // reused at every update
+	map<int, G4UserLimits *> m_regionLimits;
+	map<int, G4String> m_fastSimulation; // off (default), continue or kill, see AllPixFastPlaneModel
+
   // others
   G4String m_outputFilePrefix;
 
@@ -41,6 +41,8 @@ class G4UIcmdWith3VectorAndUnit;
 class G4UIcmdWithADoubleAndUnit;
 class G4UIcmdWithAString;
 class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+class G4UIcommand;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -78,6 +80,14 @@ private:
   G4UIcmdWithAString * m_worldMaterial;
 
   G4UIcmdWithAString * m_outputPrefix;
+  G4UIcmdWithAString * m_hitsFormatCmd;
+  G4UIcmdWithAString * m_hitsColumnsCmd;
+  G4UIcmdWithAnInteger * m_asyncOutputCmd;
+  G4UIcommand * m_compressionCmd;
+  G4UIcmdWithAnInteger * m_basketSizeCmd;
+  G4UIcmdWithAnInteger * m_autoFlushCmd;
+  G4UIcmdWithAString * m_lcioBridgeFormatCmd;
+  G4UIcmdWithAString * m_geoCacheDirCmd;
 
   G4UIcmdWithADoubleAndUnit * m_HighTHLCmd;
   G4UIcmdWithADoubleAndUnit * m_LowTHLCmd;
@@ -87,6 +97,12 @@ private:
   G4UIcmdWithADoubleAndUnit * m_StepLengthSensor;
   G4UIcmdWithADouble * m_TempCmd;
   G4UIcmdWithADouble * m_FluxCmd;
+  G4UIcmdWithABool * m_singleSensitiveBoxCmd;
+  G4UIcmdWithABool * m_driftTableCmd;
+  G4UIcmdWithAString * m_bumpModelCmd;
+  G4UIcmdWithADoubleAndUnit * m_regionCutCmd;
+  G4UIcmdWithADoubleAndUnit * m_regionMaxStepCmd;
+  G4UIcmdWithAString * m_fastSimulationCmd;
 
   G4UIcmdWithoutParameter   * m_UpdateCmd;
 
@@ -9,6 +9,7 @@
 #include "AllPixMimosa26Digit.hh"
 #include "G4PrimaryVertex.hh"
 #include "ReadGeoDescription.hh"
+#include "AllPixPixelAccumulator.hh"
 
 #include <map>
 #include <vector>
@@ -61,8 +62,17 @@ public:
 protected:
 	AllPixGeoDsc * GetDetectorGeoDscPtr(){ return m_gD; }; // first detector
 
+	// Call once at the beginning of Digitize.  Returns the pixel accumulator
+	//  of this detector, empty.  The buffer is allocated the first time only.
+	AllPixPixelAccumulator & ResetPixelAccumulator(){
+		m_pixelsContent.Init(m_gD->GetNPixelsX(), m_gD->GetNPixelsY());
+		m_pixelsContent.Clear();
+		return m_pixelsContent;
+	};
+
 private:
 	AllPixGeoDsc * m_gD;
+	AllPixPixelAccumulator m_pixelsContent;
 
 };
 
@@ -0,0 +1,18 @@
+/**
+ *  Dictionary of the data model (allpix-dm library, ROOT only): frames
+ *  and hits as they go to the output files.
+ */
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ class FrameStruct+;
+#pragma link C++ class FrameContainer+;
+
+// FrameContainer <= 3 kept the pixels in std::map<int, int>
+#pragma read sourceClass="FrameContainer" targetClass="FrameContainer" version="[-3]" \
+	source="std::map<int, int> m_frameXC; std::map<int, int> m_lvl1; std::map<int, int> m_frameXC_TruthE; std::map<int, int> m_frameXC_E" \
+	target="m_pixelIndex, m_pixelCounts, m_pixelLVL1, m_pixelTruthE, m_pixelE" \
+	code="{ newObj->FillFromMaps(onfile.m_frameXC, onfile.m_lvl1, onfile.m_frameXC_TruthE, onfile.m_frameXC_E); }"
+
+#pragma link C++ class SimpleHits+;
@@ -0,0 +1,259 @@
+#ifndef AllPixDriftEngine_h
+#define AllPixDriftEngine_h 1
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+
+#include "AllPixGeoDsc.hh"
+
+#include <cmath>
+
+/**
+ *  Carrier drift through the sensor with an adaptive Runge-Kutta-Fehlberg
+ *  (RKF45) stepper, shared by the digitizers doing a full field
+ *  propagation (Timepix, Timepix3, FEI3Standard, CMSp1).
+ *
+ *  AllPixDriftEngine is templated on
+ *   - the carrier type (electrons drift against the field, holes along it),
+ *   - the field model: anything with G4ThreeVector operator()(x, y, z) const,
+ *     AllPixLinearField1D or AllPixMapField3D below,
+ *   - the mobility model: anything with G4double operator()(|E|) const,
+ *   - B-field on/off.  With the B-field the drift velocity includes the
+ *     Lorentz deflection (Hall factor r_H):
+ *       v = mu ( qE + mu r_H E x B + q (mu r_H)^2 (E.B) B ) / (1 + (mu r_H B)^2)
+ *     q = -1 for electrons, +1 for holes.
+ *
+ *  The field and the mobility are evaluated once per stage and nothing is
+ *  allocated.  The engine is a few doubles, build it where it's needed.
+ *  Units are the ones of the models: the step is velocity * dt.
+ *
+ *  AllPixDriftThroughSensor below is the full drift (adaptive steps)
+ *  of the FEI3Standard and Timepix3 digitizers, also used to check
+ *  the drift tables (tools/allpix-drift-table-check.cc).
+ */
+
+// One RKF45 step: displacement and error estimate (|5th - 4th order|)
+struct AllPixDriftStep {
+	G4double dx;
+	G4double dy;
+	G4double dz;
+	G4double err;
+};
+
+// End point of a full drift and the drift time
+struct AllPixDriftResult {
+	G4double x;
+	G4double y;
+	G4double z;
+	G4double t;
+};
+
+enum AllPixCarrierType {
+	kAllPixElectron = 0,
+	kAllPixHole
+};
+
+/**
+ *  Field along z only, linear in z, zero beyond the depleted depth.
+ *  Ez = E0 + slope * z.
+ */
+struct AllPixLinearField1D {
+
+	AllPixLinearField1D() : E0(0.), slope(0.), zDepleted(0.) { };
+	AllPixLinearField1D(G4double e0, G4double s, G4double zd) : E0(e0), slope(s), zDepleted(zd) { };
+
+	G4double Ez(G4double z) const {
+		if ( z > zDepleted ) return 0.;
+		return E0 + slope * z;
+	};
+
+	G4ThreeVector operator()(G4double /*x*/, G4double /*y*/, G4double z) const {
+		return G4ThreeVector(0., 0., Ez(z));
+	};
+
+	G4double E0;
+	G4double slope;
+	G4double zDepleted;
+};
+
+/**
+ *  Field map of the detector (AllPixGeoDsc::GetEFieldFromMap).  The
+ *  position is multiplied by lengthUnit before the lookup (the map
+ *  works in mm) and the field by scale after it.
+ */
+struct AllPixMapField3D {
+
+	AllPixMapField3D() : gD(0x0), scale(1.), lengthUnit(1.) { };
+	AllPixMapField3D(AllPixGeoDsc * g, G4double s, G4double lu) : gD(g), scale(s), lengthUnit(lu) { };
+
+	G4ThreeVector operator()(G4double x, G4double y, G4double z) const {
+		return scale * gD->GetEFieldFromMap( G4ThreeVector(x, y, z) * lengthUnit );
+	};
+
+	AllPixGeoDsc * gD;
+	G4double scale;
+	G4double lengthUnit;
+};
+
+/**
+ *  Caughey-Thomas field dependence
+ *  mu(E) = mu0 / (1 + (E/Ec)^beta)^(1/beta)
+ *  (with a saturation velocity vsat, Ec = vsat/mu0)
+ */
+struct AllPixCaugheyThomasMobility {
+
+	AllPixCaugheyThomasMobility() : mu0(0.), Ec(1.), beta(1.) { };
+	AllPixCaugheyThomasMobility(G4double m, G4double e, G4double b) : mu0(m), Ec(e), beta(b) { };
+
+	G4double operator()(G4double E) const {
+		return mu0 * std::pow( 1. + std::pow(E/Ec, beta), -1./beta );
+	};
+
+	G4double mu0;
+	G4double Ec;
+	G4double beta;
+};
+
+/**
+ *  Mobility from a table in steps of the field, table[i] = mu(i*step).
+ *  The table isn't copied, it must live as long as the model.
+ *  Fields above (n-1)*step take the last entry.
+ */
+struct AllPixTabulatedMobility {
+
+	AllPixTabulatedMobility() : table(0x0), step(1.), n(0) { };
+	AllPixTabulatedMobility(const G4double * t, G4double s, G4int nn) : table(t), step(s), n(nn) { };
+
+	G4double operator()(G4double E) const {
+		if ( E < 0. ) return table[0];
+		G4double idx = std::floor( E/step );
+		if ( idx > n - 1 ) return table[n - 1];
+		return table[(G4int)idx];
+	};
+
+	const G4double * table;
+	G4double step;
+	G4int n;
+};
+
+/**
+ *  Adaptive step of the full drift.  The step grows by 10% while the
+ *  error estimate of the last one is under the target and shrinks by
+ *  10% above it, within [tlow, tup].  A NaN error takes tup.
+ *  The default is the accuracy of the FEI3Standard and Timepix3
+ *  digitizers.
+ */
+struct AllPixDriftStepControl {
+
+	AllPixDriftStepControl() : target(1e-4), tlow(0.001*CLHEP::ns), tup(0.1*CLHEP::ns), dtIni(0.01*CLHEP::ns) { };
+	AllPixDriftStepControl(G4double t, G4double tl, G4double tu, G4double ti) : target(t), tlow(tl), tup(tu), dtIni(ti) { };
+
+	G4double Next(G4double dt, G4double err) const {
+		G4double Dt = dt;
+		if ( err != err ) Dt = tup;
+		else if ( err > target ) Dt *= 0.9;
+		else if ( err < target ) Dt *= 1.1;
+		if ( Dt < tlow ) Dt = tlow;
+		if ( Dt > tup ) Dt = tup;
+		return Dt;
+	};
+
+	G4double target;
+	G4double tlow;
+	G4double tup;
+	G4double dtIni;
+};
+
+template <AllPixCarrierType carrier, class FieldModel, class MobilityModel, bool withBField>
+class AllPixDriftEngine {
+
+public:
+
+	AllPixDriftEngine(const FieldModel & field, const MobilityModel & mobility,
+			const G4ThreeVector & bField = G4ThreeVector(), G4double hallFactor = 1.)
+	: m_field(field), m_mobility(mobility), m_bField(bField), m_hallFactor(hallFactor) { };
+
+	// Drift velocity at p
+	G4ThreeVector Velocity(const G4ThreeVector & p) const {
+
+		const G4double q = (carrier == kAllPixElectron) ? -1. : 1.;
+
+		G4ThreeVector E = m_field(p.x(), p.y(), p.z());
+		G4double mu = m_mobility(E.mag());
+
+		if ( !withBField ) return (q * mu) * E;
+
+		G4double muH = mu * m_hallFactor;
+		G4double rnorm = 1. + muH * muH * m_bField.mag2();
+
+		return (mu / rnorm) * ( q * E + muH * E.cross(m_bField) + (q * muH * muH * E.dot(m_bField)) * m_bField );
+	};
+
+	// One RKF45 step of length dt from (x, y, z)
+	AllPixDriftStep Step(G4double x, G4double y, G4double z, G4double dt) const {
+
+		G4ThreeVector p(x, y, z);
+
+		G4ThreeVector k1 = dt * Velocity( p );
+		G4ThreeVector k2 = dt * Velocity( p + (1./4)*k1 );
+		G4ThreeVector k3 = dt * Velocity( p + (3./32)*k1 + (9./32)*k2 );
+		G4ThreeVector k4 = dt * Velocity( p + (1932./2197)*k1 - (7200./2197)*k2 + (7296./2197)*k3 );
+		G4ThreeVector k5 = dt * Velocity( p + (439./216)*k1 - 8.*k2 + (3680./513)*k3 - (845./4104)*k4 );
+		G4ThreeVector k6 = dt * Velocity( p - (8./27)*k1 + 2.*k2 - (3544./2565)*k3 + (1859./4104)*k4 - (11./40)*k5 );
+
+		G4ThreeVector d = (16./135)*k1 + (6656./12825)*k3 + (28561./56430)*k4 - (9./50)*k5 + (2./55)*k6;
+		G4ThreeVector e = (1./360)*k1 - (128./4275)*k3 - (2197./75240)*k4 + (1./50)*k5 + (2./55)*k6;
+
+		AllPixDriftStep step;
+		step.dx = d.x();
+		step.dy = d.y();
+		step.dz = d.z();
+		step.err = e.mag();
+
+		return step;
+	};
+
+	const FieldModel & GetField() const { return m_field; };
+
+private:
+
+	FieldModel m_field;
+	MobilityModel m_mobility;
+	G4ThreeVector m_bField;
+	G4double m_hallFactor;
+
+};
+
+/**
+ *  Full drift from (x, y, z) while zmin < z < zmax, for the 1D field
+ *  (AllPixLinearField1D).  Where the field is zero, beyond the depleted
+ *  depth, the carrier is taken to zmax.  Returns the end point and the
+ *  drift time.
+ */
+template <class Engine>
+AllPixDriftResult AllPixDriftThroughSensor(const Engine & engine, const AllPixDriftStepControl & control,
+		G4double x, G4double y, G4double z, G4double zmin, G4double zmax) {
+
+	AllPixDriftResult r;
+	r.x = x;
+	r.y = y;
+	r.z = z;
+	r.t = 0.;
+
+	G4double dt = control.dtIni;
+	AllPixDriftStep step;
+	while ( r.z > zmin && r.z < zmax ) {
+		r.t += dt;
+		step = engine.Step(r.x, r.y, r.z, dt);
+		r.x += step.dx;
+		r.y += step.dy;
+		r.z += step.dz;
+		if ( engine.GetField().Ez(r.z) == 0 ) r.z = zmax;
+		dt = control.Next(dt, step.err);
+	}
+
+	return r;
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef AllPixDriftTable_h
+#define AllPixDriftTable_h 1
+
+#include "globals.hh"
+
+#include "AllPixDriftEngine.hh"
+
+#include <vector>
+#include <cmath>
+
+using namespace std;
+
+/**
+ *  Drift response of a sensor with a 1D field (Efield1D), tabulated
+ *  in the starting depth.  With a field depending on z only the drift
+ *  time, the lateral displacement and the end depth don't depend on
+ *  the starting x, y, so one full integration per node replaces one
+ *  per hit.  Lookup interpolates linearly between nodes.
+ *
+ *  The field stops at the depleted depth and the response jumps there,
+ *  so the table can be split at that depth (zSplit in Init): two
+ *  uniform segments sharing the nodes in proportion to their length,
+ *  each one with its own node at zSplit (the one of the upper segment
+ *  just above it), and no interpolation across.
+ *
+ *  The digitizer fills it (Init, then Set for every node with the
+ *  result of its own full integration starting at (0, 0, GetZ(i))).
+ *  Validate compares it to the full integration at the bin centers,
+ *  see tools/allpix-drift-table-check.cc.  /allpix/det/setDriftTable
+ *  false falls back to the full integration per hit.
+ */
+class AllPixDriftTable {
+
+public:
+
+	AllPixDriftTable() : m_zmin(0.), m_zmax(0.), m_zSplit(0.), m_dz1(0.), m_dz2(0.), m_n1(0),
+		m_maxDt(0.), m_maxDtZ(0.), m_maxDxy(0.) { };
+	~AllPixDriftTable() { };
+
+	// nNodes over [zmin, zmax], one more if split at zmin < zSplit < zmax
+	void Init(G4double zmin, G4double zmax, G4int nNodes, G4double zSplit = 0.) {
+		m_zmin = zmin;
+		m_zmax = zmax;
+		if ( zSplit > zmin && zSplit < zmax && nNodes > 2 ) {
+			G4int n = nNodes - 1;
+			G4int n1 = (G4int)std::floor( n * (zSplit - zmin) / (zmax - zmin) + 0.5 );
+			if ( n1 < 1 ) n1 = 1;
+			if ( n1 > n - 1 ) n1 = n - 1;
+			m_zSplit = zSplit;
+			m_dz1 = (zSplit - zmin) / n1;
+			m_dz2 = (zmax - zSplit) / (n - n1);
+			m_n1 = n1 + 1;
+			nNodes++;
+		} else {
+			m_zSplit = zmax;
+			m_dz1 = (zmax - zmin) / (nNodes - 1);
+			m_dz2 = m_dz1;
+			m_n1 = nNodes;
+		}
+		m_nodes.assign( nNodes, AllPixDriftResult() );
+		m_maxDt = m_maxDtZ = m_maxDxy = 0.;
+	};
+
+	G4int GetNNodes() const { return (G4int)m_nodes.size(); };
+	G4bool IsSplit() const { return m_n1 < GetNNodes(); };
+	G4double GetSplitZ() const { return m_zSplit; };
+
+	G4double GetZ(G4int i) const {
+		if ( i < m_n1 ) return m_zmin + i * m_dz1;
+		if ( i == m_n1 ) return std::nextafter( m_zSplit, m_zmax );
+		return m_zSplit + (i - m_n1) * m_dz2;
+	};
+
+	// Bins between consecutive nodes, none across the split
+	G4int GetNBins() const { return IsSplit() ? GetNNodes() - 2 : GetNNodes() - 1; };
+	G4double GetBinCenter(G4int i) const {
+		if ( i < m_n1 - 1 ) return m_zmin + (i + 0.5) * m_dz1;
+		return m_zSplit + (i - m_n1 + 1.5) * m_dz2;
+	};
+
+	// Full drift from (0, 0, GetZ(i))
+	void Set(G4int i, const AllPixDriftResult & r) { m_nodes[i] = r; };
+
+	bool IsBuilt() const { return !m_nodes.empty(); };
+	bool IsInRange(G4double z) const { return IsBuilt() && z >= m_zmin && z <= m_zmax; };
+
+	AllPixDriftResult Lookup(G4double x, G4double y, G4double z) const {
+
+		// segment of z, first node and number of nodes
+		G4int i0 = 0, n = m_n1;
+		G4double g = (z - m_zmin) / m_dz1;
+		if ( z > m_zSplit ) {
+			i0 = m_n1;
+			n = GetNNodes() - m_n1;
+			g = (z - m_zSplit) / m_dz2;
+		}
+
+		G4int i = (G4int)g;
+		if ( i > n - 2 ) i = n - 2;
+		if ( i < 0 ) i = 0;
+		G4double f = g - i;
+
+		const AllPixDriftResult & a = m_nodes[i0 + i];
+		const AllPixDriftResult & b = m_nodes[i0 + i + 1];
+
+		AllPixDriftResult r;
+		r.x = x + a.x + (b.x - a.x) * f;
+		r.y = y + a.y + (b.y - a.y) * f;
+		r.z = a.z + (b.z - a.z) * f;
+		r.t = a.t + (b.t - a.t) * f;
+
+		return r;
+	};
+
+	// Lookup at the bin centers against the full integration from (0, 0, GetBinCenter(i)).
+	// Call with i = 0 .. GetNBins()-1, then read the max deviations.
+	void Validate(G4int i, const AllPixDriftResult & full) {
+		G4double z = GetBinCenter(i);
+		AllPixDriftResult r = Lookup(0., 0., z);
+		G4double dt = std::fabs(r.t - full.t);
+		G4double dxy = std::sqrt( (r.x - full.x)*(r.x - full.x) + (r.y - full.y)*(r.y - full.y) );
+		if ( i == 0 || dt > m_maxDt ) { m_maxDt = dt; m_maxDtZ = z; }
+		if ( i == 0 || dxy > m_maxDxy ) { m_maxDxy = dxy; }
+	};
+
+	G4double GetMaxDtValidation() const { return m_maxDt; };
+	G4double GetMaxDtValidationZ() const { return m_maxDtZ; };
+	G4double GetMaxDxyValidation() const { return m_maxDxy; };
+
+private:
+
+	G4double m_zmin;
+	G4double m_zmax;
+	G4double m_zSplit;
+	G4double m_dz1;
+	G4double m_dz2;
+	G4int m_n1; // nodes of the lower segment
+	vector<AllPixDriftResult> m_nodes;
+
+	G4double m_maxDt;
+	G4double m_maxDtZ;
+	G4double m_maxDxy;
+
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef AllPixEFieldMap_h
+#define AllPixEFieldMap_h 1
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ *  Binary map file, written by allpix-efield-convert (tools/).
+ *  64 bytes of header followed by 3*nx*ny*nz floats, (ex, ey, ez) per
+ *  node, node index (k*ny + j)*nx + i.  Little endian, as written by the
+ *  machine doing the conversion.
+ */
+#define ALLPIX_EFIELDMAP_MAGIC "APXEFLD"
+#define ALLPIX_EFIELDMAP_VERSION 1
+
+struct AllPixEFieldMapHeader {
+	char magic[8];        // ALLPIX_EFIELDMAP_MAGIC
+	int32_t version;      // ALLPIX_EFIELDMAP_VERSION
+	int32_t nx;
+	int32_t ny;
+	int32_t nz;
+	double pitch[3];      // size of the cell covered by the map, mm.  0 = not given.
+	char fieldUnit[16];   // unit of the payload, i.e. "V/cm" for the TCAD exports
+};
+
+/**
+ *  Electric field map of one pixel cell on a regular nx * ny * nz grid.
+ *  The field is one contiguous float array, AoS packed (ex, ey, ez) per
+ *  node, node index (k*ny + j)*nx + i, which is the order of the text
+ *  map file.  The lookup is a trilinear interpolation on the eight
+ *  neighbouring nodes, no allocation and no bounds check beyond clamping
+ *  to the grid.
+ *
+ *  Coordinates are normalized to the cell: u = 0 is the first node,
+ *  u = 1 the last one (along each axis).
+ *
+ *  The field array is either owned (text map, filled with Set) or the
+ *  read-only mmap of a binary map file.  GetShared() loads a file once,
+ *  detectors naming the same file get the same map. */
+class AllPixEFieldMap {
+
+public:
+
+	AllPixEFieldMap();
+	~AllPixEFieldMap();
+
+	// Map for this file, loaded (text or binary) the first time it's asked for.
+	// 0x0 if the file can't be read.  The maps live until the end of the job.
+	static AllPixEFieldMap * GetShared(const G4String & file);
+
+	void Init(G4int nx, G4int ny, G4int nz);
+
+	void Set(G4int i, G4int j, G4int k, G4double ex, G4double ey, G4double ez) {
+		float * f = &m_field[ 3 * Index(i, j, k) ];
+		f[0] = (float)ex;
+		f[1] = (float)ey;
+		f[2] = (float)ez;
+	};
+
+	// TCAD text export: "nx ny nz" then per node "i j k ex ey ez"
+	G4bool LoadText(const G4String & file);
+	// Binary map, mmap'ed read-only.  A field unit other than V/cm is
+	// converted into an owned copy, an unknown one refused.
+	G4bool LoadBinary(const G4String & file);
+	G4bool WriteBinary(const G4String & file, const G4double pitch[3], const G4String & fieldUnit) const;
+	static G4bool IsBinary(const G4String & file);
+	// factor to V/cm of a binary header unit, false if unknown
+	static G4bool GetUnitScale(const G4String & unit, G4double & toVPerCm);
+
+	bool IsLoaded() const { return m_data != 0x0; };
+	bool IsMapped() const { return m_mapBase != 0x0; };
+
+	G4int GetNx() const { return m_nx; };
+	G4int GetNy() const { return m_ny; };
+	G4int GetNz() const { return m_nz; };
+	// From the binary header, 0 if not known
+	G4double GetPitch(G4int axis) const { return m_pitch[axis]; };
+	// Unit of the field values in memory, "V/cm" once loaded
+	G4String GetFieldUnit() const { return m_fieldUnit; };
+
+	// Field at the normalized position (u, v, w)
+	G4ThreeVector Interpolate(G4double u, G4double v, G4double w) const {
+		float out[3];
+		Trilinear(m_data, 3, u, v, w, out);
+		return G4ThreeVector(out[0], out[1], out[2]);
+	};
+
+private:
+
+	void Unmap();
+
+	size_t Index(G4int i, G4int j, G4int k) const {
+		return ( (size_t)k * m_ny + j ) * m_nx + i;
+	};
+
+	// Cell index and fraction along one axis, clamped to the grid
+	static void Locate(G4double u, G4int n, G4int & i0, float & f) {
+		if ( n < 2 ) { i0 = 0; f = 0.f; return; }
+		G4double g = u * (n - 1);
+		if ( g <= 0. ) { i0 = 0; f = 0.f; return; }
+		if ( g >= n - 1 ) { i0 = n - 2; f = 1.f; return; }
+		i0 = (G4int)g;
+		if ( i0 > n - 2 ) i0 = n - 2;
+		f = (float)(g - i0);
+	};
+
+	// Trilinear interpolation of nc floats per node
+	void Trilinear(const float * data, G4int nc, G4double u, G4double v, G4double w, float * out) const {
+
+		G4int i0, j0, k0;
+		float fx, fy, fz;
+		Locate(u, m_nx, i0, fx);
+		Locate(v, m_ny, j0, fy);
+		Locate(w, m_nz, k0, fz);
+
+		const size_t di = (m_nx > 1) ? nc : 0;
+		const size_t dj = (m_ny > 1) ? (size_t)nc * m_nx : 0;
+		const size_t dk = (m_nz > 1) ? (size_t)nc * m_nx * m_ny : 0;
+
+		const float * c000 = data + nc * Index(i0, j0, k0);
+		const float * c010 = c000 + dj;
+		const float * c001 = c000 + dk;
+		const float * c011 = c001 + dj;
+
+		for ( G4int c = 0 ; c < nc ; c++ ) {
+			float e00 = c000[c] + (c000[c + di] - c000[c]) * fx;
+			float e10 = c010[c] + (c010[c + di] - c010[c]) * fx;
+			float e01 = c001[c] + (c001[c + di] - c001[c]) * fx;
+			float e11 = c011[c] + (c011[c + di] - c011[c]) * fx;
+			float e0 = e00 + (e10 - e00) * fy;
+			float e1 = e01 + (e11 - e01) * fy;
+			out[c] = e0 + (e1 - e0) * fz;
+		}
+
+	};
+
+	G4int m_nx;
+	G4int m_ny;
+	G4int m_nz;
+	G4double m_pitch[3];
+	G4String m_fieldUnit;
+
+	// points to m_field or into the mapped file
+	const float * m_data;
+	vector<float> m_field;
+
+	void * m_mapBase;
+	size_t m_mapSize;
+
+};
+
+#endif
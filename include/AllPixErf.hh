@@ -0,0 +1,50 @@
+#ifndef AllPixErf_h
+#define AllPixErf_h 1
+
+#include "globals.hh"
+
+#include <cmath>
+
+/**
+ *  Error function and Gaussian box integral shared by the digitizers
+ *  doing charge sharing (Timepix, Timepix3, FEI3Standard, TMPX).
+ *
+ *  AllPixFastErf is the Abramowitz & Stegun 7.1.26 rational
+ *  approximation, |error| < 1.5e-7 over the whole real line.
+ *  No table, no branch but the sign, so the loops over
+ *  neighbour pixels can be vectorized by the compiler.
+ */
+
+inline G4double AllPixFastErf(G4double x) {
+
+	const G4double a1 =  0.254829592;
+	const G4double a2 = -0.284496736;
+	const G4double a3 =  1.421413741;
+	const G4double a4 = -1.453152027;
+	const G4double a5 =  1.061405429;
+	const G4double p  =  0.3275911;
+
+	G4double ax = std::fabs(x);
+	G4double t = 1.0 / (1.0 + p * ax);
+	G4double y = 1.0 - (((((a5 * t + a4) * t) + a3) * t + a2) * t + a1) * t * std::exp(-ax * ax);
+
+	return std::copysign(y, x);
+}
+
+/**
+ *  Fraction of a 2D Gaussian (center xhit,yhit, width Sigma) falling in
+ *  the box [x1,x2]x[y1,y2], times Energy.  Same result as the
+ *  IntegrateGaussian members of the digitizers, with a single division.
+ */
+inline G4double AllPixGaussianBoxIntegral(G4double xhit, G4double yhit, G4double Sigma,
+		G4double x1, G4double x2, G4double y1, G4double y2, G4double Energy) {
+
+	const G4double invS = 1.0 / (std::sqrt(2.0) * Sigma);
+
+	G4double fx = AllPixFastErf((x2 - xhit) * invS) - AllPixFastErf((x1 - xhit) * invS);
+	G4double fy = AllPixFastErf((y2 - yhit) * invS) - AllPixFastErf((y1 - yhit) * invS);
+
+	return Energy * fx * fy / 4.;
+}
+
+#endif
@@ -12,6 +12,8 @@
 #include "AllPixTrackerHit.hh"
 #include "G4PrimaryVertex.hh"
 #include "AllPixGeoDsc.hh"
+#include "AllPixDriftEngine.hh"
+#include "AllPixDriftTable.hh"
 #include "TString.h"
 #include "TH2D.h"
 #include <map>
@@ -56,16 +58,23 @@ private:
   G4double MobilityHole(G4double x, G4double y=0, G4double z=0);
 
   void ComputeElectricField(G4double x, G4double y=0, G4double z=0);
-  vector<G4double> ComputeDriftTimeFullField(G4double x, G4double y, G4double z);
-  vector<G4double> RKF5Integration(G4double x, G4double y, G4double z,G4double dt);
+  AllPixDriftResult ComputeDriftTimeFullField(G4double x, G4double y, G4double z);
   G4double ComputeSubHitContribution(G4double x, G4double y, G4double z,G4double Energy);
-  G4double SetDt(G4double Dt,G4double ErreurMoy);
   G4int EnergyToTOT(G4double Energy, G4double threshold);
   G4double SlimEdgeEffect(G4int nX,G4double xpos,G4double eHit);
   G4bool isSlimEdge(G4int nX, G4int nY);
   void Efield1D(G4double z);
   void Efield2D(G4double x,G4double y,G4double z);
 
+  // drift models, see AllPixDriftEngine.hh
+  AllPixLinearField1D m_driftField;
+  AllPixCaugheyThomasMobility m_electronMobility;
+
+  // tabulated drift response (1D field), /allpix/det/setDriftTable
+  G4bool doDriftTable;
+  AllPixDriftTable m_driftTable;
+  void BuildDriftTable();
+
   G4double elec;
 
   ///////////////////////////////////////////////////////
@@ -91,10 +100,7 @@ private:
   ///////////////////////////////////////////////////////
 
   //Numerical accuracy of RKF5
-  G4double tlow;
-  G4double tup;
-  G4double dtIni;
-  G4double Target;
+  AllPixDriftStepControl m_driftStepControl;
 
   G4double Temperature;
 
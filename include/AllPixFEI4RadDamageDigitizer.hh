@@ -22,6 +22,7 @@
 // added for radiation damage
 #include "AllPixTrackerHit.hh"
 #include "AllPixGeoDsc.hh"
+#include "AllPixCarrierBatch.hh"
 #include "TString.h"
 #include "TH2D.h"
 #include "TH3F.h"
@@ -91,6 +92,9 @@ private:
   G4double echarge;
   G4int precision;
 
+  // the precision subcharges of a hit, moved together
+  AllPixCarrierBatch m_carriers;
+
   // Physics process switches
   G4bool doTrapping;
   G4bool doRamo;
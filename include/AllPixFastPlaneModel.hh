@@ -0,0 +1,52 @@
+#ifndef AllPixFastPlaneModel_h
+#define AllPixFastPlaneModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4ThreeVector.hh"
+
+class G4Region;
+class G4Material;
+class G4ParticleDefinition;
+class AllPixTrackerSD;
+class AllPixGeoDsc;
+
+/**
+ *  Parameterised plane for the telescope references.  A primary
+ *  entering the sensor (the envelope, region Sensor_<id>) crosses it in
+ *  a straight line.  The energy loss in the sensor is sampled from a
+ *  Landau (Gaussian when the layer is thick, kappa > 10), shared along
+ *  the path by pixel (and by the region max step, if any) and given to
+ *  the AllPixTrackerSD of the detector as ordinary hits.  The multiple
+ *  scattering of the whole layer (Highland) is applied to the direction
+ *  at the exit.  The track is then either killed or continues.
+ *
+ *  One per sensor and thread, built by ConstructSDandField at every
+ *  geometry update and deleted at the next one.
+ *
+ *  /allpix/det/setFastSimulation continue|kill|off
+ */
+class AllPixFastPlaneModel : public G4VFastSimulationModel
+{
+
+public:
+
+	AllPixFastPlaneModel(G4String, G4Region *, AllPixTrackerSD *, AllPixGeoDsc *, G4bool killTrack);
+	~AllPixFastPlaneModel();
+
+	G4bool IsApplicable(const G4ParticleDefinition &);
+	G4bool ModelTrigger(const G4FastTrack &);
+	void DoIt(const G4FastTrack &, G4FastStep &);
+
+private:
+
+	G4double SampleEnergyLoss(const G4ParticleDefinition *, G4double kinE, const G4Material *, G4double length);
+	G4double HighlandAngle(const G4ParticleDefinition *, G4double kinE, const G4Material *, G4double length);
+
+	AllPixTrackerSD * m_trackerSD;
+	AllPixGeoDsc * m_gD;
+	G4bool m_killTrack;
+	G4int m_processId; // in AllPixNameTable, model name
+
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef AllPixFrameFile_h
+#define AllPixFrameFile_h 1
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ *  Zero-suppressed binary frame file, written by allpix-frame-convert
+ *  (tools/) from the Pixelman text frames (256x256 matrix, XYC, XC with
+ *  their .dsc), read by FramesHandler::readOneFrame in place of them.
+ *
+ *  32 bytes of header, the .dsc text (metaBytes, padded to 4 bytes),
+ *  then nPixels uint32 pixel indices (y*width + x, ascending) and the
+ *  nPixels uint16 counts of those pixels.  Pixels with 0 counts are not
+ *  stored.  Little endian, as written by the machine doing the
+ *  conversion.
+ */
+#define ALLPIX_FRAMEFILE_MAGIC "APXFRAM"
+#define ALLPIX_FRAMEFILE_VERSION 1
+
+struct AllPixFrameFileHeader {
+	char magic[8];        // ALLPIX_FRAMEFILE_MAGIC
+	int32_t version;      // ALLPIX_FRAMEFILE_VERSION
+	int32_t width;
+	int32_t height;
+	int32_t nPixels;
+	int32_t metaBytes;    // length of the .dsc text
+	int32_t reserved;
+};
+
+/**
+ *  Read-only mmap of a frame file.  The index and counts arrays point
+ *  into the mapping, valid until Close().
+ */
+class AllPixFrameFile {
+
+public:
+
+	AllPixFrameFile();
+	~AllPixFrameFile();
+
+	static bool IsFrameFile(const string & file);
+
+	bool Open(const string & file);
+	void Close();
+
+	int32_t GetWidth() const { return m_header->width; };
+	int32_t GetHeight() const { return m_header->height; };
+	int32_t GetNPixels() const { return m_header->nPixels; };
+	const uint32_t * GetIndex() const { return m_index; };
+	const uint16_t * GetCounts() const { return m_counts; };
+	string GetMetaData() const { return string(m_meta, m_header->metaBytes); };
+
+	// index and counts in the same order, sorted here if they aren't
+	static bool Write(const string & file, int32_t width, int32_t height,
+			const vector<uint32_t> & index, const vector<uint16_t> & counts, const string & meta);
+
+private:
+
+	void * m_base;
+	size_t m_size;
+	const AllPixFrameFileHeader * m_header;
+	const char * m_meta;
+	const uint32_t * m_index;
+	const uint16_t * m_counts;
+
+};
+
+#endif
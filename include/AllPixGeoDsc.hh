@@ -16,14 +16,47 @@
 #include <unistd.h>
 #include <map>
 #include <math.h>
+#include <stdint.h>
 #include "G4ThreeVector.hh"
 
+#include "AllPixEFieldMap.hh"
+
 #include "CLHEP/Units/SystemOfUnits.h"
 using namespace CLHEP;
 
 
 using namespace std;
 
+/**
+ *  What ReadGeoDescription reads from the xml database for one
+ *  detector, as stored in its binary cache.  Lengths in Geant4 units.
+ */
+#define ALLPIX_GEODSC_DIGITIZER_SIZE 128
+
+struct AllPixGeoDscRecord {
+	int32_t id;
+	int32_t npix[3];
+	int32_t mipTot;
+	int32_t counterDepth;
+	double pixsize[3];
+	double chip_h[3];
+	double chip_pos[3];
+	double chip_offset[3];
+	double sensor_h[3];
+	double sensor_pos[3];
+	double sensor_gr_excess[4]; // top, bottom, right, left
+	double pcb_h[3];
+	double bump[5];             // radius, height, offset x, offset y, dr
+	double resistivity;
+	double mipCharge;
+	double clockUnit;
+	double chipNoise;
+	double chipThreshold;
+	double crossTalk;
+	double saturationEnergy;
+	char digitizer[ALLPIX_GEODSC_DIGITIZER_SIZE];
+};
+
 class AllPixGeoDsc {
 
 public:
@@ -121,8 +154,10 @@ public:
 	G4double GetTemperature(){return m_Temperature;};
 	G4double GetFlux(){return m_Flux;};
 	G4ThreeVector GetMagField(){return m_MagField;};
+	G4bool GetDriftTable(){return m_driftTable;};
 
-	G4ThreeVector GetEFieldFromMap(G4ThreeVector);
+	// Trilinear interpolation in the field map (AllPixEFieldMap), position in mm
+	G4ThreeVector GetEFieldFromMap(const G4ThreeVector &);
 
 	G4bool GetEFieldBoolean(){return m_efieldfromfile;};
 
@@ -305,6 +340,10 @@ public:
 		m_MagField = vals;
 	}
 
+	void SetDriftTable(G4bool val){
+		m_driftTable = val;
+	}
+
 	void SetEFieldMap(G4String valS);
 
 	///////////////////////////////////////////////////
@@ -324,6 +363,9 @@ public:
 	///////////////////////////////////////////////////
 	// extras
 	void Dump();
+	// false if the digitizer name doesn't fit in the record
+	G4bool GetRecord(AllPixGeoDscRecord &);
+	void SetRecord(const AllPixGeoDscRecord &);
 
 
 private:
@@ -395,11 +437,12 @@ private:
 	G4double m_Temperature;
 	G4double m_Flux;
 	G4ThreeVector m_MagField;
+	G4bool m_driftTable; // digitizers tabulate the 1D field drift
 
 	G4String m_EFieldFile;
 
-	vector<vector<vector<G4ThreeVector>>> m_efieldmap;
-	G4int m_efieldmap_nx, m_efieldmap_ny, m_efieldmap_nz;
+	// shared between the detectors using the same file, see AllPixEFieldMap::GetShared
+	AllPixEFieldMap * m_efieldmap;
 
 	G4bool m_efieldfromfile;
 
@@ -0,0 +1,135 @@
+#ifndef AllPixLCIOBridge_h
+#define AllPixLCIOBridge_h 1
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ *  LCIO bridge files (lciobridge_allpix, lciobridge_allpix_dut), input
+ *  of the LCIO conversion.  Per event: the frame Id, then per detector
+ *  its Id and the (x, y, counts) of its pixels.
+ *
+ *  Text (<name>.txt), as always:
+ *    R <frameId>
+ *    <detId> <x> <y> <counts> <x> <y> <counts> ... (one line per detector)
+ *
+ *  Binary (<name>.bin): a 16 bytes header then length-prefixed records,
+ *    int32 length (bytes after this field), int32 type, payload
+ *  with, all int32,
+ *    ALLPIX_LCIOBRIDGE_RUN    : frameId
+ *    ALLPIX_LCIOBRIDGE_PLANE  : detId, nPixels, nPixels * (x, y, counts)
+ *  A reader skips the record types it doesn't know.  Native endianness.
+ *
+ *  This file and AllPixLCIOBridge.cc only depend on the standard
+ *  library, they make the allpix-lciobridge library for the converters.
+ */
+#define ALLPIX_LCIOBRIDGE_MAGIC "APXLCIO"
+#define ALLPIX_LCIOBRIDGE_VERSION 1
+
+#define ALLPIX_LCIOBRIDGE_RUN   1
+#define ALLPIX_LCIOBRIDGE_PLANE 2
+
+struct AllPixLCIOBridgeHeader {
+	char magic[8];        // ALLPIX_LCIOBRIDGE_MAGIC
+	int32_t version;      // ALLPIX_LCIOBRIDGE_VERSION
+	int32_t reserved;
+};
+
+struct AllPixLCIOBridgePlane {
+	int32_t detId;
+	vector<int32_t> pixels; // x, y, counts
+};
+
+struct AllPixLCIOBridgeEvent {
+
+	void Clear(int32_t frame) { frameId = frame; planes.clear(); };
+	void AddPlane(int32_t detId) {
+		planes.push_back(AllPixLCIOBridgePlane());
+		planes.back().detId = detId;
+	};
+	// to the last plane added
+	void AddPixel(int32_t x, int32_t y, int32_t counts) {
+		vector<int32_t> & p = planes.back().pixels;
+		p.push_back(x);
+		p.push_back(y);
+		p.push_back(counts);
+	};
+
+	int32_t frameId;
+	vector<AllPixLCIOBridgePlane> planes;
+};
+
+/**
+ *  Writes <name>.txt and/or <name>.bin (SetFormat, before the first
+ *  event, the files are opened by the first Write) through a large
+ *  buffer.  Not thread safe, the caller serializes Write().
+ */
+class AllPixLCIOBridgeWriter {
+
+public:
+
+	enum {
+		kNone = 0,
+		kText = 1,
+		kBinary = 2
+	};
+
+	AllPixLCIOBridgeWriter(const string & name);
+	~AllPixLCIOBridgeWriter();
+
+	// "text" (default), "binary", "both" or "none"
+	static bool SetFormat(const string & format);
+	static int GetFormat();
+
+	void Write(const AllPixLCIOBridgeEvent &);
+	void Close();
+
+private:
+
+	void Open();
+	void Put(FILE *, vector<char> & buf, size_t & used, const char *, size_t);
+
+	string m_name;
+	bool m_opened;
+	FILE * m_text;
+	FILE * m_binary;
+	vector<char> m_textBuf;
+	vector<char> m_binaryBuf;
+	size_t m_textUsed;
+	size_t m_binaryUsed;
+
+};
+
+/**
+ *  Reads a binary bridge file event by event.
+ */
+class AllPixLCIOBridgeReader {
+
+public:
+
+	AllPixLCIOBridgeReader();
+	~AllPixLCIOBridgeReader();
+
+	bool Open(const string & file);
+	// false at the end of the file (or on a truncated record)
+	bool Next(AllPixLCIOBridgeEvent &);
+	void Close();
+
+private:
+
+	bool ReadRecord();
+
+	FILE * m_file;
+	vector<char> m_fileBuf;
+	// record read ahead, type and payload
+	int32_t m_type;
+	vector<int32_t> m_payload;
+	bool m_pending;
+
+};
+
+#endif
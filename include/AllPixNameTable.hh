@@ -0,0 +1,43 @@
+#ifndef AllPixNameTable_h
+#define AllPixNameTable_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+
+using namespace std;
+
+/**
+ *  Interned names (processes, volumes) for the hits.  An AllPixTrackerHit
+ *  stores the integer id given here instead of copies of the strings;
+ *  the name is looked up again when the hit is recorded (object format)
+ *  or the id mapped to a code of the hits file (columns format, see
+ *  AllPixRun::RecordHits).
+ *
+ *  One table per thread: the hits are created and recorded on the same
+ *  worker thread, so no locking.  Ids are stable for the life of the
+ *  thread, the table only grows (a few tens of names per job).
+ */
+class AllPixNameTable {
+
+public:
+
+	static AllPixNameTable * GetInstance();
+
+	// Id of this name, added to the table the first time it's seen
+	G4int GetId(const G4String & name);
+
+	const G4String & GetName(G4int id) const { return m_names[id]; };
+	G4int GetNNames() const { return (G4int)m_names.size(); };
+
+private:
+
+	AllPixNameTable() { };
+
+	map<G4String, G4int> m_ids;
+	vector<G4String> m_names;
+
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef AllPixOutputQueue_h
+#define AllPixOutputQueue_h 1
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <ostream>
+
+/**
+ *  Output stage.  The writers (hits, frames, RD53 ROOT files) hand a
+ *  completed record to Push() as a job and go on with the simulation;
+ *  a single writer thread runs the jobs (TTree::Fill, i.e. streaming
+ *  and compression) in order.  The queue is bounded: when it is full
+ *  Push() waits for the writer (back-pressure) and the wait is counted.
+ *
+ *  Every ROOT call on the output files, from the writer thread or not
+ *  (opening, closing), is done holding GetIOMutex().
+ *
+ *  Not started (/allpix/config/setAsyncOutput 0, the default) Push()
+ *  runs the job right away on the calling thread, as before.
+ */
+class AllPixOutputQueue {
+
+public:
+
+	typedef std::function<void()> Job;
+
+	static AllPixOutputQueue * GetInstance();
+
+	// start the writer thread with a queue of depth jobs, 0 = synchronous
+	void Start(int depth);
+	// write everything queued and join the writer thread
+	void Stop();
+	bool IsRunning() { return m_running; };
+
+	void Push(const Job &);
+	// wait until everything queued is written
+	void Drain();
+
+	std::mutex & GetIOMutex() { return m_ioMutex; };
+
+	// queue depth, back-pressure and writer load since the last reset
+	void PrintStats(std::ostream &);
+	void ResetStats();
+
+private:
+
+	AllPixOutputQueue();
+	~AllPixOutputQueue();
+	void Loop();
+
+	std::deque<Job> m_jobs;
+	size_t m_depth;
+	bool m_running;
+	bool m_stop;
+	bool m_busy;
+
+	std::thread m_writer;
+	std::mutex m_mutex;
+	std::mutex m_ioMutex;
+	std::condition_variable m_notEmpty;
+	std::condition_variable m_notFull;
+	std::condition_variable m_idle;
+
+	// stats
+	long m_pushed;
+	long m_written;
+	long m_stalls;
+	double m_depthSum;
+	size_t m_maxDepth;
+	double m_stallTime;
+	double m_writeTime;
+
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef AllPixOutputSettings_h
+#define AllPixOutputSettings_h 1
+
+#include <TString.h>
+
+#include <ostream>
+
+class TFile;
+class TTree;
+
+/**
+ *  Compression, basket size and AutoFlush of the output trees (frames,
+ *  hits, RD53), set with the /allpix/config/ commands before the files
+ *  are opened.  Every writer calls ApplyTo on its file right after
+ *  opening it (before the tree is created, the branches take the
+ *  compression of the file) and on its tree once the branches exist.
+ *
+ *  Unset values leave the ROOT/writer defaults untouched.
+ */
+class AllPixOutputSettings {
+
+public:
+
+	static AllPixOutputSettings * GetInstance();
+
+	// default, zlib, lzma, lz4 or zstd.  level < 0: the algorithm's default
+	bool SetCompression(TString algorithm, int level);
+	// bytes per branch buffer, 0 = writer default
+	void SetBasketSize(int basketSize) { m_basketSize = basketSize; };
+	// TTree::SetAutoFlush: > 0 entries, < 0 bytes, 0 = ROOT default
+	void SetAutoFlush(Long64_t autoFlush) { m_autoFlush = autoFlush; };
+
+	// basket size to use for a branch the writer would create with def
+	int GetBasketSize(int def) { return m_basketSize > 0 ? m_basketSize : def; };
+
+	void ApplyTo(TFile *);
+	void ApplyTo(TTree *);
+
+	// entries, uncompressed/compressed bytes and ratio of a tree
+	void PrintSummary(TTree *, TString fileName, std::ostream &);
+
+private:
+
+	AllPixOutputSettings();
+
+	int m_compression; // ROOT compression settings, 100*algorithm + level, -1 = default
+	int m_basketSize;
+	Long64_t m_autoFlush;
+
+};
+
+#endif
@@ -47,6 +47,7 @@
 
 class G4VPhysicsConstructor;
 class AllPixPhysicsListMessenger;
+class AllPixPhysicsTables;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -68,7 +69,12 @@ public:
   void AddAllPixPhysicsList(const G4String& name);
   void ConstructProcess();
   void AddStepMax();
+  void AddFastSimulation();
   void List();
+
+  // tables kept between jobs, see AllPixPhysicsTables
+  void SetPhysicsTableDir(const G4String& dir);
+  G4String GetPhysicsNames() const;
   
 private:
 
@@ -88,6 +94,7 @@ private:
   std::vector<G4VPhysicsConstructor*>  hadronPhys;
     
   AllPixPhysicsListMessenger* pMessenger;
+  AllPixPhysicsTables* physicsTables;
   G4bool dump;
 };
 
@@ -75,6 +75,7 @@ private:
   G4UIcmdWithADoubleAndUnit* allCutCmd;
   G4UIcmdWithAString*        pListCmd;
   G4UIcmdWithoutParameter*   listCmd;  
+  G4UIcmdWithAString*        tableDirCmd;
   G4UIcmdWithAnInteger* verboseCmd;
 };
 
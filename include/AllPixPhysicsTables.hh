@@ -0,0 +1,54 @@
+#ifndef AllPixPhysicsTables_h
+#define AllPixPhysicsTables_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <stdint.h>
+
+class AllPixPhysicsList;
+
+/**
+ *  Physics tables kept in a directory between jobs
+ *  (/allpix/phys/setPhysicsTableDir).  The tables of a configuration go
+ *  in <dir>/<hash>, hash of the Geant4 version, the physics constructors,
+ *  the EM options (G4EmParameters), the production cuts of every region
+ *  and the materials.  The first run of a configuration builds and
+ *  stores them, the following ones retrieve them
+ *  (G4VUserPhysicsList::SetPhysicsTableRetrieved).  Stored tables are
+ *  never removed, other jobs may be reading them.
+ *
+ *  Follows the states of the run manager: the decision is taken when a
+ *  run initialization starts (Idle --> Init), the tables are stored or
+ *  the time saved reported when it's done (Idle --> GeomClosed).
+ */
+class AllPixPhysicsTables : public G4VStateDependent {
+
+public:
+
+	AllPixPhysicsTables(AllPixPhysicsList *, G4String dir);
+	~AllPixPhysicsTables();
+
+	G4bool Notify(G4ApplicationState);
+
+private:
+
+	uint64_t HashInputs();
+	void Prepare();
+	void Finish();
+
+	AllPixPhysicsList * m_physicsList;
+	G4String m_dir;
+	G4String m_tablesDir;  // <dir>/<hash>
+	uint64_t m_hash;
+	G4bool m_retrieving;
+	G4double m_storedBuildTime; // [s], from the info file
+	G4bool m_done;         // tables built once, nothing more to do
+
+	std::chrono::steady_clock::time_point m_initStart;
+	G4double m_initTime;   // [s] last Init state
+
+};
+
+#endif
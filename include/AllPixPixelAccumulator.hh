@@ -0,0 +1,125 @@
+#ifndef AllPixPixelAccumulator_h
+#define AllPixPixelAccumulator_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ *  Per-event charge (or energy) accumulator for one pixel detector.
+ *  Replaces the map<pair<G4int, G4int>, G4double> the digitizers used
+ *  to fill per hit.  The storage is a dense nPixX*nPixY buffer,
+ *  allocated once, plus the list of touched pixels so that Clear()
+ *  only resets what was used in the event.
+ *
+ *  It behaves like the map it replaces:
+ *   - operator[] creates the entry (value 0) if it wasn't there,
+ *   - iteration goes over the touched pixels sorted by (x, y),
+ *   - (*itr).first is the pixel pair<G4int, G4int>, (*itr).second the value.
+ *  Pixels outside the matrix (neighbours of edge pixels in the charge
+ *  sharing loops) are kept in a small map so nothing changes for the
+ *  digitizers which check the range themselves.
+ */
+class AllPixPixelAccumulator {
+
+public:
+
+	typedef pair<G4int, G4int> pixel;
+
+	class iterator {
+	public:
+		iterator(AllPixPixelAccumulator * acc, size_t pos) : m_acc(acc), m_pos(pos) { };
+		pair<pixel, G4double &> operator*() const {
+			const pixel & p = m_acc->m_sortedKeys[m_pos];
+			return pair<pixel, G4double &>( p, (*m_acc)[p] );
+		};
+		iterator & operator++() { m_pos++; return *this; };
+		iterator operator++(int) { iterator tmp = *this; m_pos++; return tmp; };
+		bool operator==(const iterator & o) const { return m_pos == o.m_pos; };
+		bool operator!=(const iterator & o) const { return m_pos != o.m_pos; };
+	private:
+		AllPixPixelAccumulator * m_acc;
+		size_t m_pos;
+	};
+
+	AllPixPixelAccumulator() : m_nX(0), m_nY(0) { };
+	~AllPixPixelAccumulator() { };
+
+	// Allocate for a nX x nY matrix.  Nothing happens if the size doesn't change.
+	void Init(G4int nX, G4int nY) {
+		if ( nX == m_nX && nY == m_nY ) return;
+		m_nX = nX;
+		m_nY = nY;
+		m_content.assign( (size_t)m_nX * m_nY, 0. );
+		m_touched.assign( (size_t)m_nX * m_nY, false );
+		m_touchedList.clear();
+		m_outside.clear();
+		m_sortedKeys.clear();
+	};
+
+	bool IsInitialized() { return !m_content.empty(); };
+
+	// Sparse reset, only the pixels used since the last Clear
+	void Clear() {
+		vector<G4int>::iterator itr = m_touchedList.begin();
+		for ( ; itr != m_touchedList.end() ; itr++ ) {
+			m_content[*itr] = 0.;
+			m_touched[*itr] = false;
+		}
+		m_touchedList.clear();
+		m_outside.clear();
+		m_sortedKeys.clear();
+	};
+
+	G4double & operator[](const pixel & p) {
+		if ( p.first < 0 || p.first >= m_nX || p.second < 0 || p.second >= m_nY ) {
+			return m_outside[p];
+		}
+		G4int idx = p.first * m_nY + p.second;
+		if ( !m_touched[idx] ) {
+			m_touched[idx] = true;
+			m_touchedList.push_back( idx );
+		}
+		return m_content[idx];
+	};
+
+	size_t size() { return m_touchedList.size() + m_outside.size(); };
+	bool empty() { return size() == 0; };
+
+	// Sorts the touched pixels.  Don't add pixels while iterating.
+	iterator begin() {
+		m_sortedKeys.clear();
+		m_sortedKeys.reserve( size() );
+		// idx = x*nY + y, sorting the index sorts in (x, y)
+		sort( m_touchedList.begin(), m_touchedList.end() );
+		vector<G4int>::iterator itr = m_touchedList.begin();
+		for ( ; itr != m_touchedList.end() ; itr++ ) {
+			m_sortedKeys.push_back( make_pair( (*itr) / m_nY, (*itr) % m_nY ) );
+		}
+		if ( !m_outside.empty() ) {
+			map<pixel, G4double>::iterator oItr = m_outside.begin();
+			for ( ; oItr != m_outside.end() ; oItr++ ) m_sortedKeys.push_back( (*oItr).first );
+			sort( m_sortedKeys.begin(), m_sortedKeys.end() );
+		}
+		return iterator(this, 0);
+	};
+	iterator end() { return iterator(this, m_sortedKeys.size()); };
+
+private:
+
+	G4int m_nX;
+	G4int m_nY;
+	vector<G4double> m_content;
+	vector<bool> m_touched;
+	vector<G4int> m_touchedList;
+	map<pixel, G4double> m_outside;
+	vector<pixel> m_sortedKeys;
+
+};
+
+#endif
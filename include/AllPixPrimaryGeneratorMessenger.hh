@@ -41,6 +41,8 @@
 #include "G4UImessenger.hh"
 #include "globals.hh"
 
+#include <vector>
+
 class AllPixPrimaryGeneratorAction;
 class G4UIdirectory;
 class G4UIcmdWithADoubleAndUnit;
@@ -62,10 +64,16 @@ public:
   G4String GetTimepixTelescopeFolderName()  {return this->m_TimepixTelescopeFolderName;}
   G4bool   GetTimepixTelescopeDoEventFlag() {return this->m_TimepixTelescopeDoEventFlag;}
   G4bool   GetTimepixTelescopeSumTOTFlag()  {return this->m_TimepixTelescopeSumTOTFlag;}
+  G4bool   GetTimepixTelescopeBinaryFlag()  {return this->m_TimepixTelescopeBinaryFlag;}
 
   //Write MC hits in ROOT files (nalipour)
   G4bool GetWrite_MC_FilesFlag() {return this->m_Write_MC_FilesFlag;} 
   G4String GetWrite_MC_FolderName()  {return this->m_Write_MC_FolderName;}
+  G4int GetWrite_MC_FillEvery() {return this->m_Write_MC_FillEvery;}
+
+  // Events per frame of the run being started by /allpix/beam/on in
+  //  frames-in-run mode, empty otherwise (one run per frame)
+  const std::vector<G4int> & GetFramesInRun() {return this->m_framesInRun;}
 
   void SetNewValue(G4UIcommand*, G4String);
 
@@ -78,27 +86,36 @@ private:
   G4UIcmdWithAnInteger         * m_userBeamNumberOfFramesCmd;
   G4UIcmdWithoutParameter      * m_userBeamOnCmd;
   G4UIcommand                  * m_userBeamTypeCmd;
+  G4UIcmdWithABool             * m_userBeamFramesInRunCmd;
   G4int m_hits;
   G4int m_frames;
   G4String m_beamTypeHitFunc;
   G4double m_beamTypePar1;
   G4double m_beamTypePar2;
+  G4bool m_framesInRunFlag;
+  std::vector<G4int> m_framesInRun;
+
+  G4int SampleFrameMultiplicity();
 
   G4UIcmdWithABool   * m_TimepixTelescopeWriteCmd;
   G4UIcmdWithAString * m_TimepixTelescopeFolderNameCmd;
   G4UIcmdWithABool   * m_TimepixTelescopeDoEventCmd;
   G4UIcmdWithABool   * m_TimepixTelescopeSumTOTCmd;
+  G4UIcmdWithABool   * m_TimepixTelescopeBinaryCmd;
   G4bool   m_TimepixTelescopeWriteFlag;
   G4String m_TimepixTelescopeFolderName;
   G4bool   m_TimepixTelescopeDoEventFlag;
   G4bool   m_TimepixTelescopeSumTOTFlag;
+  G4bool   m_TimepixTelescopeBinaryFlag;
 
   
   //nalipour: MC hits
   G4UIcmdWithABool   * m_Write_MC_FilesCmd;
   G4UIcmdWithAString * m_Write_MC_FolderNameCmd;
+  G4UIcmdWithAnInteger * m_Write_MC_FillEveryCmd;
   G4bool m_Write_MC_FilesFlag;
   G4String m_Write_MC_FolderName;
+  G4int m_Write_MC_FillEvery;
 
 };
 
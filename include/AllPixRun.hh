@@ -12,6 +12,7 @@
 #include "AllPixDigitInterface.hh"
 #include "AllPixWriteROOTFile.hh" //nalipour: Write MC hits in a ROOT file
 #include "ROOTDataFormat.hh" //nalipour: Write MC hits in a ROOT file
+#include "AllPixLCIOBridge.hh"
 
 #include <TROOT.h>
 #include <TFile.h>
@@ -33,6 +34,7 @@ class FramesHandler;
 class WriteToNtuple;
 class SimpleHits;
 class AllPixDetectorConstruction;
+class AllPixTelescopeWriter;
 
 #ifdef _EUTELESCOPE
 #define __magic_trigger_cntr_ack 4 // 4 scintillators with 4 primary particle hits
@@ -46,20 +48,40 @@ public:
   virtual ~AllPixRun();
 
   virtual void RecordEvent(const G4Event*);
+  // MT mode: called on the master's run for every worker run
+  virtual void Merge(const G4Run*);
   void RecordHits(const G4Event*);
   void RecordDigits(const G4Event*);
   void RecordTelescopeDigits(const G4Event*);
-  void SetLCIOBridgeFileDsc(ofstream * f, ofstream * fdut)
+  void SetLCIOBridgeFileDsc(AllPixLCIOBridgeWriter * f, AllPixLCIOBridgeWriter * fdut)
   { m_lciobridge_f = f; m_lciobridge_dut_f = fdut;};
 
   // filling frames
   void FillFramesNtuple(const G4Run *);
+  void FillFramesNtuple(G4int frameId);
   // fill timepix telescope files
   void FillTelescopeFiles(const G4Run *, G4String, G4bool, G4bool);
+  void FillTelescopeFiles(G4int frameId, G4String, G4bool, G4bool);
+  // .bin instead of .txt (/allpix/timepixtelescope/setBinary)
+  void SetTelescopeBinary(G4bool binary) { m_telescopeBinaryFlag = binary; };
+
+  // Frames within a single run (/allpix/beam/framesInRun).  The events
+  //  of the run are split in frames of the given sizes, each frame is
+  //  written when its last event is recorded.  Frame i takes the Id
+  //  GetRunID() + i, as it would have with one run per frame.
+  void SetFramesInRun(const vector<G4int> & frameSizes, G4String telescopeFolder,
+		      G4bool eventIDflag, G4bool sumTOTflag, AllPixWriteROOTFile ** rootFiles);
+  G4bool IsFramesInRun() { return !m_frameSizes.empty(); };
+  G4int GetFrameId() { return GetRunID() + m_frameIndex; };
+  // write a frame left incomplete by an aborted run
+  void FlushPendingFrame();
 
 
   //nalipour: MC hits
   void FillROOTFiles(AllPixWriteROOTFile** rootFiles); //fills the ROOT files
+  // RD53 files the run streams to, an entry every fillEvery events
+  //  (0 = one entry at the end of the run, by AllPixRunAction)
+  void SetROOTFiles(AllPixWriteROOTFile** rootFiles, G4int fillEvery);
   G4int return_detIdToIndex(G4int detId)
   {
     return m_detIdToIndex[detId];
@@ -71,6 +93,8 @@ public:
 
 private:
 
+  void FlushFrame();
+
   AllPixDetectorConstruction * m_detectorPtr;
   AllPixTrackerHitsCollection * m_hitsCollection;
 
@@ -80,8 +104,8 @@ private:
 
   // map index in frames handler to det Id
   map<int, int> m_detIdToIndex;
-  // map pixel X, Y, TOT per run
-  map<int,vector<vector<vector<int> > > > m_data;
+  // pixel X, Y, TOT per frame, streamed to scratch files
+  AllPixTelescopeWriter * m_telescope;
 
   // Frames ntuple  --> not storing whole Digits
   //  building frames from digits
@@ -100,8 +124,11 @@ private:
   G4int m_nOfSD;
 
   // coming from AllPixRunAction
-  ofstream * m_lciobridge_f;
-  ofstream * m_lciobridge_dut_f;
+  AllPixLCIOBridgeWriter * m_lciobridge_f;
+  AllPixLCIOBridgeWriter * m_lciobridge_dut_f;
+  // this run's event in the lcio bridge files
+  AllPixLCIOBridgeEvent m_lcioEvent;
+  AllPixLCIOBridgeEvent m_lcioDutEvent;
 
   G4String m_outputFilePrefix;
 
@@ -110,6 +137,19 @@ private:
   G4bool m_writeTPixTelescopeFilesFlag;
   G4bool m_writeMCFilesFlag; //nalipour: MC hits
 
+  // frames within a single run
+  vector<G4int> m_frameSizes;
+  G4int m_frameIndex;
+  G4int m_eventsInFrame;
+  G4int m_frameFirstEventId;
+  G4String m_telescopeFolderName;
+  G4bool m_telescopeEventIDflag;
+  G4bool m_telescopeSumTOTflag;
+  G4bool m_telescopeBinaryFlag;
+  AllPixWriteROOTFile ** m_rootFiles;
+  G4int m_rootFillEvery;
+  G4int m_eventsSinceROOTFill;
+
 };
 
 #endif
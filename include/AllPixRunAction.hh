@@ -59,6 +59,7 @@ class AllPixRun;
 class AllPixDetectorConstruction;
 class AllPixPrimaryGeneratorMessenger;
 class AllPixWriteROOTFile; //nalipour
+class AllPixLCIOBridgeWriter;
 //class FramesHandler;
 //class WriteToNtuple;
 
@@ -75,7 +76,7 @@ class AllPixRunAction : public G4UserRunAction
 {
 
 public:
-  AllPixRunAction(AllPixDetectorConstruction *, TString, TString, TString, TString);
+  AllPixRunAction(AllPixDetectorConstruction *, TString, TString, AllPixLCIOBridgeWriter *, AllPixLCIOBridgeWriter *);
   ~AllPixRunAction();
   
 public:
@@ -92,6 +93,9 @@ public:
   
 private:
 
+  // end of run output, one run per frame
+  void FillRunOutput(const G4Run* aRun);
+
   AllPixDetectorConstruction * m_detectorPtr;
   TString m_dataset;
   TString m_tempdir;
@@ -99,9 +103,9 @@ private:
   G4Timer* timer;
   AllPixRun * m_AllPixRun;
 
-  // file for lcio
-  ofstream * m_lciobridge_f;
-  ofstream * m_lciobridge_dut_f;
+  // file for lcio, owned by AllPixActionInitialization
+  AllPixLCIOBridgeWriter * m_lciobridge_f;
+  AllPixLCIOBridgeWriter * m_lciobridge_dut_f;
 
   AllPixPrimaryGeneratorMessenger * AllPixMessenger;
 
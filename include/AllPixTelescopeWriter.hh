@@ -0,0 +1,85 @@
+#ifndef AllPixTelescopeWriter_h
+#define AllPixTelescopeWriter_h 1
+
+#include "globals.hh"
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+/**
+ *  Timepix telescope files (/allpix/timepixtelescope/).
+ *
+ *  The digits are streamed per event: Add() appends a raw record
+ *  (x, y, tot, eventID) to a buffered scratch file of the plane, so
+ *  memory does not grow with the run.  Write() produces the file of
+ *  the frame from the scratch files, plane after plane, through one
+ *  output buffer, and starts over.
+ *
+ *  Text output: the mpx-<date>-0_<frame>.txt format, one header line per
+ *  plane, then "x \t y \t tot [\t eventID]" lines.  With sumTOT the TOT
+ *  of the digits in the same pixel are added up (flat hash keyed by
+ *  pixel), eventID is -1 when more than one digit was summed.
+ *
+ *  Binary output (mpx-<date>-0_<frame>.bin), same content, native
+ *  endianness, all fields int32 unless noted:
+ *    "ATPX" (4 chars), version (1), frame Id, start time (int64),
+ *    flags (1 = eventID column, 2 = sumTOT), number of planes,
+ *    per plane: detector Id, number of records,
+ *               records of x, y, tot [, eventID]
+ */
+class AllPixTelescopeWriter {
+
+public:
+
+	AllPixTelescopeWriter();
+	~AllPixTelescopeWriter();
+
+	// plane detId takes part in this event (header written even if empty)
+	void AddPlane(G4int detId);
+	void Add(G4int detId, G4int x, G4int y, G4int tot, G4int eventID);
+
+	// append the records of another writer (MT mode, worker runs)
+	void Merge(AllPixTelescopeWriter *);
+
+	// write the file for frameId in folderName and rewind
+	void Write(G4String folderName, G4int frameId, G4bool eventIDflag, G4bool sumTOTflag, G4bool binary);
+	void Rewind();
+
+private:
+
+	struct Plane {
+		FILE * scratch;
+		long nRecords;
+		G4bool active; // has events in this frame
+	};
+
+	// sumTOT, open addressing on the pixel key x*1000+y
+	struct PixelSum {
+		G4int key; // -1 = empty slot
+		G4int tot;
+		G4int eventID;
+		G4int nDigits;
+	};
+
+	Plane & GetPlane(G4int detId);
+	void SumPlane(Plane &);
+	void WritePlaneText(FILE *, Plane &, G4bool eventIDflag, G4bool sumTOTflag);
+	void WritePlaneBinary(FILE *, Plane &, G4bool eventIDflag, G4bool sumTOTflag);
+
+	map<G4int, Plane> m_planes;
+
+	vector<PixelSum> m_sum;
+	G4int m_sumEntries;
+	vector<PixelSum> m_sorted;
+
+	// block of raw records read back from a scratch file
+	vector<G4int> m_block;
+	// output buffer
+	vector<char> m_out;
+
+};
+
+#endif
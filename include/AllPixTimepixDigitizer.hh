@@ -21,6 +21,8 @@
 #include "G4PrimaryVertex.hh"
 #include "AllPixTrackerHit.hh"
 #include "AllPixGeoDsc.hh"
+#include "AllPixDriftEngine.hh"
+#include "AllPixDriftTable.hh"
 #include "TString.h"
 #include "TH2D.h"
 #include "TFile.h"
@@ -59,12 +61,21 @@ private:
   TH2D *hEy;
   TH2D *hEz;
   
-  G4bool doFastErf;
-  map<G4double,G4double> ErrorFunction;
+  G4bool doFastErf; // AllPixFastErf instead of TMath::Erf
   //map<G4double,G4double> MobilityHoleLUT;
   G4double MobilityHoleLUT[2001];
   G4double EMobilityHoleLUT[2001];
 
+  // drift models, see AllPixDriftEngine.hh
+  AllPixLinearField1D m_driftField;
+  AllPixCaugheyThomasMobility m_electronMobility;
+  AllPixTabulatedMobility m_holeMobility;
+
+  // tabulated drift response (1D field), /allpix/det/setDriftTable
+  G4bool doDriftTable;
+  AllPixDriftTable m_driftTable;
+  void BuildDriftTable();
+
   G4int hitindex;
 
   G4double pixelPositionWithRegardToCorner_x;
@@ -80,15 +91,9 @@ private:
   G4double MobilityHole(G4double x, G4double y=0, G4double z=0);
 
   void ComputeElectricField(G4double x, G4double y=0, G4double z=0);
-  void ComputeEffectiveElectricField(G4double, G4double, G4double);
-  vector<G4double> ComputeDriftTimeFullField(G4double x, G4double y, G4double z,G4double energy);
-  
-  
-  vector<G4double> RKF5IntegrationHoles(G4double x, G4double y, G4double z,G4double dt);
-  vector<G4double> RKF5IntegrationBFieldHoles(G4double x, G4double y, G4double z,G4double dt);
-  
-  vector<G4double> RKF5IntegrationElectrons(G4double x, G4double y, G4double z,G4double dt);
-  vector<G4double> RKF5IntegrationBFieldElectrons(G4double x, G4double y, G4double z,G4double dt); 
+  AllPixDriftResult ComputeDriftTimeFullField(G4double x, G4double y, G4double z,G4double energy);
+  template <class Engine>
+  AllPixDriftResult DriftCarrier(const Engine & engine, G4double x, G4double y, G4double z,G4double energy);
   
   G4double ComputeSubHitContribution(G4double x, G4double y, G4double z,G4double Energy);
   G4double SetDt(G4double Dt,G4double ErreurMoy);
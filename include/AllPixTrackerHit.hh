@@ -42,6 +42,8 @@
 #include "G4ThreeVector.hh"
 #include "G4Track.hh"
 
+#include "AllPixNameTable.hh"
+
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -73,10 +75,11 @@ public:
   void SetPos      (G4ThreeVector xyz){ pos = xyz; };
   void SetPosWithRespectToPixel (G4ThreeVector pxzy) { m_posWithRespectToPixel = pxzy; };
   void SetPosInLocalReferenceFrame (G4ThreeVector xyz) { m_posInLocalReferenceFrame = xyz; };
-  void SetProcessName(G4String process) { processName = process; };
+  // ids in AllPixNameTable
+  void SetProcessId(G4int id) { processId = id; };
   void SetTrackPdgId(G4int pdgId) { pdgIdTrack = pdgId; };
-  void SetTrackVolumeName(G4String vn) { trackVolumeName = vn; };
-  void SetParentVolumeName(G4String vn) { parentVolumeName = vn; } ;
+  void SetTrackVolumeId(G4int id) { trackVolumeId = id; };
+  void SetParentVolumeId(G4int id) { parentVolumeId = id; } ;
   void SetDetId(G4int i){ detID = i; };
   void SetKinEParent(G4double kinE){ kinEParent = kinE; };
   //void SetKineticEnergy     (G4double kinE) {kinE = kinE; };
@@ -92,10 +95,14 @@ public:
   G4ThreeVector GetPos(){ return pos; };
   G4ThreeVector GetPosWithRespectToPixel() { return m_posWithRespectToPixel; };
   G4ThreeVector GetPosInLocalReferenceFrame() {return m_posInLocalReferenceFrame; };
-  G4String GetProcessName() { return processName; };
+  G4int GetProcessId() { return processId; };
   G4int GetTrackPdgId() { return pdgIdTrack; };
-  G4String GetTrackVolumeName() {return trackVolumeName;};
-  G4String GetParentVolumeName() {return parentVolumeName;};
+  G4int GetTrackVolumeId() { return trackVolumeId; };
+  G4int GetParentVolumeId() { return parentVolumeId; };
+  // names from the table of this thread
+  const G4String & GetProcessName() { return AllPixNameTable::GetInstance()->GetName(processId); };
+  const G4String & GetTrackVolumeName() { return AllPixNameTable::GetInstance()->GetName(trackVolumeId); };
+  const G4String & GetParentVolumeName() { return AllPixNameTable::GetInstance()->GetName(parentVolumeId); };
   G4double GetKinEParent() { return kinEParent; };
   //G4double GetKineticEnergy(){ return kinE; };
   
@@ -112,10 +119,10 @@ private:
   G4ThreeVector pos;
   G4ThreeVector m_posWithRespectToPixel;
   G4ThreeVector m_posInLocalReferenceFrame;
-  G4String      processName;
+  G4int         processId;
   G4int         pdgIdTrack;
-  G4String      trackVolumeName;
-  G4String      parentVolumeName;
+  G4int         trackVolumeId;
+  G4int         parentVolumeId;
   G4double		kinEParent;
   //G4double      kinE;
 
@@ -41,12 +41,21 @@
 #include "G4WrapperProcess.hh"
 
 #include <set>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
 class G4Step;
+class G4Track;
 class G4HCofThisEvent;
 class G4Event;
+class G4VProcess;
+class G4VPhysicalVolume;
+class G4LogicalVolume;
+class G4Navigator;
+class G4TouchableHistory;
 class AllPixGeoDsc;
 
 #define MAX_CHAMBERS_EPIX 20
@@ -67,15 +76,42 @@ public:
   
   G4String GetHitsCollectionName(){ return m_thisHitsCollectionName; };
 
+  // single sensitive box per sensor, see AllPixDetectorConstruction::SetSingleSensitiveBox
+  void SetAnalyticPixelIndexing(bool flg){ m_analyticPixelIndexing = flg; };
+  bool GetAnalyticPixelIndexing(){ return m_analyticPixelIndexing; };
+
+  // hits of a parameterised sensor, see AllPixFastPlaneModel
+  void AddFastHit(const G4Track *, const G4ThreeVector &, const G4ThreeVector &, G4double, G4int);
+
 private:
 
+  // single sensitive box, hits of the step cut at the pixel boundaries
+  void ProcessHitsAnalytic(G4Step *, G4double);
+  void GetPixelCrossings(const G4ThreeVector &, const G4ThreeVector &, vector<G4double> &);
+
+  G4ThreeVector GetPosOnChip(const G4ThreeVector &);
+  G4ThreeVector GetPosWithRespectToPixel(const G4ThreeVector &);
+  void GetPixelIndex(const G4ThreeVector &, G4int &, G4int &);
+
+  // ids in AllPixNameTable, cached per pointer
+  G4int GetProcessId(const G4VProcess *);
+  G4int GetVolumeId(const G4VPhysicalVolume *);
+  G4int GetVolumeId(const G4LogicalVolume *);
+
   AllPixTrackerHitsCollection* hitsCollection;
   G4ThreeVector m_absolutePosOfWrapper; // Absolute position of Wrapper
   G4ThreeVector m_relativePosOfSD;      // Relative (to Wrapper) position of SD
-  G4RotationMatrix * m_rotationOfWrapper;  // rotation of Wrapper
+  G4RotationMatrix m_invRotationOfWrapper;  // global --> wrapper frame, from the rotation of the Wrapper
+  G4ThreeVector m_posOfChip;  // m_invRotationOfWrapper * m_absolutePosOfWrapper + m_relativePosOfSD
   AllPixGeoDsc * m_gD; // Geo description !
   G4String m_thisHitsCollectionName;
+  G4int m_HCID;
   bool m_thisIsAPixelDetector;
+  bool m_analyticPixelIndexing;
+  vector<G4double> m_crossings;  // ProcessHitsAnalytic, kept between steps
+  G4int m_transportationId;
+  G4Navigator * m_fastNavigator;        // AddFastHit, pixel volumes
+  G4TouchableHistory * m_fastTouchable;
   bool firstStrikePrimary;
   G4double _kinEPrimary;
   G4double _totalEdep;
@@ -83,7 +119,14 @@ private:
   // used to dump tracking info in special cases
   long m_globalTrackId_Dump;
 
+#ifdef ALLPIX_SD_CHECKS
   set<AllPixTrackerHitsCollection *> m_hitsCollectionSet;
+#endif
+
+  // AllPixNameTable ids by pointer, looked up at every step
+  unordered_map<const G4VProcess *, G4int> m_processIds;
+  unordered_map<const G4VPhysicalVolume *, G4int> m_physVolumeIds;
+  unordered_map<const G4LogicalVolume *, G4int> m_logVolumeIds;
 
 };
 
@@ -34,9 +34,10 @@ class AllPixWriteROOTFile
 public:
 
   AllPixWriteROOTFile(Int_t detID, TString path);
-  void AllPixWriteROOTFillTree();
+  // one tree entry.  The contents of d are taken (swapped into a
+  //  record of the pool, no copy), d is left empty.
+  void AllPixWriteROOTFillTree(ROOTDataFormat * d);
   void AllPixCloseROOTFile();
-  void SetVectors(ROOTDataFormat* d);
   virtual ~AllPixWriteROOTFile();
 
 
@@ -47,30 +48,14 @@ public:
 
   Int_t detectorID;
 
-  std::vector<Int_t> posX;
-  std::vector<Int_t> posY;
-  std::vector<Double_t> energyTotal;
-  std::vector<Int_t> TOT;
-  std::vector<Double_t> energyMC;
-  std::vector<Double_t> posX_WithRespectToPixel;
-  std::vector<Double_t> posY_WithRespectToPixel;
-  std::vector<Double_t> posZ_WithRespectToPixel;
-  /*
-  Int_t nHits_MC;
-  Int_t eventNB_MC;
-  std::vector<Int_t> posX_MC;
-  std::vector<Int_t> posY_MC;
-  std::vector<Double_t> energy_MC;
-
-  Int_t nHits;
-  Int_t eventNB;
-  std::vector<Int_t> posX;
-  std::vector<Int_t> posY;
-  std::vector<Double_t> energy;
-  std::vector<Int_t> TOT;
-  */
-
 private:
+
+  void WriteRecord(ROOTDataFormat *);
+
+  // The branches read from m_out (writer side).  Records are handed
+  //  to the output queue in instances of the pool.
+  ROOTDataFormat * m_out;
+  std::vector<ROOTDataFormat *> m_pool;
 };
 
 #endif
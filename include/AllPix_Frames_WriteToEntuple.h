@@ -7,6 +7,7 @@
 #define AllPix_Frames_WriteToEntuple_h 1
 
 #include <map>
+#include <vector>
 
 #include <TROOT.h>
 #include <TChain.h>
@@ -46,7 +47,11 @@ public:
 
 private:
 
+  void writeFrame(FrameStruct *);
+
   FrameStruct * m_frame;
+  // frames handed to the output queue, recycled once written
+  std::vector<FrameStruct *> m_pool; //!
 
   TH2 * h1;
   TFile * nt;
@@ -21,6 +21,8 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <mutex>
 
 using namespace std;
 
@@ -57,6 +59,12 @@ class SimpleHits {
   vector<string> trackVolumeName;
   // Name of volume where particle was created
   vector<string> parentVolumeName;
+  // columns format: codes of the process and volume names in the file
+  //  (Hits_WriteToNtuple::GetProcessCode, GetVolumeCode) instead of
+  //  the three vectors of names.  Not written with the object.
+  vector<UShort_t> processCode;      //!
+  vector<UShort_t> trackVolumeCode;  //!
+  vector<UShort_t> parentVolumeCode; //!
   // event
   int event;
   // run
@@ -67,12 +75,41 @@ class SimpleHits {
 
 /** Implements what is needed to write 
  *  hits to an Ntuple ROOT file.
+ *
+ *  Two formats (SetFormat, before the first file is opened):
+ *   "object"  : one SimpleHits object branch per event (default)
+ *   "columns" : flat split branches, one fixed type array per column
+ *               and nHits entries per event.  The strings (process,
+ *               volumes) are written as 16 bit codes, given by
+ *               GetProcessCode and GetVolumeCode the first time a
+ *               thread sees a name.  The names of the codes go to the
+ *               "AllPixHitsCodes" tree of the same file (index = code)
+ *               when the file is closed.
+ *
+ *  SetColumns selects the per hit columns written in both formats,
+ *  the unselected SimpleHits vectors are left empty.
  */
 
 class Hits_WriteToNtuple {
 
 public:
 
+  // per hit columns
+  enum {
+    kColX            = 0x001,
+    kColY            = 0x002,
+    kColZ            = 0x004,
+    kColEdep         = 0x008,
+    kColPdg          = 0x010,
+    kColTrack        = 0x020,
+    kColParent       = 0x040,
+    kColProcess      = 0x080,
+    kColTrackVolume  = 0x100,
+    kColParentVolume = 0x200,
+    kColPos          = kColX | kColY | kColZ,
+    kColAll          = 0x3ff
+  };
+
   Hits_WriteToNtuple(TString, TString, TString, Int_t, TString om="RECREATE");
   virtual ~Hits_WriteToNtuple(){};
   void fillVars(SimpleHits *);
@@ -83,7 +120,23 @@ public:
   //void SetBranchAddress(FrameStruct * fs){b2->SetAddress(fs);};
   //Int_t GetDetectorId(){return m_detID;};
 
+  // output configuration, false if not understood
+  static bool SetFormat(TString);
+  static bool SetColumns(TString);
+  static bool IsColumnar();
+  static bool HasColumn(unsigned int);
+
+  // columns format, code of a name in this file.  Any thread.
+  UShort_t GetProcessCode(const string &);
+  UShort_t GetVolumeCode(const string &);
+
 private:
+
+  void writeHits(SimpleHits *);
+  void fillColumns(SimpleHits *);
+  void growColumns(Int_t);
+  Int_t columnSize(size_t, Int_t, const char *, Int_t);
+  UShort_t getCode(map<string, UShort_t> &, vector<string> &, const string &);
   
   TFile * nt;
   TTree * t2;
@@ -94,6 +147,35 @@ private:
 
   // to ntuple
   SimpleHits * m_storableHits;
+  // events handed to the output queue, recycled once written
+  vector<SimpleHits *> m_pool;
+
+  // columns format
+  bool m_columnar;
+  unsigned int m_columns;
+  Int_t m_capacity;
+  Int_t m_event;
+  Int_t m_run;
+  Double_t m_edepTotal;
+  Double_t m_kinEParent;
+  Int_t m_nHits;
+  vector<Float_t> m_x;
+  vector<Float_t> m_y;
+  vector<Float_t> m_z;
+  vector<Float_t> m_edep;
+  vector<Int_t> m_pdg;
+  vector<Int_t> m_track;
+  vector<Int_t> m_parent;
+  vector<UShort_t> m_process;
+  vector<UShort_t> m_trackVolume;
+  vector<UShort_t> m_parentVolume;
+
+  // per file code dictionaries
+  std::mutex m_codesMutex;
+  map<string, UShort_t> m_processCodes;
+  vector<string> m_processNames;
+  map<string, UShort_t> m_volumeCodes;
+  vector<string> m_volumeNames;
 
   //ClassDef(Hits_WriteToNtuple,1)
 };
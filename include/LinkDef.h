@@ -5,9 +5,7 @@
 #pragma link off all classes;
 #pragma link off all functions;
 
-#pragma link C++ class FrameStruct+;
-#pragma link C++ class FrameContainer+;
+// FrameStruct, FrameContainer and SimpleHits: AllPixDmLinkDef.h
 #pragma link C++ class WriteToNtuple+;
-#pragma link C++ class SimpleHits+;
 #pragma link C++ class AllPixDigitAnimation+;
 
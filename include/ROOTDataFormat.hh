@@ -38,14 +38,25 @@ public:
   void add_posY_WithRespectToPixel(Double_t pos) {posY_WithRespectToPixel.push_back(pos);};
   void add_posZ_WithRespectToPixel(Double_t pos) {posZ_WithRespectToPixel.push_back(pos);};
 
-  vector<Int_t> get_posX() {return posX;};
-  vector<Int_t> get_posY() {return posY;};
-  vector<Double_t> get_energyTotal() {return energyTotal;};
-  vector<Int_t> get_TOT() {return TOT;};
-  vector<Double_t> get_energyMC() {return energyMC;};
-  vector<Double_t> get_posX_WithRespectToPixel() {return posX_WithRespectToPixel;};
-  vector<Double_t> get_posY_WithRespectToPixel() {return posY_WithRespectToPixel;};
-  vector<Double_t> get_posZ_WithRespectToPixel() {return posZ_WithRespectToPixel;};
+  const vector<Int_t> & get_posX() {return posX;};
+  const vector<Int_t> & get_posY() {return posY;};
+  const vector<Double_t> & get_energyTotal() {return energyTotal;};
+  const vector<Int_t> & get_TOT() {return TOT;};
+  const vector<Double_t> & get_energyMC() {return energyMC;};
+  const vector<Double_t> & get_posX_WithRespectToPixel() {return posX_WithRespectToPixel;};
+  const vector<Double_t> & get_posY_WithRespectToPixel() {return posY_WithRespectToPixel;};
+  const vector<Double_t> & get_posZ_WithRespectToPixel() {return posZ_WithRespectToPixel;};
+  Int_t get_detectorID() {return detectorID;};
+  bool IsEmpty() {return posX.empty();};
+
+  // append the records of another instance (MT mode, worker runs)
+  void Merge(const ROOTDataFormat * d);
+  // empty all the vectors, keeps the detector Id
+  void Rewind();
+  // exchange the contents (not the detector Id) with another instance
+  void Swap(ROOTDataFormat * d);
+  // branches of the RD53 tree, reading from this instance
+  void Branch(TTree * t);
 
 
 /*
@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <stdint.h>
 
 #include "AllPixGeoDsc.hh"
 #include "G4Types.hh"
@@ -21,6 +23,31 @@ class TXMLNode;
 
 #define __FIRST_DET_INDX 0
 
+/**
+ *  Optional cache of the parsed database (SetCacheDir), one file per
+ *  xml content: <dir>/<xml name>_<hash>.geocache.  Header, then
+ *  nDetectors AllPixGeoDscRecord, replicas included.
+ */
+#define ALLPIX_GEOCACHE_MAGIC "APXGEOC"
+#define ALLPIX_GEOCACHE_VERSION 1
+
+struct AllPixGeoCacheHeader {
+	char magic[8];        // ALLPIX_GEOCACHE_MAGIC
+	int32_t version;      // ALLPIX_GEOCACHE_VERSION
+	int32_t recordBytes;  // sizeof(AllPixGeoDscRecord)
+	int32_t nDetectors;
+	int32_t reserved;
+	uint64_t xmlHash;     // FNV-1a of the xml file
+};
+
+// a tag of the xml database and the AllPixGeoDsc setter it goes to
+struct ReadGeoTag {
+	enum { kInt, kLength, kDouble, kString } type;
+	void (AllPixGeoDsc::*setInt)(G4int);
+	void (AllPixGeoDsc::*setDouble)(G4double);
+	void (AllPixGeoDsc::*setString)(G4String);
+};
+
 class ReadGeoDescription {
 
 public:
@@ -29,6 +56,8 @@ public:
 	~ReadGeoDescription(){};
 
 	static ReadGeoDescription * GetInstance();
+	// directory of the binary cache, empty = no cache (default)
+	static void SetCacheDir(string);
 
 	map<int, AllPixGeoDsc *> * GetDetectorsMap(){return &m_detsGeo;};
 	void BuildListOfExpectedTags();
@@ -39,10 +68,18 @@ public:
 	G4int UseTheseDetectorsOnly(vector<G4int>);
 
 private:
+	void SetFromTag(const ReadGeoTag &, const string &);
+	bool ReadCache(string, uint64_t);
+	void WriteCache(string, uint64_t);
+
 	string m_xmlfile;
 	string m_currentNodeName;
 	string m_currentAtt;
 
+	// hashed dispatch of the text nodes, tag of the current element
+	unordered_map<string, ReadGeoTag> m_tags;
+	const ReadGeoTag * m_currentTag;
+
 	map<int, AllPixGeoDsc *> m_detsGeo;
 	//vector<int> m_detsGeoIndx;
 	map<int, vector<int> > m_detsGeoIndx;
@@ -30,17 +30,18 @@ class FrameContainer {
 
 private:
 
-	// Zero suppressed, X,counts or X,TOT
-	std::map<int, int> m_frameXC;
+	// Zero suppressed, sorted parallel arrays.  Pixel X = y*width + x
+	std::vector<Int_t> m_pixelIndex;
+	// counts or TOT
+	std::vector<Int_t> m_pixelCounts;
+	// The arrays below are either empty (never filled in this frame)
+	//  or the size of m_pixelIndex.
 	// Trigger
-	std::map<int, int> m_lvl1;
-	// FIXME -->  I am unable to deserialize here <int, double>
+	std::vector<Int_t> m_pixelLVL1;
 	// Truth energy (from Hits)
-	std::map<int, int> m_frameXC_TruthE;
-	// Truth energy multithreshold
-	//std::map<int, vector<Double_t> > m_frameXC_TruthE_multiThl;
+	std::vector<Double_t> m_pixelTruthE;
 	// Corrected MC charge (detector effects included, at Digitization step)
-	std::map<int, int> m_frameXC_E;
+	std::vector<Double_t> m_pixelE;
 
 	// Counters
 	// The number of pixels ON
@@ -55,6 +56,9 @@ private:
 	// If data is MC this flag is set to true
 	Bool_t m_isMCData;
 
+	// position of pixel X in the arrays, inserted with 0s if absent
+	size_t PixelPosition(Int_t X, Bool_t & added);
+
 public:
 	FrameContainer();
 	virtual ~FrameContainer(){};
@@ -62,15 +66,30 @@ public:
 	//void FillOneElement(Int_t xi, Int_t yi, Int_t width, Int_t counts, vector<Double_t> truthE, vector<Double_t> E); // multi threshold
 	void FillOneElement(Int_t, Int_t, Int_t, Int_t);
 	void SetLVL1(Int_t, Int_t, Int_t, Int_t);
+	// zero suppressed pixels, index = y*width + x, ascending (AllPixFrameFile)
+	void FillZeroSuppressed(const UInt_t *, const UShort_t *, Int_t);
+	// pixels with counts != 0, ascending index
+	void GetPixels(std::vector<UInt_t> &, std::vector<Int_t> &) const;
+	// the stored arrays, LVL1 and energies may be empty
+	const std::vector<Int_t> & GetPixelIndex() const {return m_pixelIndex;};
+	const std::vector<Int_t> & GetPixelCounts() const {return m_pixelCounts;};
+	const std::vector<Int_t> & GetPixelLVL1() const {return m_pixelLVL1;};
+	const std::vector<Double_t> & GetPixelTruthE() const {return m_pixelTruthE;};
+	const std::vector<Double_t> & GetPixelE() const {return m_pixelE;};
+	// class version <= 3 on file, std::map members (LinkDef.h read rule)
+	void FillFromMaps(const std::map<int, int> &, const std::map<int, int> &,
+			const std::map<int, int> &, const std::map<int, int> &);
 
 	void ResetCountersPad();
 	void CleanUpMatrix();
+	// add the contents of another frame (MT mode, merging of worker frames)
+	void Merge(const FrameContainer &);
 	void SetFrameAsMCData(){m_isMCData = true;};
 	Int_t GetEntriesPad(){return m_nEntriesPad;};
 	Int_t GetHitsInPad(){return m_nHitsInPad;};
 	Int_t GetChargeInPad(){return m_nChargeInPad;};
 
-	ClassDef(FrameContainer,3)
+	ClassDef(FrameContainer,4)
 };
 
 
@@ -136,8 +155,11 @@ public:
 	void RewindMetaDataValues();
 	void SetnX(int x){fWidth = x;};
 	void SetnY(int y){fHeight = y;};
+	Int_t GetnX(){return fWidth;};
+	Int_t GetnY(){return fHeight;};
+	void Merge(const FrameStruct &);
 
-	ClassDef(FrameStruct,4)
+	ClassDef(FrameStruct,5)
 };
 
 
@@ -165,6 +187,11 @@ private:
 	Int_t nFrames256x256;
 	Int_t nFramesXYC;
 
+	/* zero suppressed binary frame (AllPixFrameFile) */
+	Bool_t readOneFrameZS(TString, TString);
+	/* metadata lines of a .dsc */
+	void readMetaData(std::istream &);
+
 	// in case I am dealing with more than one detector
 	Int_t m_detID;
 
@@ -177,7 +204,8 @@ public:
 	/*****************************************************
 	 *  Filling frame methods
 	 */
-	/* Reads from txt & dsc files.  Completely fills m_aFrame. */
+	/* Reads from txt & dsc files, or a zero suppressed binary frame
+	 *  (allpix-frame-convert, the dsc is then optional).  Completely fills m_aFrame. */
 	Bool_t readOneFrame(TString, TString);
 	/* load a single frame pixel (X,Y,C), fills m_aFrame */
 	Bool_t LoadFramePixel(Int_t, Int_t, Int_t, Double_t, Double_t);
@@ -203,6 +231,8 @@ public:
 	Int_t GetDetectorId(){return m_detID;};
 	void  SetDetectorId(Int_t id){m_detID = id;};
 	void RewindAll();
+	/* add the frame held by another handler to this one */
+	void Merge(FramesHandler *);
 	//TH2I * getAFrameHist(TString, TString, TString);
 	Int_t ** getAFrameMatrix(TString, TString);
 	//TH2I * getHistFrame(Int_t, Int_t *);
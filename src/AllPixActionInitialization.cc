@@ -0,0 +1,75 @@
+#include "AllPixActionInitialization.hh"
+
+#include "AllPixDetectorConstruction.hh"
+#include "AllPixPrimaryGeneratorAction.hh"
+#include "AllPixRunAction.hh"
+#include "AllPixEventAction.hh"
+#include "AllPixSteppingVerbose.hh"
+#include "AllPixLCIOBridge.hh"
+
+AllPixActionInitialization::AllPixActionInitialization(AllPixDetectorConstruction * det, TString ds, TString td, TString lciofn, TString lciofn_dut)
+: G4VUserActionInitialization()
+{
+
+	m_detectorPtr = det;
+	m_dataset = ds;
+	m_tempdir = td;
+
+	// file for lcio format conversion, <name>.txt and/or <name>.bin
+	//  (/allpix/config/setLCIOBridgeFormat), opened by the first event
+	m_lciobridge_f = new AllPixLCIOBridgeWriter(lciofn.Data());
+	m_lciobridge_dut_f = new AllPixLCIOBridgeWriter(lciofn_dut.Data());
+
+	m_sourceType = _GeneralParticleSource;
+	//m_sourceType = _HEPEvtInterface;
+
+	m_masterGenAction = 0x0;
+
+}
+
+AllPixActionInitialization::~AllPixActionInitialization(){
+
+	delete m_lciobridge_f;
+	delete m_lciobridge_dut_f;
+
+	if(m_masterGenAction) delete m_masterGenAction;
+
+}
+
+void AllPixActionInitialization::BuildForMaster() const {
+
+	m_masterGenAction = new AllPixPrimaryGeneratorAction(m_sourceType);
+
+	AllPixRunAction * run_action = new AllPixRunAction(m_detectorPtr, m_dataset, m_tempdir,
+			m_lciobridge_f, m_lciobridge_dut_f);
+	run_action->GetPrimaryGeneratorMessenger(m_masterGenAction);
+	SetUserAction(run_action);
+
+}
+
+void AllPixActionInitialization::Build() const {
+
+	// Hits ! --> Ntuple to store hits
+	// creates AllPixRun to analyze hits at the end of event
+	AllPixRunAction * run_action = new AllPixRunAction(m_detectorPtr, m_dataset, m_tempdir,
+			m_lciobridge_f, m_lciobridge_dut_f);
+	SetUserAction(run_action);
+
+	// Particle gun
+	AllPixPrimaryGeneratorAction * gen_action = new AllPixPrimaryGeneratorAction(m_sourceType);
+	SetUserAction(gen_action);
+
+	// Get the PrimaryGeneratorMessenger to get a hold of some of its member variables
+	run_action->GetPrimaryGeneratorMessenger(gen_action);
+
+	// Digits ! --> calls Digitize, and makes ntuple to store digits
+	AllPixEventAction * event_action = new AllPixEventAction(run_action);
+	SetUserAction(event_action);
+
+}
+
+G4VSteppingVerbose * AllPixActionInitialization::InitializeSteppingVerbose() const {
+
+	return new AllPixSteppingVerbose;
+
+}
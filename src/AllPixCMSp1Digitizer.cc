@@ -97,6 +97,10 @@ void AllPixCMSp1Digitizer::InitVariables(){
 	
 	Electron_HallFactor = 1.12;
 	Electron_ec = 100*1.01 * TMath::Power(Temperature, 1.55); // ec from pixelav
+
+	// The field map works in mm and V/cm
+	m_driftField = AllPixMapField3D(gD, 100., m);
+	m_electronMobility = AllPixCaugheyThomasMobility(Electron_Mobility, Electron_ec, Electron_Beta);
 	
 	Boltzmann_kT = 8.6173e-5*Temperature; // eV
 	// Boltzmann_kT = 1.38e-23*Temperature; // J
@@ -105,6 +109,13 @@ void AllPixCMSp1Digitizer::InitVariables(){
 	Timestep_max = 0.1e-9;
 	Timestep_min = 0.005e-9;
 	
+	// Propagation cutoffs.  The full drift takes a few ns, a group
+	//  still in the sensor after this is lost (low field region, or
+	//  no trapping at all: TauNoFluence is 1 s).
+	Drift_Time_Max = 50e-9;
+	Drift_Steps_Max = 20000;
+	m_nCutOff = 0;
+	
 	Electron_Scaling = 10;
 	
 	// Variables for Smearing and Digitizing
@@ -158,21 +169,20 @@ void AllPixCMSp1Digitizer::Digitize(){
 	hitsCollection = (AllPixTrackerHitsCollection*)(digiMan->GetHitsCollection(hcID));
 	
 	// temporary data structure
-	map<pair<G4int, G4int>, G4double > pixelsContent;
+	AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator();
 	pair<G4int, G4int> tempPixel;
 	pair<G4int, G4int> endPixel;
 	
 	G4double createdElectronsStep = 0;
-	G4double createdElectronsRemaining = 0;
 	G4double nElectrons = 0;
-	
-	G4double drifttime;
-	G4bool chargeTrapped;
+	G4int nGroups = 0;
 	
 	G4int nEntries = hitsCollection->entries();
 	
 	G4ThreeVector position;
 	
+	m_nCutOff = 0;
+	
 	for(G4int itr  = 0 ; itr < nEntries ; itr++) {
 		
 		// Calculate number of electrons
@@ -181,43 +191,49 @@ void AllPixCMSp1Digitizer::Digitize(){
 		tempPixel.first  = (*hitsCollection)[itr]->GetPixelNbX();
 		tempPixel.second = (*hitsCollection)[itr]->GetPixelNbY();
 
-		// Loop over all electrons (do (Electron_Scaling) electrons in one step)
-		createdElectronsRemaining = createdElectronsStep;
-		while(createdElectronsRemaining > 0.){
-			
-			// Define number of electrons to be propagated and remove electrons of this step from the total
-			if(Electron_Scaling > createdElectronsRemaining){
-				nElectrons = createdElectronsRemaining;
-			}else{
-				nElectrons = Electron_Scaling;
-			}
+		// The electrons are propagated in groups of Electron_Scaling,
+		//  all the groups of the hit together (see AllPixCarrierBatch)
+		if(createdElectronsStep <= 0.) continue;
+		nGroups = (G4int)ceil(createdElectronsStep/Electron_Scaling);
 			
-			createdElectronsRemaining -= nElectrons;
+		// Get Position and propagate through sensor
+		position = (*hitsCollection)[itr]->GetPosInLocalReferenceFrame();
+		position[2] += detectorThickness/2.;
+		
+		m_carriers.Reset(nGroups, position.x(), position.y(), position.z());
+		Propagation(m_carriers);
+		
+		const G4double * x = m_carriers.X();
+		const G4double * y = m_carriers.Y();
+		for(G4int i = 0 ; i < nGroups ; i++){
 			
-			// Get Position and propagate through sensor
-			position = (*hitsCollection)[itr]->GetPos(); // This is in a global frame!!!!!!!!!!!!
+			if(m_carriers.IsTrapped(i)) continue;
 			
-			position = (*hitsCollection)[itr]->GetPosInLocalReferenceFrame();
-			position[2] += detectorThickness/2.;
+			// the last group takes the remaining electrons
+			nElectrons = createdElectronsStep - i*Electron_Scaling;
+			if(nElectrons > Electron_Scaling) nElectrons = Electron_Scaling;
 			
-			// G4cout << position << G4endl;
-			Propagation(position, drifttime, chargeTrapped);
-			endPixel.first = floor((position.x()+SensorHalfSizeX)/PixelSizeX);
-			endPixel.second = floor((position.y()+SensorHalfSizeY)/PixelSizeY);
+			endPixel.first = floor((x[i]+SensorHalfSizeX)/PixelSizeX);
+			endPixel.second = floor((y[i]+SensorHalfSizeY)/PixelSizeY);
 			
-			if(!chargeTrapped) pixelsContent[endPixel] += nElectrons;
+			pixelsContent[endPixel] += nElectrons;
 			
 		} // splitted electrons
 		
 	} // Charge collection
 	
+	if(m_nCutOff > 0){
+		G4cout << "[WARNING] (AllPixCMSp1Digitizer) " << m_nCutOff << " electron group(s) still drifting after "
+		<< Drift_Time_Max*1e9 << " ns or " << Drift_Steps_Max << " steps, not collected" << G4endl;
+	}
+	
 	// Loop over all pixels for smearing, ADC and storage
 	
 	pair<G4int, G4int> pixel;
 	G4double pixelCharge;
 	G4int pixelADC;
 	
-	map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+	AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
 		
 	for( ; pCItr != pixelsContent.end() ; pCItr++)
 	{
@@ -260,109 +276,6 @@ void AllPixCMSp1Digitizer::Digitize(){
 
 
 
-vector<G4double>  AllPixCMSp1Digitizer::RKF5Integration(G4ThreeVector position, G4double dt)
-{
-	// This function transport using Euler integration, for field (Ex,Ey,Ez),
-	// considered constant over time dt. The movement equation are those
-	// of charges in semi-conductors, sx= mu*E*dt;;
-	G4ThreeVector deltaposition;
-	
-	G4ThreeVector electricField;
-	G4ThreeVector temppos;
-	
-	G4ThreeVector k1, k2, k3, k4, k5, k6;
-	
-	electricField = 100.*gD->GetEFieldFromMap(position);
-	k1 = (ElectronSpeed(electricField)*dt);
-	
-	// G4cout << "z: " << position[2] << "\t\t" << ElectronSpeed(electricField) << G4endl;
-	// G4cout << "z: " << position[2] << "\t\t" << electricField << G4endl;
-
-	// G4cout << "Field: " << electricField << G4endl;
-	// G4cout << "Speed: " << ElectronSpeed(electricField) << G4endl;
-	
-	temppos = position + (1./4.)*k1;
-	electricField = 100.*gD->GetEFieldFromMap(temppos);
-	k2 = (ElectronSpeed(electricField)*dt);
-	
-	temppos = position + (3./32.)*k1 + (9./32.)*k2;
-	electricField = 100.*gD->GetEFieldFromMap(temppos);
-	k3 = (ElectronSpeed(electricField)*dt);
-	
-	temppos = position + (1932./2197)*k1 + (-7200./2197)*k2 + (7296./2197)*k3;
-	electricField = 100.*gD->GetEFieldFromMap(temppos);
-	k4 = (ElectronSpeed(electricField)*dt);
-	
-	temppos = position + (439./216)*k1 + (-8)*k2 + (3680./513)*k3 + (-845./4104)*k4;
-	electricField = 100.*gD->GetEFieldFromMap(temppos);
-	k5 = (ElectronSpeed(electricField)*dt);
-	
-	temppos = position + (-8./27)*k1 + (2)*k2 + (-3544./2565)*k3 + (1859./4104)*k4 + (-11./40)*k5;
-	electricField = 100.*gD->GetEFieldFromMap(temppos);
-	k6 = (ElectronSpeed(electricField)*dt);
-	
-	deltaposition = (16./135)*k1 + (0.)*k2 + (6656./12825)*k3 + (28561./56430)*k4 + (-9./50)*k5 + (2./55)*k6;
-	
-	G4ThreeVector error;
-	error = (1./360)*k1 + (0.)*k2 + (-128./4275)*k3 + (-2197./75240)*k4 + (1./50)*k5 + (2./55)*k6;
-	
-	G4double Erreur;
-	Erreur=error.mag();
-	
-	vector<G4double> deltapoint(4);
-	deltapoint[0]=deltaposition[0];
-	deltapoint[1]=deltaposition[1];
-	deltapoint[2]=deltaposition[2];
-	deltapoint[3]=(Erreur);
-	
-	return deltapoint;
-	
-}
-
-G4double AllPixCMSp1Digitizer::MobilityElectron(const G4ThreeVector efield){
-	
-	// calculate mobility in m2/V/s
-	
-	G4double mobility = Electron_Mobility * TMath::Power((1.+ TMath::Power(efield.mag()/Electron_ec,Electron_Beta)),-1.0/Electron_Beta);
-	// G4cout << "Mobility: " << mobility << G4endl;
-	return mobility;
-
-}
-
-G4ThreeVector AllPixCMSp1Digitizer::ElectronSpeed(const G4ThreeVector efield){
-	
-	G4ThreeVector term[3];
-	G4double mobility = MobilityElectron(efield);
-	
-	G4double rnorm = 1. + mobility*mobility*Electron_HallFactor*Electron_HallFactor*bfield.dot(bfield);
-	
-	term[0] = -efield;
-	term[1] = mobility*Electron_HallFactor*efield.cross(bfield);
-	term[2] = -mobility*mobility*Electron_HallFactor*Electron_HallFactor*efield.dot(bfield)*bfield;
-	
-	G4ThreeVector speed = mobility*(term[0]+term[1]+term[2])/rnorm;
-	
-	return speed;
-	
-}
-
-G4ThreeVector AllPixCMSp1Digitizer::DiffusionStep(const G4double timestep, const G4ThreeVector position){
-	
-	G4ThreeVector diffusionVector;
-	
-	G4ThreeVector electricField = 100.*gD->GetEFieldFromMap(position);
-	G4double D = Boltzmann_kT*MobilityElectron(electricField);
-	G4double Dwidth = TMath::Sqrt(2.*D*timestep);
-	
-	for (size_t i = 0; i < 3; i++) {
-		diffusionVector[i] = CLHEP::RandGauss::shoot(0.,Dwidth)*um;
-	}
-	
-	// TMath::Sqrt(2.*D*timestep);
-	return diffusionVector;
-	
-}
-
 void AllPixCMSp1Digitizer::SetDt(G4double& dt, const G4double uncertainty, const G4double z, const G4double dz){
 	
 	G4double dt_init = dt;
@@ -377,55 +290,118 @@ void AllPixCMSp1Digitizer::SetDt(G4double& dt, const G4double uncertainty, const
 	
 }
 
-G4double AllPixCMSp1Digitizer::GetTrappingTime(){
-	
-	return(-Electron_Trap_TauEff*log(CLHEP::RandFlat::shoot()));
-	
-}
-
 /*
 	This function propagates an electron through the sensor and updates the position vector.
 */
 
 G4double AllPixCMSp1Digitizer::Propagation(G4ThreeVector& pos, G4double& drifttime, G4bool& trapped){
+
+	AllPixCarrierBatch one;
+	one.Reset(1, pos.x(), pos.y(), pos.z());
+	Propagation(one);
+
+	pos = G4ThreeVector(one.X()[0], one.Y()[0], one.Z()[0]);
+	drifttime = one.T()[0];
+	trapped = one.IsTrapped(0);
+
+	return drifttime;
+
+}
+
+/*
+	Propagates all the lanes of the batch in lockstep until they leave the
+	sensor or get trapped.  Each lane keeps its own adaptive time step.
+*/
+
+void AllPixCMSp1Digitizer::Propagation(AllPixCarrierBatch & batch){
+
+	if(bfield.mag2() != 0.){
+		AllPixDriftEngine<kAllPixElectron, AllPixMapField3D, AllPixCaugheyThomasMobility, true>
+		engine(m_driftField, m_electronMobility, bfield, Electron_HallFactor);
+		Propagation(engine, batch);
+		return;
+	}
+
+	AllPixDriftEngine<kAllPixElectron, AllPixMapField3D, AllPixCaugheyThomasMobility, false>
+	engine(m_driftField, m_electronMobility);
+	Propagation(engine, batch);
+
+}
+
+template <class Engine>
+void AllPixCMSp1Digitizer::Propagation(const Engine & engine, AllPixCarrierBatch & batch){
 	
-	vector<G4double> deltapoint(4);
+	const G4int n = batch.Size();
 	
-	drifttime = 0.;
-	G4double dt = 0.01*1e-9;
+	G4double * x = batch.X();
+	G4double * y = batch.Y();
+	G4double * z = batch.Z();
+	G4double * t = batch.T();
+	G4double * dt = batch.Dt();
+	G4double * tTrap = batch.TTrap();
 	
-	G4double trappingTime = GetTrappingTime();
+	// trapping times, one per lane
+	const G4double * u = batch.Flat(n);
+	for(G4int i = 0 ; i < n ; i++){
+		tTrap[i] = -Electron_Trap_TauEff*log(u[i]);
+		dt[i] = 0.01*1e-9;
+	}
 	
-	trapped = false;
+	for(G4int i = 0 ; i < n ; i++){
+		if(z[i] <= 0. || z[i] >= detectorThickness) batch.Kill(i);
+	}
 	
-	G4int nsteps=0;
-
-	while(pos[2] > 0 && pos[2] < detectorThickness/1000.)
+	AllPixDriftStep step;
+	G4int nSteps = 0;
+	
+	while(batch.NAlive() > 0)
 	{
 		
-		if(drifttime > trappingTime){
-			trapped = true;
+		if(++nSteps > Drift_Steps_Max){
+			for(G4int i = 0 ; i < n ; i++){
+				if(batch.IsAlive(i)) { batch.Trap(i); m_nCutOff++; }
+			}
 			break;
 		}
 		
-		deltapoint = RKF5Integration(pos,dt);
-		for (size_t i = 0; i < 3; i++) {pos[i]+=deltapoint[i]/nm*um;}
-		drifttime += dt;
-
-
-		pos += DiffusionStep(dt, pos);
-
-
-		// Adapt step size 
-		SetDt(dt, deltapoint[3], pos[2], deltapoint[2]/nm*um);
-
-		nsteps++;
+		// diffusion, three per alive lane
+		const G4double * g = batch.Gauss(3*batch.NAlive());
+		G4int k = 0;
+		
+		for(G4int i = 0 ; i < n ; i++){
+			
+			if(!batch.IsAlive(i)) continue;
+			
+			if(t[i] > tTrap[i]){
+				batch.Trap(i);
+				continue;
+			}
+			if(t[i] > Drift_Time_Max){
+				batch.Trap(i);
+				m_nCutOff++;
+				continue;
+			}
+			
+			// The engine works in m
+			step = engine.Step(x[i]/m, y[i]/m, z[i]/m, dt[i]);
+			x[i] += step.dx*m;
+			y[i] += step.dy*m;
+			z[i] += step.dz*m;
+			t[i] += dt[i];
+			
+			// D = kT mu, width in m
+			G4double E = engine.GetField()(x[i]/m, y[i]/m, z[i]/m).mag();
+			G4double Dwidth = sqrt(2.*Boltzmann_kT*m_electronMobility(E)*dt[i])*m;
+			x[i] += Dwidth*g[k++];
+			y[i] += Dwidth*g[k++];
+			z[i] += Dwidth*g[k++];
+			
+			// Adapt step size 
+			SetDt(dt[i], step.err, z[i], step.dz*m);
+			
+			if(z[i] <= 0. || z[i] >= detectorThickness) batch.Kill(i);
+		}
+		
 	}
-	// if(trapped) G4cout << "Charge was trapped." << G4endl;
-	// G4cout << "Endposition: " << pos << G4endl;
-	// G4cout << "Total drift time in ns: " << drifttime*1e9 << G4endl;
-	// G4cout << "Step count: " << nsteps << G4endl;
-	
-	return drifttime;
 	
 }
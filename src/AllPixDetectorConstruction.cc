@@ -66,8 +66,13 @@
 #include "G4UnionSolid.hh"
 
 #include "G4NistManager.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
 
 #include "AllPixGeoDsc.hh"
+#include "AllPixFastPlaneModel.hh"
+#include "G4FastSimulationManager.hh"
 #include "ReadGeoDescription.hh"
 
 #include "G4DigiManager.hh"
@@ -109,6 +114,8 @@ AllPixDetectorConstruction::AllPixDetectorConstruction()
 	m_buildTestStructureFlag = false;
 	m_TestStructure_type = 0;
 	m_clearanceToBuildGeometry = false;
+	m_geometryBuilt = false;
+	m_geometryGeneration = 0;
 
 	m_Air = 0x0;
 	m_Vacuum = 0x0;
@@ -140,7 +147,15 @@ void AllPixDetectorConstruction::DefineSensitiveDetector(){
 G4VPhysicalVolume * AllPixDetectorConstruction::Construct()
 {
 
-	// Clean old geometry, if any
+	// Asked again by the run manager after a /run/reinitializeGeometry
+	//  (see UpdateGeometry), the geometry of the last update is kept.
+	if(m_geometryBuilt) return expHall_phys;
+
+	// Clean old geometry, if any.  The regions go first, they point
+	//  to the logical volumes.
+	map<int, G4Region *>::iterator regionItr = m_sensorRegion.begin();
+	for( ; regionItr != m_sensorRegion.end() ; regionItr++) delete (*regionItr).second;
+	m_sensorRegion.clear();
 	G4GeometryManager::GetInstance()->OpenGeometry();
 	G4PhysicalVolumeStore::GetInstance()->Clean();
 	G4LogicalVolumeStore::GetInstance()->Clean();
@@ -336,6 +351,80 @@ void AllPixDetectorConstruction::SetFlux(G4double flux){
 	m_fluxes[*m_detIdItr] = flux;
 }
 
+/**
+ * Build the sensor as one sensitive box instead of dividing
+ * it in NPixelsX x NPixelsY pixel volumes.
+ */
+void AllPixDetectorConstruction::SetSingleSensitiveBox(G4bool flg){
+	if(m_detId.empty()){
+		_BUILD_MEDIPIX_MSG();
+		exit(1);
+	}
+
+	m_singleSensitiveBox[*m_detIdItr] = flg;
+}
+
+/**
+ * Tabulated drift response in the digitizers
+ *  using the 1D field (see AllPixDriftTable).
+ */
+void AllPixDetectorConstruction::SetDriftTable(G4bool flg){
+	if(m_detId.empty()){
+		_BUILD_MEDIPIX_MSG();
+		exit(1);
+	}
+
+	m_driftTable[*m_detIdItr] = flg;
+}
+
+/**
+ * Bump bonds model: parameterised, replica or slab.
+ */
+void AllPixDetectorConstruction::SetBumpModel(G4String model){
+	if(m_detId.empty()){
+		_BUILD_MEDIPIX_MSG();
+		exit(1);
+	}
+
+	m_bumpModel[*m_detIdItr] = model;
+}
+
+/**
+ * Production cut in the region of the sensor.
+ */
+void AllPixDetectorConstruction::SetRegionCut(G4double cut){
+	if(m_detId.empty()){
+		_BUILD_MEDIPIX_MSG();
+		exit(1);
+	}
+
+	m_regionCut[*m_detIdItr] = cut;
+}
+
+/**
+ * Max step in the region of the sensor.
+ */
+void AllPixDetectorConstruction::SetRegionMaxStep(G4double step){
+	if(m_detId.empty()){
+		_BUILD_MEDIPIX_MSG();
+		exit(1);
+	}
+
+	m_regionMaxStep[*m_detIdItr] = step;
+}
+
+/**
+ * Parameterised sensor: off, continue or kill.
+ */
+void AllPixDetectorConstruction::SetFastSimulation(G4String mode){
+	if(m_detId.empty()){
+		_BUILD_MEDIPIX_MSG();
+		exit(1);
+	}
+
+	m_fastSimulation[*m_detIdItr] = mode;
+}
+
 /**
  * Postition of the test structure.
  * There could be many test structures,
@@ -490,10 +579,6 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 	// log an phys
 	G4cout << "Building " << nOfDevices << " device(s) ..." << G4endl;
 
-	// SD manager
-	G4SDManager * SDman = G4SDManager::GetSDMpointer();
-
-
 	// User limits applied only to Si wafers.  Setting step.
 	if ( !m_ulim ) m_ulim = new G4UserLimits(m_maxStepLengthSensor);
 
@@ -807,18 +892,105 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 
 		///////////////////////////////////////////////////////////
 		// bumps
+		//  parameterised : a G4PVParameterised bump per pixel
+		//  replica : columns and cells replicated over the pixel grid,
+		//   one bump placed in the cell.  The navigator finds the cell
+		//   from the position instead of searching the bumps.
+		//  slab : no bumps, the bump box is filled with a solder/air
+		//   mixture of the same mass
+
+		if(geoMap[*detItr]->GetHalfChipZ()!=0 && bump_height!=0){
+
+		G4String bumpModel = m_bumpModel.count(*detItr) > 0 ? m_bumpModel[*detItr] : G4String("parameterised");
+
+		G4int nPixX = geoMap[*detItr]->GetNPixelsX();
+		G4int nPixY = geoMap[*detItr]->GetNPixelsY();
+		G4double hPixX = geoMap[*detItr]->GetHalfPixelX();
+		G4double hPixY = geoMap[*detItr]->GetHalfPixelY();
+
+		if(bumpModel == "replica" && (nPixX*hPixX > geoMap[*detItr]->GetHalfSensorX()*(1. + 1e-9)
+				|| nPixY*hPixY > geoMap[*detItr]->GetHalfSensorY()*(1. + 1e-9))){
+			G4cout << "[WARNING] detector " << (*detItr) << " : the pixel grid doesn't fit in the sensor,"
+					<< " parameterised bumps instead of replica" << G4endl;
+			bumpModel = "parameterised";
+		}
 
-		if(geoMap[*detItr]->GetHalfChipZ()!=0){
-
-		m_Bumps_Cell_log[(*detItr)] = new G4LogicalVolume(aBump,Solder,BumpBoxName.second+"_log" );
-		m_Bumps_Cell_log[(*detItr)]->SetVisAttributes(BumpVisAtt);
+		if(bumpModel != "slab") {
+			m_Bumps_Cell_log[(*detItr)] = new G4LogicalVolume(aBump,Solder,BumpBoxName.second+"_log" );
+			m_Bumps_Cell_log[(*detItr)]->SetVisAttributes(BumpVisAtt);
+		}
 
 //		m_Bumps_Slice_log[(*detItr)] = new G4LogicalVolume(Bump_Slice_Box,m_Air,BumpSliceName.second+"_log");
 //		m_Bumps_Slice_log[(*detItr)]->SetVisAttributes(BumpSliceVisAtt);
 
+		if(bumpModel == "slab") {
+
+			// solder volume fraction of the bump box
+			G4double fraction = nPixX*nPixY*aBump->GetCubicVolume()/Bump_Box->GetCubicVolume();
+			if(fraction > 1.) fraction = 1.;
+			G4double density = fraction*Solder->GetDensity() + (1. - fraction)*m_Air->GetDensity();
+			G4double solderMass = fraction*Solder->GetDensity()/density;
+
+			// Materials are never deleted, the one of a previous update is
+			//  used again.  A different bump box needs another one.
+			G4String slabName = G4String("BumpSlab_") + temp;
+			G4Material * slab = G4Material::GetMaterial(slabName, false);
+			for(G4int k = 1 ; slab && slab->GetDensity() != density ; k++) {
+				char slabS[32];
+				sprintf(slabS, "_%d", k);
+				slabName = G4String("BumpSlab_") + temp + slabS;
+				slab = G4Material::GetMaterial(slabName, false);
+			}
+			if(!slab) {
+				slab = new G4Material(slabName, density, 2);
+				slab->AddMaterial(Solder, solderMass);
+				slab->AddMaterial(m_Air, 1. - solderMass);
+			}
+			m_Bumps_log[(*detItr)]->SetMaterial(slab);
+
+			G4cout << "Detector " << (*detItr) << " : bumps as a slab, " << fraction*100. << "% solder, "
+					<< density/(g/cm3) << " g/cm3" << G4endl;
+
+		} else if(bumpModel == "replica") {
+
+			// the grid starts at the sensor corner, as in the parameterisation
+			G4Box * grid_box = new G4Box(BumpName.first+"Grid", nPixX*hPixX, nPixY*hPixY, bump_height/2.);
+			G4Box * column_box = new G4Box(BumpName.first+"Column", hPixX, nPixY*hPixY, bump_height/2.);
+			G4Box * cell_box = new G4Box(BumpName.first+"Cell", hPixX, hPixY, bump_height/2.);
+
+			G4LogicalVolume * grid_log = new G4LogicalVolume(grid_box, m_Air, BumpName.second+"_grid_log");
+			G4LogicalVolume * column_log = new G4LogicalVolume(column_box, m_Air, BumpName.second+"_column_log");
+			G4LogicalVolume * cell_log = new G4LogicalVolume(cell_box, m_Air, BumpName.second+"_cell_log");
+			grid_log->SetVisAttributes(G4VisAttributes::Invisible);
+			column_log->SetVisAttributes(G4VisAttributes::Invisible);
+			cell_log->SetVisAttributes(G4VisAttributes::Invisible);
+
+			new G4PVPlacement(0,
+					G4ThreeVector(nPixX*hPixX - geoMap[*detItr]->GetHalfSensorX(),
+							nPixY*hPixY - geoMap[*detItr]->GetHalfSensorY(), 0),
+					grid_log,
+					BumpName.second+"_grid_phys",
+					m_Bumps_log[(*detItr)], // mother log
+					false,
+					0,
+					true); // check overlap
+			new G4PVReplica(BumpName.second+"_column_phys", column_log, grid_log, kXAxis, nPixX, 2*hPixX);
+			new G4PVReplica(BumpName.second+"_cell_phys", cell_log, column_log, kYAxis, nPixY, 2*hPixY);
+			new G4PVPlacement(0,
+					G4ThreeVector(geoMap[*detItr]->GetBumpOffsetX(), geoMap[*detItr]->GetBumpOffsetY(), 0),
+					m_Bumps_Cell_log[(*detItr)],
+					BumpName.second+"phys",
+					cell_log, // mother log
+					false,
+					0,
+					true); // check overlap
+
+			G4cout << "Detector " << (*detItr) << " : bumps on a replicated " << nPixX << "x" << nPixY << " grid" << G4endl;
+
+		} else {
 
 		parameterization = new Allpix_BumpsParameterization(geoMap[*detItr]);
-		G4int NPixTot = geoMap[*detItr]->GetNPixelsX()*geoMap[*detItr]->GetNPixelsY();
+		G4int NPixTot = nPixX*nPixY;
 		new G4PVParameterised(BumpName.second+"phys",
 							m_Bumps_Cell_log[(*detItr)],     // logical volume
 							m_Bumps_log[(*detItr)],             // mother volume
@@ -827,9 +999,26 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 							parameterization);         // G4VPVParameterisation
 		}
 
+		}
+
 
 		///////////////////////////////////////////////////////////
 		// slices and pixels
+		// With a single sensitive box the Si wafer itself is the sensitive
+		//  volume and AllPixTrackerSD computes the pixel indexes from the
+		//  local position.  Saves the navigator a boundary per pixel.
+		if ( m_singleSensitiveBox.count(*detItr) > 0 && m_singleSensitiveBox[*detItr] ) {
+
+			G4cout << "Detector " << (*detItr) << " : single sensitive box, "
+					<< geoMap[*detItr]->GetNPixelsX() << "x" << geoMap[*detItr]->GetNPixelsY()
+					<< " pixels indexed analytically" << G4endl;
+
+			m_Slice_log[(*detItr)] = 0x0;
+			m_Pixel_log[(*detItr)] = m_Box_log[(*detItr)];
+			if ( m_ulim && m_regionMaxStep.count(*detItr) == 0 ) m_Pixel_log[(*detItr)]->SetUserLimits(m_ulim);
+
+		} else {
+
 		m_Slice_log[(*detItr)] = new G4LogicalVolume(Box_slice,
 				Silicon,
 				SliceName.second); // 0,0,0);
@@ -838,7 +1027,7 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 				Silicon,
 				PixelName.second); // 0,0,0);
 
-		if ( m_ulim ) m_Pixel_log[(*detItr)]->SetUserLimits(m_ulim);
+		if ( m_ulim && m_regionMaxStep.count(*detItr) == 0 ) m_Pixel_log[(*detItr)]->SetUserLimits(m_ulim);
 
 		// divide in slices
 		new G4PVDivision(
@@ -859,6 +1048,39 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 				geoMap[*detItr]->GetNPixelsY(),
 				0); // offset
 
+		}
+
+		///////////////////////////////////////////////////////////
+		// Region of the sensor, pixels included.  Its own production
+		//  cuts and max step if requested, the global cuts otherwise.
+		//  The logical volume limits (pixels) win over the region's,
+		//  hence no m_ulim above when the region has a max step.
+		G4Region * sensorRegion = new G4Region(G4String("Sensor_") + temp);
+		sensorRegion->AddRootLogicalVolume(m_Box_log[(*detItr)]);
+		//  The cuts and limits are kept per detector and reused by the
+		//  regions of the following updates.
+		if(m_regionCut.count(*detItr) > 0) {
+			if(m_regionCuts.count(*detItr) == 0) m_regionCuts[*detItr] = new G4ProductionCuts;
+			m_regionCuts[*detItr]->SetProductionCut(m_regionCut[*detItr]);
+			sensorRegion->SetProductionCuts(m_regionCuts[*detItr]);
+		} else {
+			sensorRegion->SetProductionCuts(G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts());
+		}
+		if(m_regionMaxStep.count(*detItr) > 0) {
+			if(m_regionLimits.count(*detItr) == 0) m_regionLimits[*detItr] = new G4UserLimits;
+			m_regionLimits[*detItr]->SetMaxAllowedStep(m_regionMaxStep[*detItr]);
+			sensorRegion->SetUserLimits(m_regionLimits[*detItr]);
+		}
+		m_sensorRegion[(*detItr)] = sensorRegion;
+
+		G4cout << "Region " << sensorRegion->GetName() << " : ";
+		if(m_regionCut.count(*detItr) > 0) G4cout << "cut " << m_regionCut[*detItr]/um << " um";
+		else G4cout << "global cuts";
+		if(m_regionMaxStep.count(*detItr) > 0) G4cout << ", max step " << m_regionMaxStep[*detItr]/um << " um";
+		if(m_fastSimulation.count(*detItr) > 0 && m_fastSimulation[*detItr] != "off")
+			G4cout << ", fast simulation (" << m_fastSimulation[*detItr] << ")";
+		G4cout << G4endl;
+
 		///////////////////////////////////////////////////////////
 		// Guard rings and excess area
 		m_GuardRings_log[(*detItr)] = new G4LogicalVolume(Solid_GuardRings,
@@ -882,23 +1104,15 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 		//G4cout << posWrapper << " " << posDevice << endl;
 
 		// SD --> pixels !
-		// AllPixTrackerSD instance needs to know the absolute position of
-		//  the device and rotation.  'm_absolutePosSiWafer' and 'rot' are
-		//  the good figures.
+		// The AllPixTrackerSD instances are built in ConstructSDandField
+		//  (once per thread in MT mode).  They need to know the absolute
+		//  position of the device and rotation.
+		m_absolutePosSD[(*detItr)] = posWrapper + posDevice;
+		m_relativePosSD[(*detItr)] = posDevice;
 
-		G4ThreeVector origin(0,0,0);
-
-		AllPixTrackerSD * aTrackerSD = new AllPixTrackerSD( SDName.second,
-				(posWrapper + posDevice),
-				posDevice,
-				geoMap[*detItr],
-				m_rotVector[(*detItr)] );
-
-		SDman->AddNewDetector( aTrackerSD );
-		m_Pixel_log[(*detItr)]->SetSensitiveDetector( aTrackerSD );
-
-		// Store the hit Collection name in the geometry
-		geoMap[*detItr]->SetHitsCollectionName( aTrackerSD->GetHitsCollectionName() );
+		// Store the hit Collection name in the geometry.
+		// AllPixTrackerSD builds it as SDName + "_HitsCollection"
+		geoMap[*detItr]->SetHitsCollectionName( SDName.second + "_HitsCollection" );
 
 
 		// Read electric field from file if necessary
@@ -915,6 +1129,8 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 		
 		geoMap[*detItr]->SetMagField(m_magField_cartesian);
 
+		geoMap[*detItr]->SetDriftTable( m_driftTable.count(*detItr) > 0 && m_driftTable[*detItr] );
+
 
 
 		G4cout << "          detector " << (*detItr) << " ... done" << G4endl;
@@ -931,6 +1147,108 @@ void AllPixDetectorConstruction::BuildPixelDevices(map<int, AllPixGeoDsc *> geoM
 #include "G4RunManager.hh"
 #include "G4UserEventAction.hh"
 #include "AllPixEventAction.hh"
+#include "G4FieldManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4QuadrupoleMagField.hh"
+#include "G4UniformMagField.hh"
+#include "MorourgoMagField.hh"
+#include "G4PropagatorInField.hh"
+
+/**
+ *  Sensitive detectors and digitizers.  Called by UpdateGeometry in the
+ *  master (or only) thread, and by Geant4 in every worker thread in MT
+ *  mode, where SDs, hit collections and digitizers are thread local.
+ *  Geant4 calls it as well in the master when the geometry is
+ *  reinitialized, nothing is done twice for the same update.
+ */
+void AllPixDetectorConstruction::ConstructSDandField()
+{
+
+	// only the world at this point, see Construct()
+	if(!m_clearanceToBuildGeometry) return;
+
+	// once per geometry update and per thread.  The workers come here
+	//  at their first run after the update, see UpdateGeometry().
+	static G4ThreadLocal G4int sdGeneration = -1;
+	if(sdGeneration == m_geometryGeneration) return;
+	sdGeneration = m_geometryGeneration;
+
+	// Fast simulation models of the previous update in this thread,
+	//  with the manager they registered to (the region may be gone
+	//  already, see Construct()).  Removed from it and deleted.
+	static G4ThreadLocal vector<pair<G4FastSimulationManager *, AllPixFastPlaneModel *> > * fastModels = 0x0;
+	if(!fastModels) fastModels = new vector<pair<G4FastSimulationManager *, AllPixFastPlaneModel *> >;
+	for(size_t i = 0 ; i < fastModels->size() ; i++) {
+		(*fastModels)[i].first->RemoveFastSimulationModel( (*fastModels)[i].second );
+		delete (*fastModels)[i].second;
+	}
+	fastModels->clear();
+
+	// Magnetic field, see SetPeakMagField.  The transportation manager,
+	//  its field manager and propagator are thread local, each thread
+	//  gets its own field and chord finder.
+	static G4ThreadLocal G4UniformMagField * magField = 0x0;
+	G4TransportationManager * tmanager = G4TransportationManager::GetTransportationManager();
+	G4FieldManager * fieldMgr = tmanager->GetFieldManager();
+	tmanager->GetPropagatorInField()->SetLargestAcceptableStep(1*mm);
+
+	G4UniformMagField * newField = 0x0;
+	if ( m_magField_cartesian.mag2() > 0. ) {
+		newField = new G4UniformMagField( m_magField_cartesian*tesla );
+		fieldMgr->SetMinimumEpsilonStep( 1e-7 );
+		fieldMgr->SetMaximumEpsilonStep( 1e-6 );
+		fieldMgr->SetDeltaOneStep( 0.05e-3 * mm );  // 0.5 micrometer
+	}
+	// the chord finder of the previous field is deleted by the manager
+	fieldMgr->SetDetectorField( newField );
+	fieldMgr->CreateChordFinder( newField );
+	if ( magField ) delete magField;
+	magField = newField;
+
+	// SD manager
+	G4SDManager * SDman = G4SDManager::GetSDMpointer();
+
+	map<int, AllPixGeoDsc *> * geoMap = m_geoDsc->GetDetectorsMap();
+
+	vector<int>::iterator detItr = m_detId.begin();
+	for( ; detItr != m_detId.end() ; detItr++)
+	{
+
+		char temp[128];
+		sprintf(temp, "%d", (*detItr));
+		G4String SDName = G4String("BoxSD") + "_" + temp; // BoxSD_XXX
+
+		AllPixTrackerSD * aTrackerSD = new AllPixTrackerSD( SDName,
+				m_absolutePosSD[(*detItr)],
+				m_relativePosSD[(*detItr)],
+				(*geoMap)[*detItr],
+				m_rotVector[(*detItr)] );
+
+		if ( m_singleSensitiveBox.count(*detItr) > 0 )
+			aTrackerSD->SetAnalyticPixelIndexing( m_singleSensitiveBox[*detItr] );
+
+		SDman->AddNewDetector( aTrackerSD );
+		SetSensitiveDetector( m_Pixel_log[(*detItr)], aTrackerSD );
+
+		// Parameterised sensor.  The model registers itself to the
+		//  region, thread local like the SD.  Kept until the next update.
+		if ( m_fastSimulation.count(*detItr) > 0 && m_fastSimulation[*detItr] != "off" ) {
+			AllPixFastPlaneModel * model = new AllPixFastPlaneModel( G4String("FastPlane_") + temp,
+					m_sensorRegion[(*detItr)],
+					aTrackerSD,
+					(*geoMap)[*detItr],
+					m_fastSimulation[*detItr] == "kill" );
+			fastModels->push_back( make_pair(m_sensorRegion[(*detItr)]->GetFastSimulationManager(), model) );
+		}
+
+	}
+
+	// setup digitizers for new detectors.  There is no event action
+	//  in the master thread in MT mode.
+	AllPixEventAction * ea = (AllPixEventAction *) G4RunManager::GetRunManager()->GetUserEventAction();
+	if(ea) ea->SetupDigitizers();
+
+}
 
 void AllPixDetectorConstruction::UpdateGeometry()
 {
@@ -941,11 +1259,21 @@ void AllPixDetectorConstruction::UpdateGeometry()
 	m_clearanceToBuildGeometry = true;
 
 	// build extra medipixes
+	m_geometryBuilt = false;
 	G4RunManager::GetRunManager()->DefineWorldVolume(Construct());
-
-	// setup digitizers for new detectors
-	AllPixEventAction * ea = (AllPixEventAction *) G4RunManager::GetRunManager()->GetUserEventAction();
-	ea->SetupDigitizers();
+	m_geometryBuilt = true;
+	m_geometryGeneration++;
+
+	// DefineWorldVolume doesn't build the SDs
+	ConstructSDandField();
+
+#ifdef ALLPIX_MT
+	// The workers were started by /run/initialize, before the update,
+	//  and built nothing.  Reinitializing the geometry (propagated to the
+	//  workers) makes them take the new world and call
+	//  ConstructSDandField at the next /run/beamOn.
+	G4RunManager::GetRunManager()->ReinitializeGeometry();
+#endif
 
 	// setup all thl // FIXME
 	/*
@@ -977,62 +1305,12 @@ void AllPixDetectorConstruction::SetMaxStepLengthSensor(G4double val) {
 
 }
 
-#include "G4FieldManager.hh"
-#include "G4TransportationManager.hh"
-#include "G4QuadrupoleMagField.hh"
-#include "G4UniformMagField.hh"
-#include "MorourgoMagField.hh"
-#include "G4PropagatorInField.hh"
 void AllPixDetectorConstruction::SetPeakMagField(G4ThreeVector fieldValues)
 {
-	//apply a global uniform magnetic field along Z axis
-	G4FieldManager * fieldMgr
-	= G4TransportationManager::GetTransportationManager()->GetFieldManager();
-	G4TransportationManager* tmanager = G4TransportationManager::GetTransportationManager();
-	tmanager->GetPropagatorInField()->SetLargestAcceptableStep(1*mm);
-	
+	// Global uniform magnetic field.  Only stored here, the field
+	//  managers are thread local: the field is built in every thread
+	//  by ConstructSDandField at the next /allpix/det/update.
 	m_magField_cartesian = fieldValues/tesla;
-	
-	if ( fieldValues[0] != 0. || fieldValues[1] != 0. || fieldValues[2] != 0. )
-	{
-
-		// FIXME !!! --> feed this value from the macro
-		//		m_magField = new MorourgoMagField(fieldValue, 252.5*mm);
-		//		fieldMgr->SetDetectorField(m_magField);
-		//		fieldMgr->CreateChordFinder(m_magField);
-		m_magField = new G4UniformMagField (fieldValues.getR(), fieldValues.getTheta(), fieldValues.getPhi());
-		fieldMgr->SetDetectorField(m_magField);
-		fieldMgr->CreateChordFinder(m_magField);
-
-		fieldMgr->SetMinimumEpsilonStep( 1e-7 );
-		fieldMgr->SetMaximumEpsilonStep( 1e-6 );
-		fieldMgr->SetDeltaOneStep( 0.05e-3 * mm );  // 0.5 micrometer
-		
-
-	} else {
-		m_magField = 0x0;
-		//fieldMgr->SetDetectorField(m_magField);
-	}
-
-
-	//if(m_magField) {
-
-	// test at center of telescope (same point that center of magnet)
-	//		G4double xyz[4] = { 1.*mm, 1.*mm, 0.*mm, 0.*mm };
-	//		G4double fieldVal[3] = { 0, 0, 0 };
-	//
-	//		m_magField->GetFieldValue(xyz, fieldVal);
-	//		std::cout << "y field (z=" << xyz[2]/mm << ") = " << fieldVal[1] << std::endl;
-	//
-	//		xyz[2] = 252.5*mm;
-	//		m_magField->GetFieldValue(xyz, fieldVal);
-	//		std::cout << "y field (z=" << xyz[2]/mm << ") = " << fieldVal[1] << std::endl;
-	//
-	//		xyz[2] = -3000*mm;
-	//		m_magField->GetFieldValue(xyz, fieldVal);
-	//		std::cout << "y field (z=" << xyz[2]/mm << ") = " << fieldVal[1] << std::endl;
-
-	//}
 
 }
 
@@ -41,6 +41,16 @@
 #include "G4UIcmdWith3VectorAndUnit.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+
+#include "AllPix_Hits_WriteToEntuple.h"
+#include "AllPixOutputQueue.hh"
+#include "AllPixOutputSettings.hh"
+#include "AllPixLCIOBridge.hh"
+
+#include <sstream>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -92,6 +102,7 @@ AllPixDetectorMessenger::AllPixDetectorMessenger(
 
 	m_detEFieldFileCmd = new G4UIcmdWithAString("/allpix/det/setEFieldFile", this);
 	m_detEFieldFileCmd->SetGuidance("Name file for input of electric field map");
+	m_detEFieldFileCmd->SetGuidance("Text map, or binary map from allpix-efield-convert (mmap'ed, shared by the detectors using it)");
 	m_detEFieldFileCmd->SetParameterName("EFieldFile", true);
 	m_detEFieldFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
@@ -101,6 +112,8 @@ AllPixDetectorMessenger::AllPixDetectorMessenger(
 	m_UpdateCmd->SetGuidance("This command MUST be applied before \"beamOn\" ");
 	m_UpdateCmd->SetGuidance("if you changed geometrical value(s).");
 	m_UpdateCmd->AvailableForStates(G4State_Idle);
+	// geometry is built by the master only
+	m_UpdateCmd->SetToBeBroadcasted(false);
 	///////////
 
 	m_HighTHLCmd = new G4UIcmdWithADoubleAndUnit("/allpix/det/setHighTHL",this);
@@ -137,6 +150,55 @@ AllPixDetectorMessenger::AllPixDetectorMessenger(
 	m_FluxCmd->SetParameterName("flux", true, false);
 	m_FluxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+	m_singleSensitiveBoxCmd = new G4UIcmdWithABool("/allpix/det/setSingleSensitiveBox",this);
+	m_singleSensitiveBoxCmd->SetGuidance("Build the sensor as a single sensitive box (no pixel volumes).");
+	m_singleSensitiveBoxCmd->SetGuidance("Pixel indexes are computed from the local position of the hit.");
+	m_singleSensitiveBoxCmd->SetParameterName("singleSensitiveBox", true);
+	m_singleSensitiveBoxCmd->SetDefaultValue(true);
+	m_singleSensitiveBoxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_driftTableCmd = new G4UIcmdWithABool("/allpix/det/setDriftTable",this);
+	m_driftTableCmd->SetGuidance("Tabulate the drift (time, displacement) in the starting depth at digitizer construction");
+	m_driftTableCmd->SetGuidance("and interpolate per hit, instead of one full integration per hit.  1D field only");
+	m_driftTableCmd->SetGuidance("(Timepix, Timepix3, FEI3Standard).  false = full integration.");
+	m_driftTableCmd->SetParameterName("driftTable", true);
+	m_driftTableCmd->SetDefaultValue(true);
+	m_driftTableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_bumpModelCmd = new G4UIcmdWithAString("/allpix/det/setBumpModel",this);
+	m_bumpModelCmd->SetGuidance("Bump bonds of this detector.  parameterised = one volume per pixel (default),");
+	m_bumpModelCmd->SetGuidance("replica = the same bumps on a replicated grid of cells (cheaper navigation),");
+	m_bumpModelCmd->SetGuidance("slab = the bump layer as a homogeneous solder/air mixture of the same mass.");
+	m_bumpModelCmd->SetParameterName("bumpModel", false);
+	m_bumpModelCmd->SetCandidates("parameterised replica slab");
+	m_bumpModelCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_regionCutCmd = new G4UIcmdWithADoubleAndUnit("/allpix/det/setRegionCut",this);
+	m_regionCutCmd->SetGuidance("Production cut (gamma, e-, e+, proton) in the region of this sensor (Sensor_<id>).");
+	m_regionCutCmd->SetGuidance("The rest of the geometry keeps the global cuts (/run/setCut, /allpix/phys/Cut*),");
+	m_regionCutCmd->SetGuidance("which can then be coarse.  Default: the global cuts.");
+	m_regionCutCmd->SetParameterName("regionCut", false, false);
+	m_regionCutCmd->SetUnitCategory("Length");
+	m_regionCutCmd->SetRange("regionCut>0.0");
+	m_regionCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_regionMaxStepCmd = new G4UIcmdWithADoubleAndUnit("/allpix/det/setRegionMaxStep",this);
+	m_regionMaxStepCmd->SetGuidance("Max step length in the region of this sensor (Sensor_<id>), in place of");
+	m_regionMaxStepCmd->SetGuidance("/allpix/det/setMaxStepLengthSensor for this detector.");
+	m_regionMaxStepCmd->SetParameterName("regionMaxStep", false, false);
+	m_regionMaxStepCmd->SetUnitCategory("Length");
+	m_regionMaxStepCmd->SetRange("regionMaxStep>0.0");
+	m_regionMaxStepCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_fastSimulationCmd = new G4UIcmdWithAString("/allpix/det/setFastSimulation",this);
+	m_fastSimulationCmd->SetGuidance("Parameterised sensor, for the reference planes of a telescope.  The primaries");
+	m_fastSimulationCmd->SetGuidance("cross it in a straight line, Landau energy loss shared by pixel, Highland");
+	m_fastSimulationCmd->SetGuidance("scattering at the exit.  continue = the primary goes on, kill = it stops there,");
+	m_fastSimulationCmd->SetGuidance("off = full simulation (default).");
+	m_fastSimulationCmd->SetParameterName("fastSimulation", false);
+	m_fastSimulationCmd->SetCandidates("off continue kill");
+	m_fastSimulationCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
 	m_ClockCmd = new G4UIcmdWithADoubleAndUnit("/allpix/det/setClock",this);
 	m_ClockCmd->SetGuidance("The clock.");
 	m_ClockCmd->SetParameterName("Clock", false, false);
@@ -158,6 +220,75 @@ AllPixDetectorMessenger::AllPixDetectorMessenger(
 	m_outputPrefix->SetDefaultValue("allpixoutput");
 	m_outputPrefix->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+	m_hitsFormatCmd = new G4UIcmdWithAString("/allpix/config/setHitsFormat", this);
+	m_hitsFormatCmd->SetGuidance("Format of the hits files.  object = one SimpleHits branch (default).");
+	m_hitsFormatCmd->SetGuidance("columns = flat split branches (float x/y/z/edep, int pdgId/trackId/parentId,");
+	m_hitsFormatCmd->SetGuidance("uint16 process/trackVolume/parentVolume codes) and an AllPixHitsCodes tree");
+	m_hitsFormatCmd->SetGuidance("with the names of the codes.  Set it before the first event.");
+	m_hitsFormatCmd->SetParameterName("HitsFormat", false);
+	m_hitsFormatCmd->SetCandidates("object columns");
+	m_hitsFormatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_hitsColumnsCmd = new G4UIcmdWithAString("/allpix/config/setHitsColumns", this);
+	m_hitsColumnsCmd->SetGuidance("Per hit columns written to the hits files, any of");
+	m_hitsColumnsCmd->SetGuidance("x y z pos edep pdgId trackId parentId process trackVolume parentVolume,");
+	m_hitsColumnsCmd->SetGuidance("or all (default).  Example: /allpix/config/setHitsColumns \"pos edep pdgId\"");
+	m_hitsColumnsCmd->SetParameterName("HitsColumns", false);
+	m_hitsColumnsCmd->SetDefaultValue("all");
+	m_hitsColumnsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_asyncOutputCmd = new G4UIcmdWithAnInteger("/allpix/config/setAsyncOutput", this);
+	m_asyncOutputCmd->SetGuidance("Write the hits, frames and RD53 ROOT files from a writer thread, fed through");
+	m_asyncOutputCmd->SetGuidance("a queue of the given depth (records).  The simulation waits when the queue");
+	m_asyncOutputCmd->SetGuidance("is full.  0 = write synchronously at the end of each event/run (default).");
+	m_asyncOutputCmd->SetParameterName("QueueDepth", false);
+	m_asyncOutputCmd->SetRange("QueueDepth>=0");
+	m_asyncOutputCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	// output trees (frames, hits, RD53), set before the files are opened
+	m_compressionCmd = new G4UIcommand("/allpix/config/setCompression", this);
+	m_compressionCmd->SetGuidance("Compression of the output files: <algorithm> [level].");
+	m_compressionCmd->SetGuidance("algorithm: default zlib lzma lz4 zstd.  level 0-9, 0 = uncompressed,");
+	m_compressionCmd->SetGuidance("omitted = the algorithm's default (zlib 1, lzma 7, lz4 4, zstd 5).");
+	m_compressionCmd->SetGuidance("e.g. lz4 for fast scratch output, zstd or lzma for archival.");
+	G4UIparameter * algorithm = new G4UIparameter("algorithm", 's', false);
+	algorithm->SetParameterCandidates("default zlib lzma lz4 zstd");
+	m_compressionCmd->SetParameter(algorithm);
+	G4UIparameter * level = new G4UIparameter("level", 'i', true);
+	level->SetDefaultValue(-1);
+	level->SetParameterRange("level <= 9");
+	m_compressionCmd->SetParameter(level);
+	m_compressionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_basketSizeCmd = new G4UIcmdWithAnInteger("/allpix/config/setBasketSize", this);
+	m_basketSizeCmd->SetGuidance("Branch buffer (basket) size in bytes of every output tree.");
+	m_basketSizeCmd->SetGuidance("0 = the writers' defaults.");
+	m_basketSizeCmd->SetParameterName("BasketSize", false);
+	m_basketSizeCmd->SetRange("BasketSize>=0");
+	m_basketSizeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_autoFlushCmd = new G4UIcmdWithAnInteger("/allpix/config/setAutoFlush", this);
+	m_autoFlushCmd->SetGuidance("TTree::SetAutoFlush of every output tree: > 0 flush every N entries,");
+	m_autoFlushCmd->SetGuidance("< 0 flush every -N bytes, 0 = ROOT default.");
+	m_autoFlushCmd->SetParameterName("AutoFlush", false);
+	m_autoFlushCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_lcioBridgeFormatCmd = new G4UIcmdWithAString("/allpix/config/setLCIOBridgeFormat", this);
+	m_lcioBridgeFormatCmd->SetGuidance("Format of the lciobridge_allpix(_dut) files.  text = .txt (default),");
+	m_lcioBridgeFormatCmd->SetGuidance("binary = .bin length-prefixed records (AllPixLCIOBridge.hh, read back with");
+	m_lcioBridgeFormatCmd->SetGuidance("AllPixLCIOBridgeReader or allpix-lciobridge-dump), both, or none.");
+	m_lcioBridgeFormatCmd->SetGuidance("Set it before the first event.");
+	m_lcioBridgeFormatCmd->SetParameterName("LCIOBridgeFormat", false);
+	m_lcioBridgeFormatCmd->SetCandidates("text binary both none");
+	m_lcioBridgeFormatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+	m_geoCacheDirCmd = new G4UIcmdWithAString("/allpix/config/setGeoCacheDir", this);
+	m_geoCacheDirCmd->SetGuidance("Directory of the binary cache of the parsed models/pixeldetector.xml.");
+	m_geoCacheDirCmd->SetGuidance("A cache file per xml content, written when missing, read instead of the xml");
+	m_geoCacheDirCmd->SetGuidance("otherwise.  Set it before /allpix/det/update.  No cache by default.");
+	m_geoCacheDirCmd->SetParameterName("GeoCacheDir", false);
+	m_geoCacheDirCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
 	//////////////////////////
 	// extras
 
@@ -215,6 +346,7 @@ AllPixDetectorMessenger::AllPixDetectorMessenger(
 	m_magFieldCmd = new G4UIcmdWith3VectorAndUnit("/allpix/extras/setPeakField",this);
 	m_magFieldCmd->SetGuidance("Define magnetic field peak value.");
 	m_magFieldCmd->SetGuidance("Magnetic field will be in Z direction.");
+	m_magFieldCmd->SetGuidance("Applied at the next /allpix/det/update.");
 	m_magFieldCmd->SetParameterName("Bx", "By", "Bz", false, true);
 	m_magFieldCmd->SetDefaultValue(G4ThreeVector(0.,0.,0.));
 	m_magFieldCmd->SetUnitCategory("Magnetic flux density");
@@ -241,9 +373,23 @@ AllPixDetectorMessenger::~AllPixDetectorMessenger()
 	delete m_testStructRotCmd;
 	delete m_detAppliancePosCmd;
 	delete m_UpdateCmd;
+	delete m_singleSensitiveBoxCmd;
+	delete m_driftTableCmd;
+	delete m_bumpModelCmd;
+	delete m_regionCutCmd;
+	delete m_fastSimulationCmd;
+	delete m_regionMaxStepCmd;
 	delete m_worldMaterial;
 
 	delete m_outputPrefix;
+	delete m_hitsFormatCmd;
+	delete m_hitsColumnsCmd;
+	delete m_asyncOutputCmd;
+	delete m_compressionCmd;
+	delete m_basketSizeCmd;
+	delete m_autoFlushCmd;
+	delete m_lcioBridgeFormatCmd;
+	delete m_geoCacheDirCmd;
 
 	delete m_detDir;
 	delete m_allpixDir;
@@ -315,6 +461,38 @@ void AllPixDetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValu
 				m_FluxCmd->GetNewDoubleValue(newValue)
 		);
 	}
+	if( command == m_singleSensitiveBoxCmd )
+	{
+		m_AllPixDetector->SetSingleSensitiveBox(
+				m_singleSensitiveBoxCmd->GetNewBoolValue(newValue)
+		);
+	}
+	if( command == m_driftTableCmd )
+	{
+		m_AllPixDetector->SetDriftTable(
+				m_driftTableCmd->GetNewBoolValue(newValue)
+		);
+	}
+	if( command == m_bumpModelCmd )
+	{
+		m_AllPixDetector->SetBumpModel( newValue );
+	}
+	if( command == m_regionCutCmd )
+	{
+		m_AllPixDetector->SetRegionCut(
+				m_regionCutCmd->GetNewDoubleValue(newValue)
+		);
+	}
+	if( command == m_regionMaxStepCmd )
+	{
+		m_AllPixDetector->SetRegionMaxStep(
+				m_regionMaxStepCmd->GetNewDoubleValue(newValue)
+		);
+	}
+	if( command == m_fastSimulationCmd )
+	{
+		m_AllPixDetector->SetFastSimulation( newValue );
+	}
 	
 
 	if( command == m_testStructPosCmd )
@@ -390,6 +568,55 @@ void AllPixDetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValu
 	    m_AllPixDetector->SetOutputFilePrefix( newValue );
 	  }
 
+	if( command == m_hitsFormatCmd )
+	  {
+	    G4cout << "Setting up hits format " << newValue << G4endl;
+	    Hits_WriteToNtuple::SetFormat( newValue.data() );
+	  }
+
+	if( command == m_lcioBridgeFormatCmd )
+	  {
+	    G4cout << "Setting up lcio bridge format " << newValue << G4endl;
+	    AllPixLCIOBridgeWriter::SetFormat( newValue.data() );
+	  }
+
+	if( command == m_geoCacheDirCmd )
+	  {
+	    G4cout << "Setting up geometry cache directory " << newValue << G4endl;
+	    ReadGeoDescription::SetCacheDir( newValue.data() );
+	  }
+
+	if( command == m_compressionCmd )
+	  {
+	    G4String algorithm;
+	    G4int level = -1;
+	    std::istringstream is((const char *)newValue);
+	    is >> algorithm >> level;
+	    G4cout << "Setting up output compression " << newValue << G4endl;
+	    if( !AllPixOutputSettings::GetInstance()->SetCompression( algorithm.data(), level ) ) exit(1);
+	  }
+
+	if( command == m_basketSizeCmd )
+	  {
+	    AllPixOutputSettings::GetInstance()->SetBasketSize( m_basketSizeCmd->GetNewIntValue(newValue) );
+	  }
+
+	if( command == m_autoFlushCmd )
+	  {
+	    AllPixOutputSettings::GetInstance()->SetAutoFlush( m_autoFlushCmd->GetNewIntValue(newValue) );
+	  }
+
+	if( command == m_asyncOutputCmd )
+	  {
+	    AllPixOutputQueue::GetInstance()->Start( m_asyncOutputCmd->GetNewIntValue(newValue) );
+	  }
+
+	if( command == m_hitsColumnsCmd )
+	  {
+	    G4cout << "Setting up hits columns " << newValue << G4endl;
+	    if( !Hits_WriteToNtuple::SetColumns( newValue.data() ) ) exit(1);
+	  }
+
 	if( command == m_StepLengthSensor) {
 		G4cout << "Setting up Max Step Length" << newValue << G4endl;
 		m_AllPixDetector->SetMaxStepLengthSensor(
@@ -0,0 +1,245 @@
+#include "AllPixEFieldMap.hh"
+
+#include "G4AutoLock.hh"
+
+#include <map>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+	G4Mutex efieldMapMutex = G4MUTEX_INITIALIZER;
+
+	// file name --> map, shared by all the detectors naming the file
+	struct SharedMaps {
+		~SharedMaps() {
+			map<G4String, AllPixEFieldMap *>::iterator itr = maps.begin();
+			for ( ; itr != maps.end() ; itr++ ) delete (*itr).second;
+		}
+		map<G4String, AllPixEFieldMap *> maps;
+	};
+	SharedMaps sharedMaps;
+}
+
+AllPixEFieldMap::AllPixEFieldMap()
+: m_nx(0), m_ny(0), m_nz(0), m_fieldUnit(""), m_data(0x0), m_mapBase(0x0), m_mapSize(0) {
+
+	m_pitch[0] = m_pitch[1] = m_pitch[2] = 0.;
+
+}
+
+AllPixEFieldMap::~AllPixEFieldMap(){
+
+	Unmap();
+
+}
+
+void AllPixEFieldMap::Unmap(){
+
+	if ( m_mapBase ) munmap(m_mapBase, m_mapSize);
+	m_mapBase = 0x0;
+	m_mapSize = 0;
+
+}
+
+AllPixEFieldMap * AllPixEFieldMap::GetShared(const G4String & file){
+
+	G4AutoLock l(&efieldMapMutex);
+
+	map<G4String, AllPixEFieldMap *>::iterator itr = sharedMaps.maps.find(file);
+	if ( itr != sharedMaps.maps.end() ) return (*itr).second;
+
+	AllPixEFieldMap * efmap = new AllPixEFieldMap;
+	G4bool ok = IsBinary(file) ? efmap->LoadBinary(file) : efmap->LoadText(file);
+	if ( !ok ) {
+		delete efmap;
+		return 0x0;
+	}
+
+	sharedMaps.maps[file] = efmap;
+	return efmap;
+}
+
+void AllPixEFieldMap::Init(G4int nx, G4int ny, G4int nz){
+
+	Unmap();
+	m_nx = nx;
+	m_ny = ny;
+	m_nz = nz;
+	m_field.assign( (size_t)3 * nx * ny * nz, 0.f );
+	m_data = &m_field[0];
+
+}
+
+G4bool AllPixEFieldMap::IsBinary(const G4String & file){
+
+	FILE * f = fopen(file.c_str(), "rb");
+	if ( !f ) return false;
+
+	char magic[8];
+	size_t n = fread(magic, 1, sizeof(magic), f);
+	fclose(f);
+
+	return n == sizeof(magic) && strncmp(magic, ALLPIX_EFIELDMAP_MAGIC, sizeof(magic)) == 0;
+}
+
+G4bool AllPixEFieldMap::LoadText(const G4String & file){
+
+	ifstream efieldinput(file);
+	if ( !efieldinput.good() ) return false;
+
+	// whole file in memory, strtod is a lot faster than operator>>
+	string buffer( (istreambuf_iterator<char>(efieldinput)), istreambuf_iterator<char>() );
+	efieldinput.close();
+
+	const char * p = buffer.c_str();
+	char * end = 0x0;
+
+	G4int npts[3];
+	for ( G4int a = 0 ; a < 3 ; a++ ) {
+		npts[a] = (G4int)strtol(p, &end, 10);
+		if ( end == p || npts[a] <= 0 ) {
+			G4cout << "[AllPixEFieldMap] bad header in " << file << G4endl;
+			return false;
+		}
+		p = end;
+	}
+
+	Init(npts[0], npts[1], npts[2]);
+
+	G4double val[6];
+	for ( G4int k = 0 ; k < m_nz ; k++ ) {
+		for ( G4int j = 0 ; j < m_ny ; j++ ) {
+			for ( G4int i = 0 ; i < m_nx ; i++ ) {
+				// i j k ex ey ez
+				for ( G4int v = 0 ; v < 6 ; v++ ) {
+					val[v] = strtod(p, &end);
+					if ( end == p ) {
+						G4cout << "[AllPixEFieldMap] " << file << " ends before node ("
+								<< i << "," << j << "," << k << ")" << G4endl;
+						return false;
+					}
+					p = end;
+				}
+				Set(i, j, k, val[3], val[4], val[5]);
+			}
+		}
+	}
+
+	// TCAD exports
+	m_fieldUnit = "V/cm";
+
+	return true;
+}
+
+G4bool AllPixEFieldMap::LoadBinary(const G4String & file){
+
+	int fd = open(file.c_str(), O_RDONLY);
+	if ( fd < 0 ) return false;
+
+	struct stat st;
+	if ( fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AllPixEFieldMapHeader) ) {
+		close(fd);
+		return false;
+	}
+
+	void * base = mmap(0x0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if ( base == MAP_FAILED ) return false;
+
+	const AllPixEFieldMapHeader * h = (const AllPixEFieldMapHeader *) base;
+	size_t expected = sizeof(AllPixEFieldMapHeader) + (size_t)3 * h->nx * h->ny * h->nz * sizeof(float);
+
+	if ( h->version != ALLPIX_EFIELDMAP_VERSION || h->nx <= 0 || h->ny <= 0 || h->nz <= 0
+			|| (size_t)st.st_size != expected ) {
+		G4cout << "[AllPixEFieldMap] " << file << " : unknown version or truncated file" << G4endl;
+		munmap(base, st.st_size);
+		return false;
+	}
+
+	// the field is used as V/cm (text maps), others are converted
+	char unit[sizeof(h->fieldUnit) + 1];
+	memcpy(unit, h->fieldUnit, sizeof(h->fieldUnit));
+	unit[sizeof(h->fieldUnit)] = '\0';
+	G4double scale = 1.;
+	if ( !GetUnitScale(unit, scale) ) {
+		G4cout << "[AllPixEFieldMap] " << file << " : unknown field unit \"" << unit
+				<< "\", expected V/cm, V/m, V/mm, V/um, kV/cm or MV/m" << G4endl;
+		munmap(base, st.st_size);
+		return false;
+	}
+
+	const float * payload = (const float *)( (const char *)base + sizeof(AllPixEFieldMapHeader) );
+	G4double pitch[3] = { h->pitch[0], h->pitch[1], h->pitch[2] };
+
+	if ( scale != 1. ) {
+		// copy in V/cm, the map is not used any more
+		G4cout << "[WARNING] EField map " << file << " is in " << unit
+				<< ", converted to V/cm on load (no mmap).  allpix-efield-convert it with V/cm to map it." << G4endl;
+		Init(h->nx, h->ny, h->nz);
+		for ( size_t n = 0 ; n < m_field.size() ; n++ ) m_field[n] = (float)(payload[n] * scale);
+		munmap(base, st.st_size);
+	} else {
+		Unmap();
+		m_field.clear();
+	
+		m_mapBase = base;
+		m_mapSize = st.st_size;
+		m_nx = h->nx;
+		m_ny = h->ny;
+		m_nz = h->nz;
+		m_data = payload;
+	}
+
+	for ( G4int a = 0 ; a < 3 ; a++ ) m_pitch[a] = pitch[a];
+	m_fieldUnit = "V/cm";
+
+	return true;
+}
+
+G4bool AllPixEFieldMap::GetUnitScale(const G4String & unit, G4double & toVPerCm){
+
+	static const struct { const char * name; G4double scale; } units[] = {
+		{ "V/cm", 1. }, { "V/m", 1e-2 }, { "V/mm", 1e1 }, { "V/um", 1e4 },
+		{ "kV/cm", 1e3 }, { "MV/m", 1e4 }
+	};
+
+	for ( size_t i = 0 ; i < sizeof(units)/sizeof(units[0]) ; i++ ) {
+		if ( unit == units[i].name ) {
+			toVPerCm = units[i].scale;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+G4bool AllPixEFieldMap::WriteBinary(const G4String & file, const G4double pitch[3], const G4String & fieldUnit) const {
+
+	if ( !IsLoaded() ) return false;
+
+	AllPixEFieldMapHeader h;
+	memset(&h, 0, sizeof(h));
+	strncpy(h.magic, ALLPIX_EFIELDMAP_MAGIC, sizeof(h.magic));
+	h.version = ALLPIX_EFIELDMAP_VERSION;
+	h.nx = m_nx;
+	h.ny = m_ny;
+	h.nz = m_nz;
+	for ( G4int a = 0 ; a < 3 ; a++ ) h.pitch[a] = pitch[a];
+	strncpy(h.fieldUnit, fieldUnit.c_str(), sizeof(h.fieldUnit) - 1);
+
+	FILE * f = fopen(file.c_str(), "wb");
+	if ( !f ) return false;
+
+	size_t n = (size_t)3 * m_nx * m_ny * m_nz;
+	G4bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(m_data, sizeof(float), n, f) == n;
+	ok = (fclose(f) == 0) && ok;
+
+	return ok;
+}
@@ -12,6 +12,13 @@
 // geometry
 #include "ReadGeoDescription.hh"
 
+#include <chrono>
+#include <mutex>
+
+// static initialization, i.e. program start, for the time to first event
+static const std::chrono::steady_clock::time_point g_programStart = std::chrono::steady_clock::now();
+static std::once_flag g_firstEventFlag;
+
 AllPixEventAction::AllPixEventAction(AllPixRunAction* run){
 
 	m_run_action = run;
@@ -56,6 +63,12 @@ void AllPixEventAction::SetDetectorDigitInput(G4double thl, G4int detId){
 void AllPixEventAction::BeginOfEventAction(const G4Event * /*evt*/)
 {  
 
+	// start up cost: geometry database, physics tables, digitizers
+	std::call_once(g_firstEventFlag, []{
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - g_programStart;
+		G4cout << "[INFO] time to first event : " << elapsed.count() << " s" << G4endl;
+	});
+
 	//G4PrimaryVertex * pv = evt->GetPrimaryVertex();
 
 }
@@ -18,6 +18,7 @@
 
 
 #include "AllPixGeoDsc.hh"
+#include "AllPixErf.hh"
 
 
 
@@ -124,6 +125,10 @@ AllPixFEI3StandardDigitizer::AllPixFEI3StandardDigitizer(G4String modName, G4Str
 	electricFieldX = 0; // V/um
 	electricFieldY = 0; // V/um
 
+	// Ez = (thickness - z) * bias / depleted depth, zero beyond the depleted depth
+	m_driftField = AllPixLinearField1D(detectorThickness*biasVoltage/depletedDepth, -biasVoltage/depletedDepth, depletedDepth);
+	m_electronMobility = AllPixCaugheyThomasMobility(Default_Electron_Mobility, Electron_Saturation_Velocity/Default_Electron_Mobility, Electron_Beta);
+
 	G4cout << "!!!!!!!Radiation Damage Report !!!!!!!!" << endl
 		 << TString::Format("depletionVoltage : %f depleted Depth : %f",depletionVoltage,depletedDepth/um) << endl
 		 << TString::Format("Neff : %e Neff0 : %e ",Neff*cm3,Neff0*cm3);
@@ -145,10 +150,8 @@ AllPixFEI3StandardDigitizer::AllPixFEI3StandardDigitizer(G4String modName, G4Str
  	////////////////////////////////////
  	// Numerical integration accuracy //
  	////////////////////////////////////
- 	Target = 1e-4 ;
- 	tlow =  0.001*ns;
- 	tup=	0.1*ns;
- 	dtIni = 0.01*ns;
+ 	// m_driftStepControl, the default of AllPixDriftStepControl:
+ 	//  target 1e-4, steps from 0.001 to 0.1 ns, first step 0.01 ns
 
  	precision = 1;
 
@@ -272,6 +275,30 @@ AllPixFEI3StandardDigitizer::AllPixFEI3StandardDigitizer(G4String modName, G4Str
 
 
 
+
+	// Drift response tables for the 1D field, instead of one full
+	//  integration per hit.  /allpix/det/setDriftTable false to disable.
+	doDriftTable = GetDetectorGeoDscPtr()->GetDriftTable();
+	if(doFullField && doDriftTable) BuildDriftTable();
+
+}
+
+void AllPixFEI3StandardDigitizer::BuildDriftTable(){
+
+	// drifts while 0 < z < thickness
+	G4int nNodes = 501;
+	// split at the depleted depth, where the field stops
+	m_driftTable.Init(0., detectorThickness, nNodes, depletedDepth);
+
+	for(G4int i=0;i<m_driftTable.GetNNodes();i++){
+		G4double z = m_driftTable.GetZ(i);
+		m_driftTable.Set(i, ComputeDriftTimeFullField(0., 0., z));
+	}
+
+	G4cout << "[FEI3Standard Digitizer] drift table with " << m_driftTable.GetNNodes() << " nodes in z";
+	if(m_driftTable.IsSplit()) G4cout << ", split at the depleted depth " << m_driftTable.GetSplitZ()/um << " um";
+	G4cout << G4endl;
+
 }
 
 AllPixFEI3StandardDigitizer::~AllPixFEI3StandardDigitizer(){
@@ -289,43 +316,20 @@ void AllPixFEI3StandardDigitizer::SetDetectorDigitInputs(G4double thl){
 
 
 G4double AllPixFEI3StandardDigitizer::MyErf(G4double x){
-	TF1 * f1 = new TF1("expint","(2.0/TMath::Pi())*exp(-x**2)",-100.,100.);
-	return f1->Integral(0,x);
 
+	// AllPixErf.hh
+	return AllPixFastErf(x);
 
 }
 
 
-vector<G4double>  AllPixFEI3StandardDigitizer::ComputeDriftTimeFullField(G4double x, G4double y, G4double z)
+AllPixDriftResult AllPixFEI3StandardDigitizer::ComputeDriftTimeFullField(G4double x, G4double y, G4double z)
 {
-	G4double driftTime=0;
-	G4double dt=dtIni;
-	G4double xtemp=x;
-	G4double ytemp=y;
-	G4double ztemp=z;
-	//cout << "z : " << z/um << endl;
-	vector<G4double> step;
-	int counter=0;
-	while( ztemp>0 && ztemp<detectorThickness){
-
-		driftTime+=dt;
-		step=RKF5Integration(xtemp,ytemp,ztemp,dt);
-		xtemp+=step[0];
-		ytemp+=step[1];
-		ztemp+=step[2];
-		if(GetElectricFieldNorm(xtemp,ytemp,ztemp)==0)ztemp=detectorThickness;
-		dt=SetDt(dt,step[3]);
-		counter++;
-		//cout << "!!!!!! Drifting youhou! !!!!! " << TString::Format("dt: %f z : %f drift : %f Ez : %f",dt/ns,ztemp/um,driftTime/ns,electricFieldZ*cm) << endl;
-	}
+	AllPixDriftEngine<kAllPixElectron, AllPixLinearField1D, AllPixCaugheyThomasMobility, false>
+	engine(m_driftField, m_electronMobility);
 
-	vector<G4double> output(4);
-	output[0]=xtemp;
-	output[1]=ytemp;
-	output[2]=ztemp;
-	output[3]=driftTime;
-
-	return output;
+	// drifts while 0 < z < thickness, see AllPixDriftEngine.hh
+	return AllPixDriftThroughSensor(engine, m_driftStepControl, x, y, z, 0., detectorThickness);
 }
 
 
@@ -344,10 +348,7 @@ G4double  AllPixFEI3StandardDigitizer::MobilityElectron(G4double /*x*/, G4double
 
 	//ComputeElectricField(x,y,z);
 	G4double parElectricField = electricFieldZ;//GetElectricFieldNorm(x,y,z);
-	G4double mobilite = Default_Electron_Mobility*
-	TMath::Power((1.0/(1.+ TMath::Power((Default_Electron_Mobility*parElectricField)/
-			Electron_Saturation_Velocity,Electron_Beta))),1.0/Electron_Beta);
-	return mobilite;
+	return m_electronMobility(TMath::Abs(parElectricField));
 	//cout << "!!!!!!!!!" << mobilite << " " << parElectricField*cm << endl;
 
 }
@@ -396,19 +397,14 @@ G4double AllPixFEI3StandardDigitizer::IntegrateGaussian(G4double xhit,G4double y
 {
 	//G4cout << TString::Format("Integration borns x1=%f x2=%f y1=%f y2=%f",x1/um,x2/um,y1/um,y2/um) << endl;
 	//G4cout << TString::Format("TMath::Erf test %f %f %f %f",TMath::Erf((x1 - xhit)/(Sqrt(2.)*Sigma)),TMath::Erf((x2 - xhit)/(TMath::Sqrt(2.)*Sigma)),TMath::Erf((y1 - yhit)/(TMath::Sqrt(2.)*Sigma)),TMath::Erf((y2 - yhit)/(TMath::Sqrt(2.)*Sigma)))<< endl;
-	return (Energy*(-TMath::Erf((x1 - xhit)/(Sqrt(2.)*Sigma)) + TMath::Erf((x2 - xhit)/(TMath::Sqrt(2.)*Sigma)))
-			*(-TMath::Erf((y1 - yhit)/(TMath::Sqrt(2.)*Sigma)) + TMath::Erf((y2 - yhit)/(TMath::Sqrt(2.0)*Sigma))))/4.;
+	return AllPixGaussianBoxIntegral(xhit, yhit, Sigma, x1, x2, y1, y2, Energy);
 }
 
 
 void AllPixFEI3StandardDigitizer::Efield1D(G4double z){
 
 
-	electricFieldZ=(detectorThickness-z)*biasVoltage/depletedDepth;
-	if(z>depletedDepth){
-		electricFieldZ=0;
-		//cout << "bip" << endl;
-	}
+	electricFieldZ=m_driftField.Ez(z);
 
 }
 
@@ -435,7 +431,7 @@ void AllPixFEI3StandardDigitizer::Digitize(){
 
 	// Temporary data structure to store hits
 	//  collection information
-	map<pair<G4int, G4int>, G4double > pixelsContent;
+	AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator();
 	pair<G4int, G4int> tempPixel;
 
 	// Loop over the whole Hits Collection
@@ -495,11 +491,13 @@ void AllPixFEI3StandardDigitizer::Digitize(){
 		else{
 
 			// Until we get out position
-			vector<G4double> data = ComputeDriftTimeFullField(xpos,ypos,zpos);
-			driftTime = data[3];
+			// tabulated response when available, full integration otherwise
+			AllPixDriftResult data = (doDriftTable && m_driftTable.IsInRange(zpos)) ?
+					m_driftTable.Lookup(xpos,ypos,zpos) : ComputeDriftTimeFullField(xpos,ypos,zpos);
+			driftTime = data.t;
 			sigma = ComputeDiffusionRMS(driftTime);
-			xpos=data[0];
-			ypos=data[1];
+			xpos=data.x;
+			ypos=data.y;
 
 		}
 
@@ -575,7 +573,7 @@ void AllPixFEI3StandardDigitizer::Digitize(){
 	//G4cout << "total = " << hitsETotal/keV << " keV" << G4endl;
 
 	// Now create digits.  One per pixel
-	map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+	AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
 
 	for( ; pCItr != pixelsContent.end() ; pCItr++)
 	{
@@ -627,100 +625,9 @@ void AllPixFEI3StandardDigitizer::Digitize(){
 
 
 
-vector<G4double>  AllPixFEI3StandardDigitizer::RKF5Integration(G4double x, G4double y, G4double z,G4double dt)
-{
-// This function transport using Euler integration, for field (Ex,Ey,Ez),
-// considered constant over time dt. The movement equation are those
-// of charges in semi-conductors, sx= mu*E*dt;;
-	double k1x,k2x,k3x,k4x,k5x,k6x;
-	double k1y,k2y,k3y,k4y,k5y,k6y;
-	double k1z,k2z,k3z,k4z,k5z,k6z;
-	double dx,dy,dz;
-
-      ComputeElectricField(x,y,z);
-
-      k1x=-MobilityElectron(x,y,z)*electricFieldX*dt;
-      k1y=-MobilityElectron(x,y,z)*electricFieldY*dt;
-      k1z=-MobilityElectron(x,y,z)*electricFieldZ*dt;
-
-      ComputeElectricField(x+k1x/4,y+k1y/4,z+k1z/4);
-
-      k2x=-MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldX*dt;
-      k2y=-MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldY*dt;
-      k2z=-MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldZ*dt;
-
-     ComputeElectricField(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z);
-
-      k3x=-MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldX*dt;
-      k3y=-MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldY*dt;
-      k3z=-MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldZ*dt;
-
-      ComputeElectricField(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z);
-
-      k4x=-MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldX*dt;
-      k4y=-MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldY*dt;
-      k4z=-MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldZ*dt;
-
-      ComputeElectricField(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z);
-
-      k5x=-MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldX*dt;
-      k5y=-MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldY*dt;
-      k5z=-MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldZ*dt;
-
-      ComputeElectricField(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z);
-
-      k6x=-MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldX*dt;
-      k6y=-MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldY*dt;
-      k6z=-MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldZ*dt;
-
-      dx=((16./135)*k1x+(6656./12825)*k3x+(28561./56430)*k4x-(9./50)*k5x+(2./55)*k6x);
-      dy=((16./135)*k1y+(6656./12825)*k3y+(28561./56430)*k4y-(9./50)*k5y+(2./55)*k6y);
-      dz=((16./135)*k1z+(6656./12825)*k3z+(28561./56430)*k4z-(9./50)*k5z+(2./55)*k6z);
-
-      double Ex,Ey,Ez,Erreur;
-      Ex=((1./360)*k1x-(128./4275)*k3x-(2197./75240)*k4x+(1./50)*k5x+(2./55)*k6x);
-      Ey=((1./360)*k1y-(128./4275)*k3y-(2197./75240)*k4y+(1./50)*k5y+(2./55)*k6y);
-      Ez=((1./360)*k1z-(128./4275)*k3z-(2197./75240)*k4z+(1./50)*k5z+(2./55)*k6z);
-      Erreur=sqrt(Ex*Ex+Ey*Ey+Ez*Ez);
-
-      vector<G4double> newpoint(4);
-      newpoint[0]=(dx);
-      newpoint[1]=(dy);
-      newpoint[2]=(dz);
-      newpoint[3]=(Erreur);
-
-     return newpoint;
-
-}
-
-
-
-
-//______________________________________________________________________________
-G4double  AllPixFEI3StandardDigitizer::SetDt(G4double dt, G4double ErreurMoy)
-{
-
-	double Dt=dt;
-	//if(isnan(ErreurMoy)){Dt=tup;}
-	if( ErreurMoy != ErreurMoy ){Dt=tup;}
-	else if(ErreurMoy > Target){ Dt*=0.9;}
-	else if(ErreurMoy < Target){ Dt*=1.1;};
 
 
-	if(Dt<tlow) Dt=tlow;
-	if(Dt>tup)  Dt=tup;
 
-	return Dt;
-
-}
 
 G4int AllPixFEI3StandardDigitizer::EnergyToTOT(G4double Energy, G4double threshold)
 {
@@ -222,7 +222,7 @@ void AllPixFEI4RadDamageDigitizer::Digitize(){
 	hitsCollection = (AllPixTrackerHitsCollection*)(digiMan->GetHitsCollection(hcID));
 
 	// temporary data structure
-	map<pair<G4int, G4int>, G4double > pixelsContent;		// stored energy per (countx,county) pixel	
+	AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator();		// stored energy per (countx,county) pixel	
 	pair<G4int, G4int> tempPixel;					// (countx,county) which pixel
 
 
@@ -246,106 +246,122 @@ void AllPixFEI4RadDamageDigitizer::Digitize(){
 		extraPixel = tempPixel;
 
 		// Split the charge into subcharges (# = precision) that are diffused separately to the electrode
-		for(G4int nQ  = 0 ; nQ < precision ; nQ++) {
-				
-		  G4double eHit = G4double(eHitTotal)/(2*precision); // eV; divide in half because we are treating holes separately	
-		  //G4double eHitbefore = eHit;
-		  
-		  // Loop over everything following twice, once for holes and once for electrons
-		  for(G4int eholes=0 ; eholes<2 ; eholes++) { // Loop over everything twice, once for electrons and once for holes
+		G4double eHit = G4double(eHitTotal)/(2*precision); // eV; divide in half because we are treating holes separately	
+
+		// The field, the mobility and the time to the electrode only depend on the depth, they are
+		//  computed once per hit and carrier type.  The subcharges are then moved together as the
+		//  lanes of a batch (see AllPixCarrierBatch), with the random numbers drawn in blocks.
+
+		// Don't use the event if electric field is zero, unless it is zero because charge is at electrode, in which case record it
+		G4double electricField = GetElectricField(zpos);
+		if (electricField == 0) {
+		  if (zpos < 1){
+		    pixelsContent[extraPixel] += 2*precision*eHit; // eV
+		  }
+		  continue;
+		}
+
+		// Loop over everything following twice, once for holes and once for electrons
+		for(G4int eholes=0 ; eholes<2 ; eholes++) { // Loop over everything twice, once for electrons and once for holes
 		    
 		    //Need to modify to only use holes for ramo.
 		    isHole = false; // Set a condition to keep track of electron/hole-specific functions
 		    if (eholes == 1) isHole = true;
 		    
-		    // Don't use the event if electric field is zero, unless it is zero because charge is at electrode, in which case record it
-		    G4double electricField = GetElectricField(zpos);
-		    if (electricField == 0) {
-		      if (zpos < 1){
-			pixelsContent[extraPixel] += eHit; // eV
-		      }
-		      continue;	// flushes current event, continues with next event
-		    }
-		    
-		    // Reset extraPixel coordinates each time through loop
-		    extraPixel = tempPixel;
-		    
 		    mobility = GetMobility(electricField, temperature, isHole);
 		    //G4double driftVelocity = GetDriftVelocity(electricField, mobility, isHole);
 		    //G4double meanFreePath = GetMeanFreePath(driftVelocity, isHole);
 		    //G4double trappingProbability = GetTrappingProbability(zpos, meanFreePath,isHole);
 		    G4double timeToElectrode = GetTimeToElectrode(zpos, isHole);
-		    G4double driftTime = GetDriftTime(isHole);
 		    G4double hallEffect = 1.13 + 0.0008*(temperature - 273.0);      //Hall Scattering Factor - taken from https://cds.cern.ch/record/684187/files/indet-2001-004.pdf
 		    G4double tanLorentz = hallEffect*mobility*bField*(1.0E-3);	//unit conversion 
 		    
 		    G4double rdif=diffusion_length;
 		    if (!doDrift) rdif = 0.; 
-		    G4double xposD=xpos+zpos*tanLorentz+rdif*CLHEP::RandGauss::shoot(0,1); // Is it still +zpos in the case of the holes?                                               
-		    G4double yposD=ypos+rdif*CLHEP::RandGauss::shoot(0,1);
-		    
-		    // Account for drifting into another pixel 
-		    while (fabs(xposD) > pitchX/2){
-		      G4double sign = xposD/(fabs(xposD));                        // returns +1 or -1 depending on + or - x value 
-		      extraPixel.first = extraPixel.first + 1*sign;               // increments or decrements pixel count in x
-		      xposD = xposD - (pitchX*sign);                              // moves xpos coordinate 1 pixel over in x
+
+		    // All the subcharges start at the Lorentz shifted position
+		    m_carriers.Reset(precision, xpos+zpos*tanLorentz, ypos); // Is it still +zpos in the case of the holes?
+		    G4double * xposD = m_carriers.X();
+		    G4double * yposD = m_carriers.Y();
+		    G4double * driftTime = m_carriers.TTrap();
+
+		    if (rdif != 0.) {
+		      const G4double * g = m_carriers.Gauss(2*precision);
+		      for(G4int nQ = 0 ; nQ < precision ; nQ++) {
+			xposD[nQ] += rdif*g[2*nQ];
+			yposD[nQ] += rdif*g[2*nQ+1];
+		      }
 		    }
-		    while (fabs(yposD) > pitchY/2){
-		      G4double sign = yposD/(fabs(yposD));                        // returns +1 or -1 depending on + or - y value
-		      extraPixel.second = extraPixel.second + 1*sign;             // increments or decrements pixel count in y
-		      yposD = yposD - (pitchY*sign);                              // moves xpos coordinate 1 pixel over in y 
+
+		    // Trapping time of each subcharge, t = -tau*ln(u)
+		    if (doTrapping) {
+		      G4double trappingTime = isHole ? trappingTimeHoles : trappingTimeElectrons;
+		      const G4double * u = m_carriers.Flat(precision);
+		      for(G4int nQ = 0 ; nQ < precision ; nQ++) {
+			driftTime[nQ] = (-1.)*trappingTime*TMath::Log(u[nQ]); // ns
+		      }
 		    }
+
+		    for(G4int nQ  = 0 ; nQ < precision ; nQ++) {
+
+		      // Account for drifting into another pixel 
+		      extraPixel = tempPixel;
+		      G4int shiftX = (G4int)floor(xposD[nQ]/pitchX + 0.5);
+		      G4int shiftY = (G4int)floor(yposD[nQ]/pitchY + 0.5);
+		      extraPixel.first += shiftX;
+		      extraPixel.second += shiftY;
+		      G4double xposP = xposD[nQ] - shiftX*pitchX;
+		      G4double yposP = yposD[nQ] - shiftY*pitchY;
 		    
-		    if ((driftTime < timeToElectrode) && doTrapping){ //charge was trapped
-		      if (doRamo){
-			// Also record deposit due to diff in ramo potential between (xposD, yposD, electrode) and (xpos, ypos, zpos)
-			// Initial ramo potential based on (x,y,z) position in micrometers
-			int nbin = 0;
-			if(!isHole) nbin = ramoPotentialMap->FindBin(fabs(ypos*1000),fabs(xpos*1000),zpos*1000);
-			if(isHole) nbin = ramoPotentialMap->FindBin(fabs(ypos*1000),fabs(xpos*1000),250-zpos*1000);
-			G4double ramo_i = ramoPotentialMap->GetBinContent(nbin);
+		      if (doTrapping && (driftTime[nQ] < timeToElectrode)){ //charge was trapped
+		        if (doRamo){
+			  // Also record deposit due to diff in ramo potential between (xposD, yposD, electrode) and (xpos, ypos, zpos)
+			  // Initial ramo potential based on (x,y,z) position in micrometers
+			  int nbin = 0;
+			  if(!isHole) nbin = ramoPotentialMap->FindBin(fabs(ypos*1000),fabs(xpos*1000),zpos*1000);
+			  if(isHole) nbin = ramoPotentialMap->FindBin(fabs(ypos*1000),fabs(xpos*1000),250-zpos*1000);
+			  G4double ramo_i = ramoPotentialMap->GetBinContent(nbin);
 			
-			// ramo potential at electrode based on (x,y,z) position in micrometers
-			// -- loop in the x-coordinate
-			for (int i=-1; i<=1; i++){
-			  G4double x_neighbor = xposD + i*pitchX;
-			  extraPixel.first += i;
-			  if (i == 0){
-			    extraPixel.first += 1;// For the middle neighbor, still have to add one to get back to zero
-			  }
-			  extraPixel.second = extraPixel.second - 1; // to start the y-pixel count in the middle pixel each time 
-			  
-			  // -- loop in the y-coordinate
-			  for (int j=-1; j<=1; j++){
-			    G4double y_neighbor = yposD + j*pitchY;
-			    extraPixel.second += j;
-			    if (j == 0){
-			      extraPixel.second += 1; // For the middle neighbor, add one to get back to zero
+			  // ramo potential at electrode based on (x,y,z) position in micrometers
+			  // -- loop in the x-coordinate
+			  for (int i=-1; i<=1; i++){
+			    G4double x_neighbor = xposP + i*pitchX;
+			    extraPixel.first += i;
+			    if (i == 0){
+			      extraPixel.first += 1;// For the middle neighbor, still have to add one to get back to zero
 			    }
-			    // Return ramo potential based on (x,y,z) position in micrometers; in z is at electrode
-			    // Return ramo potential based on (x,y,z) position in micrometers; in z is at electrode
-			    int nbin2 = ramoPotentialMap->FindBin(fabs(y_neighbor*1000),fabs(x_neighbor*1000),0);
-			    G4double ramo = ramoPotentialMap->GetBinContent(nbin2);
+			    extraPixel.second = extraPixel.second - 1; // to start the y-pixel count in the middle pixel each time 
+			  
+			    // -- loop in the y-coordinate
+			    for (int j=-1; j<=1; j++){
+			      G4double y_neighbor = yposP + j*pitchY;
+			      extraPixel.second += j;
+			      if (j == 0){
+			        extraPixel.second += 1; // For the middle neighbor, add one to get back to zero
+			      }
+			      // Return ramo potential based on (x,y,z) position in micrometers; in z is at electrode
+			      int nbin2 = ramoPotentialMap->FindBin(fabs(y_neighbor*1000),fabs(x_neighbor*1000),0);
+			      G4double ramo = ramoPotentialMap->GetBinContent(nbin2);
 			    
-			    // Record deposit
-			    G4double eHitRamo = eHit*(ramo - ramo_i);  //eV
-			    pixelsContent[extraPixel] += eHitRamo; //eV
-			  } //loop over y
-			} //loop over x
-		      } //doRamo
-		    } //is trapped
-		    else { //charge was not trapped or charge trapping is turned off.
+			      // Record deposit
+			      G4double eHitRamo = eHit*(ramo - ramo_i);  //eV
+			      pixelsContent[extraPixel] += eHitRamo; //eV
+			    } //loop over y
+			  } //loop over x
+		        } //doRamo
+		      } //is trapped
+		      else { //charge was not trapped or charge trapping is turned off.
 		      
-		      // Record deposit
-		      pixelsContent[extraPixel] += eHit; // eV
-		    }
+		        // Record deposit
+		        pixelsContent[extraPixel] += eHit; // eV
+		      }
 		    
-		  } // end loop over nQ charges
-		} // end loop over nEntries
-	} // end loop over charges/holes
+		    } // end loop over nQ charges
+		} // end loop over charges/holes
+	} // end loop over nEntries
 	
 	// Now that pixelContent is filled, create one digit per pixel
-	map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+	AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
 	
 	for( ; pCItr != pixelsContent.end() ; pCItr++)
 	  {
@@ -0,0 +1,219 @@
+#include "AllPixFastPlaneModel.hh"
+#include "AllPixTrackerSD.hh"
+#include "AllPixGeoDsc.hh"
+#include "AllPixNameTable.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Region.hh"
+#include "G4LogicalVolume.hh"
+#include "G4AffineTransform.hh"
+#include "G4Material.hh"
+#include "G4IonisParamMat.hh"
+#include "G4UserLimits.hh"
+#include "G4VSolid.hh"
+#include "G4Track.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// most probable value of the standard Landau (CLHEP::RandLandau)
+static const G4double c_landauMostProbable = -0.22278;
+
+AllPixFastPlaneModel::AllPixFastPlaneModel(G4String name, G4Region * region,
+		AllPixTrackerSD * sd, AllPixGeoDsc * gD, G4bool killTrack)
+: G4VFastSimulationModel(name, region)
+{
+
+	m_trackerSD = sd;
+	m_gD = gD;
+	m_killTrack = killTrack;
+	m_processId = -1;
+
+}
+
+AllPixFastPlaneModel::~AllPixFastPlaneModel(){
+
+}
+
+G4bool AllPixFastPlaneModel::IsApplicable(const G4ParticleDefinition & particle){
+
+	return particle.GetPDGCharge() != 0.;
+}
+
+/**
+ * Primaries, when they enter the sensor.  The trigger is asked at every
+ * step in the envelope, the secondaries and a primary already inside
+ * (e.g. started there) are left to the full simulation.
+ */
+G4bool AllPixFastPlaneModel::ModelTrigger(const G4FastTrack & fastTrack){
+
+	if ( fastTrack.GetPrimaryTrack()->GetParentID() != 0 ) return false;
+
+	const G4VSolid * solid = fastTrack.GetEnvelopeSolid();
+	G4ThreeVector pos = fastTrack.GetPrimaryTrackLocalPosition();
+	if ( solid->Inside(pos) != kSurface ) return false;
+
+	// grazing the surface, left to the transportation
+	return solid->DistanceToOut(pos, fastTrack.GetPrimaryTrackLocalDirection()) > 0.;
+}
+
+void AllPixFastPlaneModel::DoIt(const G4FastTrack & fastTrack, G4FastStep & fastStep){
+
+	const G4Track * track = fastTrack.GetPrimaryTrack();
+	const G4ParticleDefinition * particle = track->GetDefinition();
+	const G4Material * material = fastTrack.GetEnvelopeLogicalVolume()->GetMaterial();
+	G4double kinE = track->GetKineticEnergy();
+
+	// straight line through the sensor, envelope frame
+	G4ThreeVector entry = fastTrack.GetPrimaryTrackLocalPosition();
+	G4ThreeVector dir = fastTrack.GetPrimaryTrackLocalDirection();
+	G4double length = fastTrack.GetEnvelopeSolid()->DistanceToOut(entry, dir);
+	G4ThreeVector exit = entry + length*dir;
+
+	G4double edep = SampleEnergyLoss(particle, kinE, material, length);
+	if ( edep > kinE ) edep = kinE;
+
+	// Cut the path where it crosses a pixel boundary, and every max
+	//  step of the region if it has one, so the hits look like the
+	//  ones of the full simulation
+	vector<G4double> cuts;
+	cuts.push_back(0.);
+	cuts.push_back(length);
+
+	G4double pitch[2] = { m_gD->GetSensorX()/m_gD->GetNPixelsX(), m_gD->GetSensorY()/m_gD->GetNPixelsY() };
+	G4double half[2] = { m_gD->GetHalfSensorX(), m_gD->GetHalfSensorY() };
+	for ( int c = 0 ; c < 2 ; c++ ) {
+		G4double p0 = entry[c];
+		G4double p1 = exit[c];
+		if ( dir[c] == 0. ) continue;
+		G4int iFirst = (G4int) floor( (min(p0, p1) + half[c]) / pitch[c] ) + 1;
+		G4int iLast = (G4int) ceil( (max(p0, p1) + half[c]) / pitch[c] ) - 1;
+		for ( G4int i = iFirst ; i <= iLast ; i++ ) {
+			G4double t = (i*pitch[c] - half[c] - p0) / dir[c];
+			if ( t > 0. && t < length ) cuts.push_back(t);
+		}
+	}
+
+	G4UserLimits * limits = fastTrack.GetEnvelope()->GetUserLimits();
+	if ( limits ) {
+		G4double maxStep = limits->GetMaxAllowedStep(*track);
+		if ( maxStep > 0. && maxStep < length )
+			for ( G4double t = maxStep ; t < length ; t += maxStep ) cuts.push_back(t);
+	}
+
+	sort(cuts.begin(), cuts.end());
+
+	if ( m_processId < 0 ) m_processId = AllPixNameTable::GetInstance()->GetId(GetName());
+
+	const G4AffineTransform * toGlobal = fastTrack.GetInverseAffineTransformation();
+	for ( size_t i = 0 ; i + 1 < cuts.size() ; i++ ) {
+		G4double segment = cuts[i+1] - cuts[i];
+		if ( segment <= 0. ) continue;
+		// the deposit is put in the middle of the segment, away from
+		//  the pixel boundaries
+		G4ThreeVector mid = entry + (0.5*(cuts[i] + cuts[i+1]))*dir;
+		G4ThreeVector post = entry + cuts[i+1]*dir;
+		m_trackerSD->AddFastHit(track,
+				toGlobal->TransformPoint(mid),
+				toGlobal->TransformPoint(post),
+				edep*segment/length,
+				m_processId);
+	}
+
+	// the primary at the exit of the sensor
+	G4double velocity = track->GetVelocity();
+	fastStep.ProposePrimaryTrackPathLength(length);
+	fastStep.ProposeTotalEnergyDeposited(edep);
+	if ( velocity > 0. ) fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + length/velocity);
+	fastStep.ProposePrimaryTrackFinalPosition(exit);
+
+	if ( m_killTrack || edep >= kinE ) {
+		fastStep.KillPrimaryTrack();
+		return;
+	}
+
+	// multiple scattering of the whole layer, two projected angles
+	G4double theta0 = HighlandAngle(particle, kinE, material, length);
+	G4ThreeVector u = dir.orthogonal().unit();
+	G4ThreeVector v = dir.cross(u);
+	G4double thetaU = G4RandGauss::shoot(0., theta0);
+	G4double thetaV = G4RandGauss::shoot(0., theta0);
+	G4ThreeVector newDir = (dir + tan(thetaU)*u + tan(thetaV)*v).unit();
+	// may not leave through the face it was going through
+	if ( newDir.dot(dir) <= 0. ) newDir = dir;
+
+	fastStep.ProposePrimaryTrackFinalMomentumDirection(newDir);
+	fastStep.ProposePrimaryTrackFinalKineticEnergy(kinE - edep);
+
+}
+
+/**
+ * Energy loss in a layer (PDG, passage of particles through matter).
+ * Landau around the most probable loss, with xi = 2 pi r_e^2 m_e c^2 n_el z^2 L / beta^2.
+ * When the layer is thick compared to the largest transfer (kappa > 10)
+ * the distribution is a Gaussian around the mean loss.
+ */
+G4double AllPixFastPlaneModel::SampleEnergyLoss(const G4ParticleDefinition * particle,
+		G4double kinE, const G4Material * material, G4double length){
+
+	G4double mass = particle->GetPDGMass();
+	G4double charge = particle->GetPDGCharge()/eplus;
+	G4double gamma = (kinE + mass)/mass;
+	G4double beta2 = 1. - 1./(gamma*gamma);
+	G4double betaGamma2 = beta2*gamma*gamma;
+
+	// largest energy transfer to an electron
+	G4double tMax;
+	if ( particle == G4Electron::Definition() ) tMax = 0.5*kinE;
+	else if ( particle == G4Positron::Definition() ) tMax = kinE;
+	else {
+		G4double ratio = electron_mass_c2/mass;
+		tMax = 2.*electron_mass_c2*betaGamma2 / (1. + 2.*gamma*ratio + ratio*ratio);
+	}
+
+	G4double xi = twopi_mc2_rcl2 * material->GetElectronDensity() * charge*charge * length / beta2;
+	G4double kappa = xi/tMax;
+
+	G4IonisParamMat * ionisation = material->GetIonisation();
+	G4double I = ionisation->GetMeanExcitationEnergy();
+	G4double delta = ionisation->DensityCorrection( 0.5*log10(betaGamma2) );
+
+	G4double loss;
+	if ( kappa > 10. ) {
+		// Bethe mean, width from the largest transfer
+		G4double mean = 2.*xi * ( 0.5*log(2.*electron_mass_c2*betaGamma2*tMax/(I*I)) - beta2 - 0.5*delta );
+		G4double sigma = sqrt( xi*tMax*(1. - 0.5*beta2) );
+		loss = G4RandGauss::shoot(mean, sigma);
+	} else {
+		G4double mostProbable = xi * ( log(2.*electron_mass_c2*betaGamma2/I) + log(xi/I) + 0.2 - beta2 - delta );
+		loss = mostProbable + xi*( CLHEP::RandLandau::shoot() - c_landauMostProbable );
+	}
+
+	return loss > 0. ? loss : 0.;
+}
+
+/**
+ * Width of the projected scattering angle (Highland).
+ */
+G4double AllPixFastPlaneModel::HighlandAngle(const G4ParticleDefinition * particle,
+		G4double kinE, const G4Material * material, G4double length){
+
+	G4double mass = particle->GetPDGMass();
+	G4double charge = fabs( particle->GetPDGCharge()/eplus );
+	G4double momentum = sqrt( kinE*(kinE + 2.*mass) );
+	G4double beta = momentum/(kinE + mass);
+	G4double x = length/material->GetRadlen();
+
+	G4double theta0 = 13.6*MeV/(beta*momentum) * charge * sqrt(x) * (1. + 0.038*log(x*charge*charge/(beta*beta)));
+
+	return theta0 > 0. ? theta0 : 0.;
+}
@@ -0,0 +1,135 @@
+#include "AllPixFrameFile.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static size_t metaPadded(int32_t metaBytes) {
+	return (metaBytes + 3) & ~(size_t)3;
+}
+
+AllPixFrameFile::AllPixFrameFile() {
+
+	m_base = 0x0;
+	m_size = 0;
+	m_header = 0x0;
+	m_meta = 0x0;
+	m_index = 0x0;
+	m_counts = 0x0;
+
+}
+
+AllPixFrameFile::~AllPixFrameFile() {
+
+	Close();
+
+}
+
+bool AllPixFrameFile::IsFrameFile(const string & file) {
+
+	FILE * f = fopen(file.c_str(), "rb");
+	if ( !f ) return false;
+
+	char magic[8];
+	bool is = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+			&& strncmp(magic, ALLPIX_FRAMEFILE_MAGIC, sizeof(magic)) == 0;
+	fclose(f);
+
+	return is;
+}
+
+bool AllPixFrameFile::Open(const string & file) {
+
+	Close();
+
+	int fd = open(file.c_str(), O_RDONLY);
+	if ( fd < 0 ) return false;
+
+	struct stat st;
+	if ( fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AllPixFrameFileHeader) ) {
+		close(fd);
+		return false;
+	}
+
+	void * base = mmap(0x0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if ( base == MAP_FAILED ) return false;
+
+	const AllPixFrameFileHeader * h = (const AllPixFrameFileHeader *) base;
+	size_t payload = sizeof(AllPixFrameFileHeader);
+	if ( strncmp(h->magic, ALLPIX_FRAMEFILE_MAGIC, sizeof(h->magic)) == 0
+			&& h->version <= ALLPIX_FRAMEFILE_VERSION && h->nPixels >= 0 && h->metaBytes >= 0 )
+		payload += metaPadded(h->metaBytes) + (size_t)h->nPixels * (sizeof(uint32_t) + sizeof(uint16_t));
+	else payload = (size_t)st.st_size + 1;
+
+	if ( payload > (size_t)st.st_size ) {
+		munmap(base, st.st_size);
+		return false;
+	}
+
+	m_base = base;
+	m_size = st.st_size;
+	m_header = h;
+	m_meta = (const char *) base + sizeof(AllPixFrameFileHeader);
+	m_index = (const uint32_t *) (m_meta + metaPadded(h->metaBytes));
+	m_counts = (const uint16_t *) (m_index + h->nPixels);
+
+	return true;
+}
+
+void AllPixFrameFile::Close() {
+
+	if ( m_base ) munmap(m_base, m_size);
+	m_base = 0x0;
+	m_size = 0;
+	m_header = 0x0;
+	m_meta = 0x0;
+	m_index = 0x0;
+	m_counts = 0x0;
+
+}
+
+bool AllPixFrameFile::Write(const string & file, int32_t width, int32_t height,
+		const vector<uint32_t> & index, const vector<uint16_t> & counts, const string & meta) {
+
+	if ( index.size() != counts.size() ) return false;
+
+	// ascending pixel index
+	vector<size_t> order(index.size());
+	for ( size_t i = 0 ; i < order.size() ; i++ ) order[i] = i;
+	std::sort(order.begin(), order.end(), [&index](size_t a, size_t b) { return index[a] < index[b]; });
+
+	vector<uint32_t> sortedIndex(index.size());
+	vector<uint16_t> sortedCounts(counts.size());
+	for ( size_t i = 0 ; i < order.size() ; i++ ) {
+		sortedIndex[i] = index[order[i]];
+		sortedCounts[i] = counts[order[i]];
+	}
+
+	FILE * f = fopen(file.c_str(), "wb");
+	if ( !f ) return false;
+
+	AllPixFrameFileHeader h;
+	memset(&h, 0, sizeof(h));
+	strncpy(h.magic, ALLPIX_FRAMEFILE_MAGIC, sizeof(h.magic));
+	h.version = ALLPIX_FRAMEFILE_VERSION;
+	h.width = width;
+	h.height = height;
+	h.nPixels = index.size();
+	h.metaBytes = meta.size();
+
+	const char pad[4] = { 0, 0, 0, 0 };
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+	ok = ok && fwrite(meta.data(), 1, meta.size(), f) == meta.size();
+	ok = ok && fwrite(pad, 1, metaPadded(h.metaBytes) - meta.size(), f) == metaPadded(h.metaBytes) - meta.size();
+	if ( h.nPixels > 0 ) {
+		ok = ok && fwrite(&sortedIndex[0], sizeof(uint32_t), h.nPixels, f) == (size_t)h.nPixels;
+		ok = ok && fwrite(&sortedCounts[0], sizeof(uint16_t), h.nPixels, f) == (size_t)h.nPixels;
+	}
+
+	return fclose(f) == 0 && ok;
+}
@@ -5,11 +5,15 @@
 
 #include "AllPixGeoDsc.hh"
 
+#include <cstring>
+
 
 
 AllPixGeoDsc::AllPixGeoDsc(){
 
 	m_efieldfromfile = false;
+	m_efieldmap = 0x0;
+	m_driftTable = false;
 
 }
 
@@ -42,6 +46,78 @@ void AllPixGeoDsc::Dump() {
 
 }
 
+G4bool AllPixGeoDsc::GetRecord(AllPixGeoDscRecord & r){
+
+	memset(&r, 0, sizeof(r));
+
+	if(m_digitizer.size() >= sizeof(r.digitizer)) return false;
+	strncpy(r.digitizer, m_digitizer.c_str(), sizeof(r.digitizer));
+
+	r.id = m_ID;
+	r.npix[0] = m_npix_x; r.npix[1] = m_npix_y; r.npix[2] = m_npix_z;
+	r.mipTot = m_MIP_Tot;
+	r.counterDepth = m_Counter_Depth;
+	r.pixsize[0] = m_pixsize_x; r.pixsize[1] = m_pixsize_y; r.pixsize[2] = m_pixsize_z;
+	r.chip_h[0] = m_chip_hx; r.chip_h[1] = m_chip_hy; r.chip_h[2] = m_chip_hz;
+	r.chip_pos[0] = m_chip_posx; r.chip_pos[1] = m_chip_posy; r.chip_pos[2] = m_chip_posz;
+	r.chip_offset[0] = m_chip_offsetx; r.chip_offset[1] = m_chip_offsety; r.chip_offset[2] = m_chip_offsetz;
+	r.sensor_h[0] = m_sensor_hx; r.sensor_h[1] = m_sensor_hy; r.sensor_h[2] = m_sensor_hz;
+	r.sensor_pos[0] = m_sensor_posx; r.sensor_pos[1] = m_sensor_posy; r.sensor_pos[2] = m_sensor_posz;
+	r.sensor_gr_excess[0] = m_sensor_gr_excess_htop;
+	r.sensor_gr_excess[1] = m_sensor_gr_excess_hbottom;
+	r.sensor_gr_excess[2] = m_sensor_gr_excess_hright;
+	r.sensor_gr_excess[3] = m_sensor_gr_excess_hleft;
+	r.pcb_h[0] = m_pcb_hx; r.pcb_h[1] = m_pcb_hy; r.pcb_h[2] = m_pcb_hz;
+	r.bump[0] = m_bump_radius;
+	r.bump[1] = m_bump_height;
+	r.bump[2] = m_bump_offsetx;
+	r.bump[3] = m_bump_offsety;
+	r.bump[4] = m_bump_dr;
+	r.resistivity = m_resistivity;
+	r.mipCharge = m_MIP_Charge;
+	r.clockUnit = m_Clock_Unit;
+	r.chipNoise = m_Chip_Noise;
+	r.chipThreshold = m_Chip_Threshold;
+	r.crossTalk = m_Cross_Talk;
+	r.saturationEnergy = m_Saturation_Energy;
+
+	return true;
+}
+
+void AllPixGeoDsc::SetRecord(const AllPixGeoDscRecord & r){
+
+	m_digitizer = G4String(r.digitizer);
+
+	m_ID = r.id;
+	m_npix_x = r.npix[0]; m_npix_y = r.npix[1]; m_npix_z = r.npix[2];
+	m_MIP_Tot = r.mipTot;
+	m_Counter_Depth = r.counterDepth;
+	m_pixsize_x = r.pixsize[0]; m_pixsize_y = r.pixsize[1]; m_pixsize_z = r.pixsize[2];
+	m_chip_hx = r.chip_h[0]; m_chip_hy = r.chip_h[1]; m_chip_hz = r.chip_h[2];
+	m_chip_posx = r.chip_pos[0]; m_chip_posy = r.chip_pos[1]; m_chip_posz = r.chip_pos[2];
+	m_chip_offsetx = r.chip_offset[0]; m_chip_offsety = r.chip_offset[1]; m_chip_offsetz = r.chip_offset[2];
+	m_sensor_hx = r.sensor_h[0]; m_sensor_hy = r.sensor_h[1]; m_sensor_hz = r.sensor_h[2];
+	m_sensor_posx = r.sensor_pos[0]; m_sensor_posy = r.sensor_pos[1]; m_sensor_posz = r.sensor_pos[2];
+	m_sensor_gr_excess_htop = r.sensor_gr_excess[0];
+	m_sensor_gr_excess_hbottom = r.sensor_gr_excess[1];
+	m_sensor_gr_excess_hright = r.sensor_gr_excess[2];
+	m_sensor_gr_excess_hleft = r.sensor_gr_excess[3];
+	m_pcb_hx = r.pcb_h[0]; m_pcb_hy = r.pcb_h[1]; m_pcb_hz = r.pcb_h[2];
+	m_bump_radius = r.bump[0];
+	m_bump_height = r.bump[1];
+	m_bump_offsetx = r.bump[2];
+	m_bump_offsety = r.bump[3];
+	m_bump_dr = r.bump[4];
+	m_resistivity = r.resistivity;
+	m_MIP_Charge = r.mipCharge;
+	m_Clock_Unit = r.clockUnit;
+	m_Chip_Noise = r.chipNoise;
+	m_Chip_Threshold = r.chipThreshold;
+	m_Cross_Talk = r.crossTalk;
+	m_Saturation_Energy = r.saturationEnergy;
+
+}
+
 void AllPixGeoDsc::SetEFieldMap(G4String valS){
 	m_EFieldFile = valS;
 
@@ -49,42 +125,28 @@ void AllPixGeoDsc::SetEFieldMap(G4String valS){
 	struct stat buffer;
 	if(!(stat (valS, &buffer))){
 		
-		m_efieldfromfile = true;
-
-		ifstream efieldinput;
-		efieldinput.open(valS);
-
-		G4int nptsx, nptsy, nptsz;
-		G4int currx, curry, currz;
-
-		G4double ex, ey, ez;
+		// Loaded once per file (text or binary), detectors naming
+		//  the same file share the map.
+		m_efieldmap = AllPixEFieldMap::GetShared(valS);
 
-		efieldinput >> nptsx >> nptsy >> nptsz;
+		if(!m_efieldmap){
+			cout << "Could not read the EField map " << valS << ". Abort." << endl;
+			exit(1);
+		}
 
-		vector<G4ThreeVector> onedim;
-		vector<vector<G4ThreeVector>> twodim;
-		onedim.reserve(nptsx);
-		twodim.reserve(nptsy);
+		m_efieldfromfile = true;
 
-		for (int k = 0; k < nptsz; k++) {
-			for (int j = 0; j < nptsy; j++) {
-				for (int i = 0; i < nptsx; i++) {
-					efieldinput >> currx >> curry >> currz;
-					efieldinput >> ex >> ey >> ez;
-					onedim.push_back(G4ThreeVector(ex, ey, ez));
-				}
-				twodim.push_back(onedim);
-				onedim.clear();
-			}
-			m_efieldmap.push_back(twodim);
-			twodim.clear();
+		if(!m_efieldmap->IsMapped()){
+			cout << "EField map " << valS << " is a text map, convert it with allpix-efield-convert for faster startup" << endl;
 		}
 
-		m_efieldmap_nx = nptsx;
-		m_efieldmap_ny = nptsy;
-		m_efieldmap_nz = nptsz;
-
-		efieldinput.close();
+		// the binary header may know the cell the map was made for
+		if( (m_efieldmap->GetPitch(0) > 0. && fabs(m_efieldmap->GetPitch(0) - GetPixelX()/mm) > 1e-6)
+				|| (m_efieldmap->GetPitch(1) > 0. && fabs(m_efieldmap->GetPitch(1) - GetPixelY()/mm) > 1e-6) ){
+			cout << "[WARNING] EField map " << valS << " was made for a " << m_efieldmap->GetPitch(0)
+					<< " x " << m_efieldmap->GetPitch(1) << " mm cell, detector " << m_ID
+					<< " has " << GetPixelX()/mm << " x " << GetPixelY()/mm << " mm pixels" << endl;
+		}
 
 	}else{
 		if(!valS.isNull())
@@ -100,38 +162,6 @@ void AllPixGeoDsc::SetEFieldMap(G4String valS){
 
 }
 
-inline G4ThreeVector linear(const G4ThreeVector value0, const G4ThreeVector value1, const G4double p){
-
-	G4ThreeVector result;
-
-	for (size_t i = 0; i < 3; i++) {
-		result[i] = (value0[i] + (value1[i] - value0[i])*(p));
-	}
-
-	return result;
-}
-
-inline G4ThreeVector bilinear(const G4ThreeVector* ecube, const G4double x, const G4double y, const G4int z){
-
-	G4ThreeVector result;
-
-	G4ThreeVector bil_y1 = linear(ecube[0+2*0+4*z], ecube[1+2*0+4*z], x);
-  G4ThreeVector bil_y2 = linear(ecube[0+2*1+4*z], ecube[1+2*1+4*z], x);
-
-  return linear(bil_y1, bil_y2, y);
-
-}
-
-inline G4ThreeVector trilinear(const G4ThreeVector* ecube, const G4ThreeVector pos){
-
-	G4ThreeVector bil_z0, bil_z1;
-	bil_z0 = bilinear(ecube, pos[0], pos[1], 0);
-	bil_z1 = bilinear(ecube, pos[0], pos[1], 1);
-
-	return linear(bil_z0, bil_z1, pos[2]);
-
-}
-
 inline int int_floor(const double x)
 {
   int i = (int)x;
@@ -143,51 +173,17 @@ inline double fmod2(const double x, const double y)
 	return x-y*int_floor(x/y);
 }
 
-G4ThreeVector AllPixGeoDsc::GetEFieldFromMap(G4ThreeVector ppos){
-
-	G4ThreeVector currentefield;
-	
-	G4double pixsize_x = GetPixelX();
-	G4double pixsize_y = GetPixelY();
-	G4double pixsize_z = GetPixelZ();
-	
-	// ppos is the position in mm inside one pixel cell
-	
-	ppos = G4ThreeVector(fmod2(ppos[0],pixsize_x), fmod2(ppos[1],pixsize_y), ppos[2]);
-	
-	// Assuming that point 1 and nx are basically at the same position. The "-1" takes account of the efieldmap starting at the iterator 1.
-	// Get the position iside the grid
-
-	G4ThreeVector pposgrid;
-	pposgrid[0] = ppos[0]/pixsize_x*(G4double)(m_efieldmap_nx-1);
-	pposgrid[1] = ppos[1]/pixsize_y*(G4double)(m_efieldmap_ny-1);
-	pposgrid[2] = ppos[2]/pixsize_z*(G4double)(m_efieldmap_nz-1);
-
-	// Got the position in units of the map coordinates. Do a 3D interpolation of the electric field.
-	// Get the eight neighbors and do three linear interpolations.
-
-	G4ThreeVector * ecube = new G4ThreeVector[8];
-
-	for (size_t i = 0; i < 2; i++) {
-		for (size_t j = 0; j < 2; j++) {
-			for (size_t k = 0; k < 2; k++) {
-				ecube[i+2*j+4*k] = m_efieldmap.at(int_floor(pposgrid[2]+k)).at(int_floor(pposgrid[1]+j)).at(int_floor(pposgrid[0]+i));
-			}
-		}
-	}
+G4ThreeVector AllPixGeoDsc::GetEFieldFromMap(const G4ThreeVector & ppos){
 
-	// Make pposgrid the position inside the cube
-
-	for (size_t i = 0; i < 3; i++) {
-		pposgrid[i] -= (double)(int_floor(pposgrid[i]));
-	}
-	
-	currentefield = trilinear(ecube, pposgrid);
-	// Try to just weight the eight edges with the 3D distance to the sampling point.
+	// ppos is the position in mm, the map covers one pixel cell
 
-	delete[] ecube;
+	const G4double pixsize_x = GetPixelX();
+	const G4double pixsize_y = GetPixelY();
+	const G4double pixsize_z = GetPixelZ();
 
-	return currentefield;
+	return m_efieldmap->Interpolate(fmod2(ppos[0], pixsize_x)/pixsize_x,
+			fmod2(ppos[1], pixsize_y)/pixsize_y,
+			ppos[2]/pixsize_z);
 
 }
 
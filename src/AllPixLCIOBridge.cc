@@ -0,0 +1,272 @@
+#include "AllPixLCIOBridge.hh"
+
+#include <cstring>
+#include <iostream>
+
+// output and input buffers
+static const size_t c_bridgeBuffer = 1 << 22;
+
+static int g_lcioBridgeFormat = AllPixLCIOBridgeWriter::kText;
+
+// decimal, no locale, no stream.  Returns the position after the digits
+static char * putInt(char * p, int32_t v) {
+
+	char tmp[12];
+	int n = 0;
+	uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+	do {
+		tmp[n++] = '0' + u%10;
+		u /= 10;
+	} while(u);
+	if(v < 0) *p++ = '-';
+	while(n) *p++ = tmp[--n];
+
+	return p;
+}
+
+bool AllPixLCIOBridgeWriter::SetFormat(const string & format) {
+
+	if(format == "text") g_lcioBridgeFormat = kText;
+	else if(format == "binary") g_lcioBridgeFormat = kBinary;
+	else if(format == "both") g_lcioBridgeFormat = kText | kBinary;
+	else if(format == "none") g_lcioBridgeFormat = kNone;
+	else {
+		cout << "[ERROR] (in AllPixLCIOBridgeWriter::SetFormat) unknown format \"" << format
+				<< "\", use text, binary, both or none" << endl;
+		return false;
+	}
+
+	return true;
+}
+
+int AllPixLCIOBridgeWriter::GetFormat() {
+
+	return g_lcioBridgeFormat;
+
+}
+
+AllPixLCIOBridgeWriter::AllPixLCIOBridgeWriter(const string & name) {
+
+	m_name = name;
+	m_opened = false;
+	m_text = 0x0;
+	m_binary = 0x0;
+	m_textUsed = 0;
+	m_binaryUsed = 0;
+
+}
+
+AllPixLCIOBridgeWriter::~AllPixLCIOBridgeWriter() {
+
+	Close();
+
+}
+
+void AllPixLCIOBridgeWriter::Open() {
+
+	m_opened = true;
+
+	if(g_lcioBridgeFormat & kText) {
+		string file = m_name + ".txt";
+		m_text = fopen(file.c_str(), "w");
+		if(!m_text) cout << "[ERROR] (in AllPixLCIOBridgeWriter::Open) can't open " << file << endl;
+		else m_textBuf.resize(c_bridgeBuffer);
+	}
+
+	if(g_lcioBridgeFormat & kBinary) {
+		string file = m_name + ".bin";
+		m_binary = fopen(file.c_str(), "wb");
+		if(!m_binary) {
+			cout << "[ERROR] (in AllPixLCIOBridgeWriter::Open) can't open " << file << endl;
+			return;
+		}
+		m_binaryBuf.resize(c_bridgeBuffer);
+
+		AllPixLCIOBridgeHeader h;
+		memset(&h, 0, sizeof(h));
+		strncpy(h.magic, ALLPIX_LCIOBRIDGE_MAGIC, sizeof(h.magic));
+		h.version = ALLPIX_LCIOBRIDGE_VERSION;
+		Put(m_binary, m_binaryBuf, m_binaryUsed, (const char *)&h, sizeof(h));
+	}
+
+}
+
+void AllPixLCIOBridgeWriter::Put(FILE * f, vector<char> & buf, size_t & used, const char * data, size_t n) {
+
+	if(used + n > buf.size()) {
+		fwrite(&buf[0], 1, used, f);
+		used = 0;
+		// larger than the whole buffer, straight to the file
+		if(n > buf.size()) {
+			fwrite(data, 1, n, f);
+			return;
+		}
+	}
+	memcpy(&buf[used], data, n);
+	used += n;
+
+}
+
+void AllPixLCIOBridgeWriter::Write(const AllPixLCIOBridgeEvent & ev) {
+
+	if(!m_opened) Open();
+
+	if(m_text) {
+		// longest piece: 3 ints and separators
+		char line[64];
+		char * p = line;
+		*p++ = 'R'; *p++ = ' ';
+		p = putInt(p, ev.frameId);
+		*p++ = '\n';
+		Put(m_text, m_textBuf, m_textUsed, line, p - line);
+
+		for(size_t i = 0 ; i < ev.planes.size() ; i++) {
+			const AllPixLCIOBridgePlane & plane = ev.planes[i];
+			p = putInt(line, plane.detId);
+			*p++ = ' ';
+			Put(m_text, m_textBuf, m_textUsed, line, p - line);
+			for(size_t j = 0 ; j + 2 < plane.pixels.size() ; j += 3) {
+				p = line;
+				p = putInt(p, plane.pixels[j]); *p++ = ' ';
+				p = putInt(p, plane.pixels[j+1]); *p++ = ' ';
+				p = putInt(p, plane.pixels[j+2]); *p++ = ' ';
+				Put(m_text, m_textBuf, m_textUsed, line, p - line);
+			}
+			Put(m_text, m_textBuf, m_textUsed, "\n", 1);
+		}
+	}
+
+	if(m_binary) {
+		int32_t rec[4];
+		rec[0] = 2*sizeof(int32_t);
+		rec[1] = ALLPIX_LCIOBRIDGE_RUN;
+		rec[2] = ev.frameId;
+		Put(m_binary, m_binaryBuf, m_binaryUsed, (const char *)rec, 3*sizeof(int32_t));
+
+		for(size_t i = 0 ; i < ev.planes.size() ; i++) {
+			const AllPixLCIOBridgePlane & plane = ev.planes[i];
+			int32_t nPixels = plane.pixels.size()/3;
+			rec[0] = (3 + 3*nPixels)*sizeof(int32_t);
+			rec[1] = ALLPIX_LCIOBRIDGE_PLANE;
+			rec[2] = plane.detId;
+			rec[3] = nPixels;
+			Put(m_binary, m_binaryBuf, m_binaryUsed, (const char *)rec, 4*sizeof(int32_t));
+			if(nPixels > 0)
+				Put(m_binary, m_binaryBuf, m_binaryUsed, (const char *)&plane.pixels[0], 3*nPixels*sizeof(int32_t));
+		}
+	}
+
+}
+
+void AllPixLCIOBridgeWriter::Close() {
+
+	// files exist even without events, as before
+	if(!m_opened) Open();
+
+	if(m_text) {
+		if(m_textUsed) fwrite(&m_textBuf[0], 1, m_textUsed, m_text);
+		fclose(m_text);
+		m_text = 0x0;
+		m_textUsed = 0;
+	}
+
+	if(m_binary) {
+		if(m_binaryUsed) fwrite(&m_binaryBuf[0], 1, m_binaryUsed, m_binary);
+		fclose(m_binary);
+		m_binary = 0x0;
+		m_binaryUsed = 0;
+	}
+
+}
+
+AllPixLCIOBridgeReader::AllPixLCIOBridgeReader() {
+
+	m_file = 0x0;
+	m_type = 0;
+	m_pending = false;
+
+}
+
+AllPixLCIOBridgeReader::~AllPixLCIOBridgeReader() {
+
+	Close();
+
+}
+
+bool AllPixLCIOBridgeReader::Open(const string & file) {
+
+	Close();
+
+	m_file = fopen(file.c_str(), "rb");
+	if(!m_file) return false;
+
+	m_fileBuf.resize(c_bridgeBuffer);
+	setvbuf(m_file, &m_fileBuf[0], _IOFBF, m_fileBuf.size());
+
+	AllPixLCIOBridgeHeader h;
+	if(fread(&h, sizeof(h), 1, m_file) != 1
+			|| strncmp(h.magic, ALLPIX_LCIOBRIDGE_MAGIC, sizeof(h.magic)) != 0
+			|| h.version > ALLPIX_LCIOBRIDGE_VERSION) {
+		cout << "[ERROR] (in AllPixLCIOBridgeReader::Open) " << file << " is not a bridge file of version <= "
+				<< ALLPIX_LCIOBRIDGE_VERSION << endl;
+		Close();
+		return false;
+	}
+
+	m_pending = false;
+
+	return true;
+}
+
+void AllPixLCIOBridgeReader::Close() {
+
+	if(m_file) fclose(m_file);
+	m_file = 0x0;
+
+}
+
+bool AllPixLCIOBridgeReader::ReadRecord() {
+
+	if(!m_file) return false;
+
+	int32_t head[2];
+	if(fread(head, sizeof(int32_t), 2, m_file) != 2) return false;
+	if(head[0] < (int32_t)sizeof(int32_t)) return false;
+
+	size_t bytes = head[0] - sizeof(int32_t);
+	m_type = head[1];
+	m_payload.resize((bytes + sizeof(int32_t) - 1)/sizeof(int32_t));
+	if(bytes > 0 && fread(&m_payload[0], 1, bytes, m_file) != bytes) return false;
+
+	return true;
+}
+
+bool AllPixLCIOBridgeReader::Next(AllPixLCIOBridgeEvent & ev) {
+
+	// the run record starting the event, may have been read ahead
+	while(true) {
+		if(!m_pending && !ReadRecord()) return false;
+		m_pending = false;
+		if(m_type == ALLPIX_LCIOBRIDGE_RUN && !m_payload.empty()) break;
+	}
+
+	ev.Clear(m_payload[0]);
+
+	while(ReadRecord()) {
+
+		if(m_type == ALLPIX_LCIOBRIDGE_RUN) {
+			m_pending = true;
+			break;
+		}
+
+		if(m_type == ALLPIX_LCIOBRIDGE_PLANE && m_payload.size() >= 2) {
+			int32_t nPixels = m_payload[1];
+			if(nPixels < 0 || m_payload.size() < 2 + 3*(size_t)nPixels) return false;
+			ev.AddPlane(m_payload[0]);
+			ev.planes.back().pixels.assign(m_payload.begin() + 2, m_payload.begin() + 2 + 3*nPixels);
+		}
+
+	}
+
+	return true;
+}
@@ -47,7 +47,7 @@ void AllPixMedipix2Digitizer::Digitize(){
 	hitsCollection = (AllPixTrackerHitsCollection*)(digiMan->GetHitsCollection(hcID));
 
 	// temporary data structure
-	map<pair<G4int, G4int>, G4double > pixelsContent;
+	AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator();
 	pair<G4int, G4int> tempPixel;
 
 	G4int nEntries = hitsCollection->entries();
@@ -67,7 +67,7 @@ void AllPixMedipix2Digitizer::Digitize(){
 
 	// Now create digits, one per pixel
 	// Second entry in the map is the energy deposit in the pixel
-	map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+	AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
 
 	// NOTE that there is a nice interface which provides useful info for hits.
 	// For instance, the following member gives you the position of a hit with respect
@@ -108,7 +108,7 @@ void AllPixMimosa26Digitizer::Digitize(){
 	hitsCollection = (AllPixTrackerHitsCollection*)(digiMan->GetHitsCollection(hcID));
 
 	// temporary data structure
-	map<pair<G4int, G4int>, G4double > pixelsContent;
+	AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator();
 	pair<G4int, G4int> tempPixel;
 
 	G4int nEntries = hitsCollection->entries();
@@ -460,7 +460,7 @@ void AllPixMimosa26Digitizer::Digitize(){
 
 
 	// now create digits, one per pixel // second entry in the map is the edep in the pixel
-	map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+	AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
 
 	for( ; pCItr != pixelsContent.end() ; pCItr++)
 	{
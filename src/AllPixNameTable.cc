@@ -0,0 +1,21 @@
+#include "AllPixNameTable.hh"
+
+AllPixNameTable * AllPixNameTable::GetInstance(){
+
+	static G4ThreadLocal AllPixNameTable * instance = 0x0;
+	if ( !instance ) instance = new AllPixNameTable;
+
+	return instance;
+}
+
+G4int AllPixNameTable::GetId(const G4String & name){
+
+	map<G4String, G4int>::iterator itr = m_ids.find(name);
+	if ( itr != m_ids.end() ) return (*itr).second;
+
+	G4int id = (G4int)m_names.size();
+	m_names.push_back(name);
+	m_ids[name] = id;
+
+	return id;
+}
@@ -0,0 +1,183 @@
+#include "AllPixOutputQueue.hh"
+
+#include <chrono>
+#include <iostream>
+
+#include "TROOT.h"
+#include "RVersion.h"
+
+typedef std::chrono::steady_clock outputClock;
+
+static double secondsSince(const outputClock::time_point & t0) {
+	return std::chrono::duration<double>(outputClock::now() - t0).count();
+}
+
+AllPixOutputQueue * AllPixOutputQueue::GetInstance() {
+
+	static AllPixOutputQueue instance;
+	return &instance;
+
+}
+
+AllPixOutputQueue::AllPixOutputQueue() {
+
+	m_depth = 0;
+	m_running = false;
+	m_stop = false;
+	m_busy = false;
+	m_pushed = 0;
+	m_written = 0;
+	m_stalls = 0;
+	m_depthSum = 0.;
+	m_maxDepth = 0;
+	m_stallTime = 0.;
+	m_writeTime = 0.;
+
+}
+
+AllPixOutputQueue::~AllPixOutputQueue() {
+
+	Stop();
+
+}
+
+void AllPixOutputQueue::Start(int depth) {
+
+	// a new depth restarts the writer
+	Stop();
+
+	if(depth <= 0) {
+		std::cout << "Output : synchronous" << std::endl;
+		return;
+	}
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+	ROOT::EnableThreadSafety();
+#endif
+
+	m_depth = depth;
+	m_stop = false;
+	m_running = true;
+	m_writer = std::thread(&AllPixOutputQueue::Loop, this);
+
+	std::cout << "Output : writer thread, queue depth " << m_depth << std::endl;
+
+}
+
+void AllPixOutputQueue::Stop() {
+
+	if(!m_running) return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_notEmpty.notify_one();
+	m_writer.join();
+
+	m_running = false;
+
+}
+
+void AllPixOutputQueue::Push(const Job & job) {
+
+	if(!m_running) {
+		std::lock_guard<std::mutex> io(m_ioMutex);
+		job();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pushed++;
+		m_written++;
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_pushed++;
+
+	// back-pressure, the writer is behind
+	if(m_jobs.size() >= m_depth) {
+		m_stalls++;
+		outputClock::time_point t0 = outputClock::now();
+		m_notFull.wait(lock, [this]{ return m_jobs.size() < m_depth; });
+		m_stallTime += secondsSince(t0);
+	}
+
+	m_jobs.push_back(job);
+	m_depthSum += m_jobs.size();
+	if(m_jobs.size() > m_maxDepth) m_maxDepth = m_jobs.size();
+
+	lock.unlock();
+	m_notEmpty.notify_one();
+
+}
+
+void AllPixOutputQueue::Drain() {
+
+	if(!m_running) return;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this]{ return m_jobs.empty() && !m_busy; });
+
+}
+
+void AllPixOutputQueue::Loop() {
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(true) {
+
+		m_notEmpty.wait(lock, [this]{ return !m_jobs.empty() || m_stop; });
+		if(m_jobs.empty()) break; // stopping and nothing left
+
+		Job job = m_jobs.front();
+		m_jobs.pop_front();
+		m_busy = true;
+		lock.unlock();
+		m_notFull.notify_one();
+
+		outputClock::time_point t0 = outputClock::now();
+		{
+			std::lock_guard<std::mutex> io(m_ioMutex);
+			job();
+		}
+		double dt = secondsSince(t0);
+
+		lock.lock();
+		m_busy = false;
+		m_written++;
+		m_writeTime += dt;
+		if(m_jobs.empty()) m_idle.notify_all();
+	}
+
+	m_idle.notify_all();
+
+}
+
+void AllPixOutputQueue::PrintStats(std::ostream & os) {
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	os << "Output : " << m_pushed << " records in, " << m_written << " written";
+	if(!m_running) {
+		os << " (synchronous)" << std::endl;
+		return;
+	}
+	os << ", " << m_jobs.size() << " queued"
+	   << ", queue depth mean " << (m_pushed > 0 ? m_depthSum/m_pushed : 0.)
+	   << " max " << m_maxDepth << "/" << m_depth
+	   << ", producer waited " << m_stalls << " time(s) " << m_stallTime << " s"
+	   << ", writer busy " << m_writeTime << " s" << std::endl;
+
+}
+
+void AllPixOutputQueue::ResetStats() {
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pushed = 0;
+	m_written = 0;
+	m_stalls = 0;
+	m_depthSum = 0.;
+	m_maxDepth = 0;
+	m_stallTime = 0.;
+	m_writeTime = 0.;
+
+}
@@ -0,0 +1,95 @@
+#include "AllPixOutputSettings.hh"
+
+#include <TFile.h>
+#include <TTree.h>
+#include <RVersion.h>
+
+#include <iostream>
+
+AllPixOutputSettings * AllPixOutputSettings::GetInstance() {
+
+	static AllPixOutputSettings instance;
+	return &instance;
+
+}
+
+AllPixOutputSettings::AllPixOutputSettings() {
+
+	m_compression = -1;
+	m_basketSize = 0;
+	m_autoFlush = 0;
+
+}
+
+/**
+ *  ROOT algorithm codes: 1 zlib, 2 lzma, 4 lz4, 5 zstd.  Default
+ *  levels as ROOT's kDefaultZLIB/LZMA/LZ4/ZSTD.
+ */
+bool AllPixOutputSettings::SetCompression(TString algorithm, int level) {
+
+	algorithm.ToLower();
+
+	int alg = 0;
+	int defLevel = 0;
+	if(algorithm == "default") {
+		if(level < 0) {
+			m_compression = -1;
+			return true;
+		}
+	}
+	else if(algorithm == "zlib") { alg = 1; defLevel = 1; }
+	else if(algorithm == "lzma") { alg = 2; defLevel = 7; }
+	else if(algorithm == "lz4")  { alg = 4; defLevel = 4; }
+	else if(algorithm == "zstd") { alg = 5; defLevel = 5; }
+	else {
+		std::cout << "[ERROR] (in AllPixOutputSettings::SetCompression) unknown algorithm \"" << algorithm
+				<< "\", use default, zlib, lzma, lz4 or zstd" << std::endl;
+		return false;
+	}
+
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,20,0)
+	if(alg == 5) {
+		std::cout << "[ERROR] (in AllPixOutputSettings::SetCompression) zstd needs ROOT >= 6.20" << std::endl;
+		return false;
+	}
+#endif
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,8,0)
+	if(alg == 4) {
+		std::cout << "[ERROR] (in AllPixOutputSettings::SetCompression) lz4 needs ROOT >= 6.08" << std::endl;
+		return false;
+	}
+#endif
+
+	if(level < 0) level = defLevel;
+	if(level > 9) level = 9;
+
+	// level 0 is no compression whatever the algorithm
+	m_compression = 100*alg + level;
+
+	return true;
+}
+
+void AllPixOutputSettings::ApplyTo(TFile * f) {
+
+	if(m_compression >= 0) f->SetCompressionSettings(m_compression);
+
+}
+
+void AllPixOutputSettings::ApplyTo(TTree * t) {
+
+	if(m_basketSize > 0) t->SetBasketSize("*", m_basketSize);
+	if(m_autoFlush != 0) t->SetAutoFlush(m_autoFlush);
+
+}
+
+void AllPixOutputSettings::PrintSummary(TTree * t, TString fileName, std::ostream & os) {
+
+	Long64_t tot = t->GetTotBytes();
+	Long64_t zip = t->GetZipBytes();
+
+	os << "Tree " << t->GetName() << " (" << fileName << ") : " << t->GetEntries() << " entries, "
+	   << tot << " bytes uncompressed, " << zip << " bytes compressed";
+	if(zip > 0) os << ", ratio " << (Double_t)tot/zip;
+	os << std::endl;
+
+}
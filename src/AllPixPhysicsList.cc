@@ -42,6 +42,7 @@
 
 #include "AllPixPhysicsList.hh"
 #include "AllPixPhysicsListMessenger.hh"
+#include "AllPixPhysicsTables.hh"
 
 #include "G4DecayPhysics.hh"
 #include "G4EmStandardPhysics.hh"
@@ -85,6 +86,7 @@
 
 #include "G4LossTableManager.hh"
 #include "G4StepLimiter.hh"
+#include "G4FastSimulationManagerProcess.hh"
 #include "G4ProcessManager.hh"
 #include "G4ParticleTypes.hh"
 #include "G4ParticleTable.hh"
@@ -110,6 +112,7 @@ AllPixPhysicsList::AllPixPhysicsList() : G4VModularPhysicsList()
   verboseLevel    = 1;
 
   pMessenger = new AllPixPhysicsListMessenger(this);
+  physicsTables = 0x0;
 
   // Particles
   particleList = new G4DecayPhysics("decays");
@@ -123,6 +126,7 @@ AllPixPhysicsList::AllPixPhysicsList() : G4VModularPhysicsList()
 AllPixPhysicsList::~AllPixPhysicsList()
 {
   delete pMessenger;
+  delete physicsTables;
   delete particleList;
   delete emAllPixPhysicsList;
   for(size_t i=0; i<hadronPhys.size(); i++) {
@@ -149,6 +153,7 @@ void AllPixPhysicsList::ConstructProcess()
     hadronPhys[i]->ConstructProcess();
   }
   AddStepMax();
+  AddFastSimulation();
 }
 
 void AllPixPhysicsList::SetVerbose(G4int verbose)
@@ -181,6 +186,48 @@ void AllPixPhysicsList::AddStepMax()
 	}
 }
 
+/**
+ * Hook for the parameterised sensors (/allpix/det/setFastSimulation).
+ * The geometry is built after /run/initialize, the process is always
+ * there and only acts in the regions with a model.
+ */
+void AllPixPhysicsList::AddFastSimulation()
+{
+
+	G4FastSimulationManagerProcess * fastSimProcess = new G4FastSimulationManagerProcess("fastSimProcess_massGeom");
+
+	theParticleIterator->reset();
+
+	while ((*theParticleIterator)()){
+
+		G4ParticleDefinition* particle = theParticleIterator->value();
+		G4ProcessManager* pmanager = particle->GetProcessManager();
+
+		if (particle->GetPDGCharge() != 0.0)
+		{
+			pmanager->AddDiscreteProcess(fastSimProcess);
+		}
+	}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
+
+void AllPixPhysicsList::SetPhysicsTableDir(const G4String& dir)
+{
+  delete physicsTables;
+  physicsTables = new AllPixPhysicsTables(this, dir);
+}
+
+G4String AllPixPhysicsList::GetPhysicsNames() const
+{
+  G4String names = emAllPixPhysicsList->GetPhysicsName();
+  names += " " + particleList->GetPhysicsName();
+  for(size_t i=0; i<hadronPhys.size(); i++) {
+    names += " " + hadronPhys[i]->GetPhysicsName();
+  }
+  return names;
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
 
 void AllPixPhysicsList::AddAllPixPhysicsList(const G4String& name)
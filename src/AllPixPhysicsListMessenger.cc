@@ -109,6 +109,13 @@ AllPixPhysicsListMessenger::AllPixPhysicsListMessenger(AllPixPhysicsList* pPhys)
 	listCmd->SetGuidance("Available Physics Lists");
 	listCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 
+	tableDirCmd = new G4UIcmdWithAString("/allpix/phys/setPhysicsTableDir",this);
+	tableDirCmd->SetGuidance("Keep the physics tables in this directory.  The first job with a given");
+	tableDirCmd->SetGuidance("physics list, cuts and materials builds and stores them, the next ones");
+	tableDirCmd->SetGuidance("retrieve them.  One subdirectory per configuration (hash of those).");
+	tableDirCmd->SetParameterName("dir",false);
+	tableDirCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -123,6 +130,7 @@ AllPixPhysicsListMessenger::~AllPixPhysicsListMessenger()
 	delete allCutCmd;
 	delete pListCmd;
 	delete listCmd;
+	delete tableDirCmd;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -203,6 +211,11 @@ void AllPixPhysicsListMessenger::SetNewValue(G4UIcommand* command, G4String newV
 					<< " /testhadr/ListPhysics UI command is not available "
 					<< "for reference Physics List" << G4endl;
 		}
+
+	} else if( command == tableDirCmd ) {
+		if(pAllPixPhysicsList) {
+			pAllPixPhysicsList->SetPhysicsTableDir(newValue);
+		}
 	}
 }
 
@@ -0,0 +1,235 @@
+#include "AllPixPhysicsTables.hh"
+#include "AllPixPhysicsList.hh"
+
+#include "G4StateManager.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4IonisParamMat.hh"
+#include "G4EmParameters.hh"
+#include "G4Version.hh"
+
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace std;
+
+// written last in <dir>/<hash>, the tables next to it are complete
+static const char * c_infoFile = "allpix-tables.info";
+
+static uint64_t hashString(const string & s) {
+
+	uint64_t h = 14695981039346656037ULL;
+	for(size_t i = 0 ; i < s.size() ; i++) {
+		h ^= (unsigned char)s[i];
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+// mkdir -p
+static G4bool makeDirs(const string & path) {
+
+	for(size_t p = path.find('/', 1) ; ; p = path.find('/', p + 1)) {
+		string d = path.substr(0, p);
+		if(!d.empty() && mkdir(d.c_str(), 0755) != 0 && errno != EEXIST) return false;
+		if(p == string::npos) break;
+	}
+
+	return true;
+}
+
+// rm -r
+static void removeDir(const string & path) {
+
+	DIR * dir = opendir(path.c_str());
+	if(!dir) return;
+
+	struct dirent * entry;
+	while((entry = readdir(dir)) != 0x0) {
+		string name = entry->d_name;
+		if(name == "." || name == "..") continue;
+		string file = path + "/" + name;
+		struct stat st;
+		if(lstat(file.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) removeDir(file);
+		else unlink(file.c_str());
+	}
+	closedir(dir);
+
+	rmdir(path.c_str());
+}
+
+AllPixPhysicsTables::AllPixPhysicsTables(AllPixPhysicsList * physicsList, G4String dir)
+: G4VStateDependent()
+{
+
+	m_physicsList = physicsList;
+	m_dir = dir;
+	m_hash = 0;
+	m_retrieving = false;
+	m_storedBuildTime = 0.;
+	m_done = false;
+	m_initTime = 0.;
+
+}
+
+AllPixPhysicsTables::~AllPixPhysicsTables(){
+
+}
+
+G4bool AllPixPhysicsTables::Notify(G4ApplicationState requestedState){
+
+	if(m_done) return true;
+
+	// the state manager changes its state after asking the dependents
+	G4ApplicationState currentState = G4StateManager::GetStateManager()->GetCurrentState();
+
+	if(currentState == G4State_Idle && requestedState == G4State_Init) {
+		// a run initialization, or a geometry update (no tables then).
+		//  Decided again every time, the last one before the run counts.
+		Prepare();
+		m_initStart = std::chrono::steady_clock::now();
+	} else if(currentState == G4State_Init && requestedState == G4State_Idle) {
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_initStart;
+		m_initTime = elapsed.count();
+	} else if(currentState == G4State_Idle && requestedState == G4State_GeomClosed) {
+		// end of G4RunManagerKernel::RunInitialization, tables built
+		Finish();
+		m_done = true;
+	}
+
+	return true;
+}
+
+/**
+ * Everything the tables depend on.  The materials are all the ones
+ * defined, used or not.
+ */
+uint64_t AllPixPhysicsTables::HashInputs(){
+
+	ostringstream in;
+	in.precision(17);
+
+	in << "geant4 " << G4VERSION_NUMBER << "\n";
+	in << "physics " << m_physicsList->GetPhysicsNames() << "\n";
+
+	// EM options: msc, binning, lowest energies, fluctuations
+	G4EmParameters * em = G4EmParameters::Instance();
+	in << "msc " << em->MscStepLimitType() << " " << em->MscRangeFactor() << " " << em->MscGeomFactor()
+			<< " " << em->MscSkin() << " " << em->MscThetaLimit() << " " << em->LateralDisplacement()
+			<< " " << em->MscMuHadStepLimitType() << " " << em->MscMuHadRangeFactor()
+			<< " " << em->MuHadLateralDisplacement() << "\n";
+	in << "binning " << em->MinKinEnergy() << " " << em->MaxKinEnergy() << " " << em->NumberOfBinsPerDecade()
+			<< " " << em->MaxEnergyForCSDARange() << " " << em->BuildCSDARange() << "\n";
+	in << "lowest " << em->LowestElectronEnergy() << " " << em->LowestMuHadEnergy() << "\n";
+	in << "loss " << em->LossFluctuation() << " " << em->LinearLossLimit() << " " << em->LPM()
+			<< " " << em->ApplyCuts() << " " << em->Fluo() << " " << em->Auger() << " " << em->Pixe() << "\n";
+
+	G4ProductionCutsTable * cutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+	in << "energyRange " << cutsTable->GetLowEdgeEnergy() << " " << cutsTable->GetHighEdgeEnergy() << "\n";
+
+	G4RegionStore * regions = G4RegionStore::GetInstance();
+	for(size_t i = 0 ; i < regions->size() ; i++) {
+		G4Region * region = (*regions)[i];
+		in << "region " << region->GetName();
+		G4ProductionCuts * cuts = region->GetProductionCuts();
+		if(cuts) for(G4int p = 0 ; p < 4 ; p++) in << " " << cuts->GetProductionCut(p);
+		in << "\n";
+	}
+
+	const G4MaterialTable * materials = G4Material::GetMaterialTable();
+	for(size_t i = 0 ; i < materials->size() ; i++) {
+		G4Material * m = (*materials)[i];
+		in << "material " << m->GetName() << " " << m->GetDensity() << " " << m->GetState()
+				<< " " << m->GetTemperature() << " " << m->GetPressure()
+				<< " " << m->GetIonisation()->GetMeanExcitationEnergy();
+		const G4double * fractions = m->GetFractionVector();
+		for(size_t e = 0 ; e < m->GetNumberOfElements() ; e++) {
+			const G4Element * element = m->GetElement(e);
+			in << " " << element->GetZ() << " " << element->GetN() << " " << fractions[e];
+		}
+		in << "\n";
+	}
+
+	return hashString(in.str());
+}
+
+void AllPixPhysicsTables::Prepare(){
+
+	m_hash = HashInputs();
+
+	char hashS[32];
+	snprintf(hashS, sizeof(hashS), "%016llx", (unsigned long long)m_hash);
+	m_tablesDir = m_dir + "/" + hashS;
+
+	// stored and complete ?
+	m_retrieving = false;
+	m_storedBuildTime = 0.;
+	G4String info = m_tablesDir + "/" + c_infoFile;
+	FILE * f = fopen(info.c_str(), "r");
+	if(f) {
+		unsigned long long hash = 0;
+		double buildTime = 0.;
+		if(fscanf(f, "hash %llx buildTime %lf", &hash, &buildTime) == 2 && hash == m_hash) {
+			m_retrieving = true;
+			m_storedBuildTime = buildTime;
+		}
+		fclose(f);
+	}
+
+	if(m_retrieving) m_physicsList->SetPhysicsTableRetrieved(m_tablesDir);
+	else m_physicsList->ResetPhysicsTableRetrieved();
+
+}
+
+void AllPixPhysicsTables::Finish(){
+
+	if(m_retrieving) {
+		if(m_physicsList->IsPhysicsTableRetrieved()) {
+			G4cout << "[INFO] Physics tables retrieved from " << m_tablesDir << " in " << m_initTime
+					<< " s, building them took " << m_storedBuildTime << " s : "
+					<< m_storedBuildTime - m_initTime << " s saved" << G4endl;
+			return;
+		}
+		// Geant4 fell back to building them.  The stored ones stay, other
+		//  jobs may be reading them.
+		G4cout << "[WARNING] Physics tables in " << m_tablesDir << " could not be retrieved,"
+				<< " built in " << m_initTime << " s.  Remove the directory to store them again" << G4endl;
+		return;
+	}
+
+	// Stored in a directory of this job then renamed, a job running
+	//  at the same time with the same configuration doesn't see
+	//  half of them.  The first one there wins.
+	char tmpS[32];
+	snprintf(tmpS, sizeof(tmpS), ".%d", (int)getpid());
+	G4String tmp = m_tablesDir + tmpS;
+
+	G4bool ok = makeDirs(tmp) && m_physicsList->StorePhysicsTable(tmp);
+	if(ok) {
+		G4String info = tmp + "/" + c_infoFile;
+		FILE * f = fopen(info.c_str(), "w");
+		ok = f != 0x0;
+		if(f) {
+			fprintf(f, "hash %016llx\nbuildTime %f\n", (unsigned long long)m_hash, m_initTime);
+			ok = fclose(f) == 0;
+		}
+	}
+
+	if(ok && rename(tmp.c_str(), m_tablesDir.c_str()) == 0) {
+		G4cout << "[INFO] Physics tables built in " << m_initTime << " s, stored in " << m_tablesDir << G4endl;
+	} else {
+		if(!ok) G4cout << "[WARNING] Physics tables could not be stored in " << m_tablesDir << G4endl;
+		removeDir(tmp);
+	}
+
+}
@@ -48,6 +48,7 @@
 #include "G4UIcommand.hh"
 
 #include "G4RunManager.hh"
+#include "G4Run.hh"
 
 #include "CLHEP/Random/RandGauss.h"
 #include "CLHEP/Random/RandPoisson.h"
@@ -72,13 +73,16 @@ AllPixPrimaryGeneratorMessenger::AllPixPrimaryGeneratorMessenger(
 {
   m_hits            = 1;
   m_frames          = 1;
+  m_framesInRunFlag = false;
   m_beamTypeHitFunc = "gauss";
   m_beamTypePar1    = 1.;
   m_beamTypePar2    = 1.;
   m_TimepixTelescopeWriteFlag = false;
+  m_TimepixTelescopeBinaryFlag = false;
   gunDir = new G4UIdirectory("/N06/gun/");
   gunDir->SetGuidance("PrimaryGenerator control");
   m_Write_MC_FilesFlag=false; //nalipour: MC hits
+  m_Write_MC_FillEvery=0;
 
   polarCmd = new G4UIcmdWithADoubleAndUnit("/N06/gun/optPhotonPolar",this);
   polarCmd->SetGuidance("Set linear polarization");
@@ -105,6 +109,17 @@ AllPixPrimaryGeneratorMessenger::AllPixPrimaryGeneratorMessenger(
   m_userBeamOnCmd = new G4UIcmdWithoutParameter("/allpix/beam/on",this);
   m_userBeamOnCmd->SetGuidance("Set beam ON");
   m_userBeamOnCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  // the master drives the runs, workers must not call BeamOn
+  m_userBeamOnCmd->SetToBeBroadcasted(false);
+
+  m_userBeamFramesInRunCmd = new G4UIcmdWithABool("/allpix/beam/framesInRun",this);
+  m_userBeamFramesInRunCmd->SetGuidance("All the frames of /allpix/beam/on in a single run (one BeamOn) instead of one run per frame.");
+  m_userBeamFramesInRunCmd->SetGuidance("The events are assigned to frames with the multiplicity of /allpix/beam/type and each frame");
+  m_userBeamFramesInRunCmd->SetGuidance("is written when its last event is recorded.  Frame Ids are the same as with one run per frame.");
+  m_userBeamFramesInRunCmd->SetGuidance("Sequential mode only, ignored with the multithreaded run manager.  Default OFF.");
+  m_userBeamFramesInRunCmd->SetParameterName("framesInRun", true);
+  m_userBeamFramesInRunCmd->SetDefaultValue(true);
+  m_userBeamFramesInRunCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
   m_userBeamTypeCmd = new G4UIcommand("/allpix/beam/type",this);
   m_userBeamTypeCmd->SetGuidance("Select hits distribution function.");
@@ -148,6 +163,11 @@ AllPixPrimaryGeneratorMessenger::AllPixPrimaryGeneratorMessenger(
   m_TimepixTelescopeSumTOTCmd->SetDefaultValue(true);
   m_TimepixTelescopeSumTOTCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+  m_TimepixTelescopeBinaryCmd = new G4UIcmdWithABool("/allpix/timepixtelescope/setBinary",this);
+  m_TimepixTelescopeBinaryCmd->SetGuidance("Write .bin files instead of .txt, same content (format in AllPixTelescopeWriter.hh). Default OFF.");
+  m_TimepixTelescopeBinaryCmd->SetDefaultValue(false);
+  m_TimepixTelescopeBinaryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
   //nalipour: MC hits
   m_Write_MC_FilesCmd = new G4UIcmdWithABool("/allpix/WriteROOTFiles/write",this);
   m_Write_MC_FilesCmd->SetGuidance("Switch on/off writing ROOT files containing the MC and the AllPix information. Default OFF.");
@@ -161,6 +181,13 @@ AllPixPrimaryGeneratorMessenger::AllPixPrimaryGeneratorMessenger(
   m_Write_MC_FolderNameCmd->SetDefaultValue("./");
   m_Write_MC_FolderNameCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
+  m_Write_MC_FillEveryCmd = new G4UIcmdWithAnInteger("/allpix/WriteROOTFiles/setFillEvery",this);
+  m_Write_MC_FillEveryCmd->SetGuidance("Write an entry of the ROOT Files every N events, as the run goes.");
+  m_Write_MC_FillEveryCmd->SetGuidance("0 = one entry per run, written at the end of the run (default).");
+  m_Write_MC_FillEveryCmd->SetParameterName("FillEvery", false);
+  m_Write_MC_FillEveryCmd->SetRange("FillEvery>=0");
+  m_Write_MC_FillEveryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -173,6 +200,8 @@ AllPixPrimaryGeneratorMessenger::~AllPixPrimaryGeneratorMessenger()
   delete m_userBeamNumberOfFramesCmd;
   delete m_userBeamOnCmd;
   delete m_userBeamTypeCmd;
+  delete m_userBeamFramesInRunCmd;
+  delete m_Write_MC_FillEveryCmd;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -203,6 +232,11 @@ void AllPixPrimaryGeneratorMessenger::SetNewValue(
       m_frames = m_userBeamNumberOfFramesCmd->GetNewIntValue(newValue);
     }
 
+  if ( command == m_userBeamFramesInRunCmd )
+    {
+      m_framesInRunFlag = m_userBeamFramesInRunCmd->GetNewBoolValue(newValue);
+    }
+
   if ( command == m_userBeamTypeCmd )
     {
       const char* nv = (const char*)newValue;
@@ -219,32 +253,55 @@ void AllPixPrimaryGeneratorMessenger::SetNewValue(
       TFile * f = new TFile("hitFunction.root","recreate");
       TH1I * h = new TH1I("h","h",1000,0,1000);
 
-      for (G4int ii = 0; ii < m_frames; ii++)
+      G4bool framesInRun = m_framesInRunFlag;
+#ifdef ALLPIX_MT
+      if ( framesInRun && runManager->GetRunManagerType() != G4RunManager::sequentialRM )
 	{
-	  if ( m_beamTypeHitFunc == "gauss" )
-	    {
-	      m_hits = CLHEP::RandGauss::shoot(m_beamTypePar1,m_beamTypePar2);
-	    }
-	  else if ( m_beamTypeHitFunc == "poisson" )
-	    {
-	      m_hits = CLHEP::RandPoisson::shoot(m_beamTypePar1);
-	    }
-	  else if ( m_beamTypeHitFunc == "expo" )
+	  G4cout << "[WARNING] /allpix/beam/framesInRun needs the sequential run manager, "
+		 << "running one frame per run" << G4endl;
+	  framesInRun = false;
+	}
+#endif
+
+      if ( framesInRun )
+	{
+	  // Sample every frame up front and shoot them all in one run.
+	  //  Empty frames are skipped, as BeamOn(0) does not make a run.
+	  m_framesInRun.clear();
+	  G4int totalHits = 0;
+	  for (G4int ii = 0; ii < m_frames; ii++)
 	    {
-	      m_hits = CLHEP::RandExponential::shoot(m_beamTypePar1);
+	      m_hits = SampleFrameMultiplicity();
+	      h->Fill(m_hits);
+	      if ( m_hits > 0 )
+		{
+		  m_framesInRun.push_back(m_hits);
+		  totalHits += m_hits;
+		}
 	    }
-	  else if ( m_beamTypeHitFunc == "const")
+
+	  G4cout << "Frames in run : " << m_framesInRun.size() << " frame(s), "
+		 << totalHits << " event(s)" << G4endl;
+
+	  if ( totalHits > 0 )
 	    {
-	      m_hits = m_beamTypePar1;
+	      runManager->BeamOn(totalHits);
+	      // one run Id per frame, the next run starts after the last frame
+	      const G4Run * run = runManager->GetCurrentRun();
+	      if ( run ) runManager->SetRunIDCounter(run->GetRunID() + (G4int)m_framesInRun.size());
 	    }
-	  else
+	  m_framesInRun.clear();
+	}
+      else
+	{
+	  for (G4int ii = 0; ii < m_frames; ii++)
 	    {
-	      G4cout << "============> Unknown parameter: " <<  m_beamTypeHitFunc  << "... sending "<< m_hits << " hit(s)..." << G4endl;
-	    }
+	      m_hits = SampleFrameMultiplicity();
 
-	  // same call as in /run/beamOn
-	  runManager->BeamOn(m_hits);
-	  h->Fill(m_hits);
+	      // same call as in /run/beamOn
+	      runManager->BeamOn(m_hits);
+	      h->Fill(m_hits);
+	    }
 	}
 
       f->Write();
@@ -279,6 +336,11 @@ void AllPixPrimaryGeneratorMessenger::SetNewValue(
       m_TimepixTelescopeSumTOTFlag = m_TimepixTelescopeSumTOTCmd->GetNewBoolValue(newValue);
     }
 
+  if ( command == m_TimepixTelescopeBinaryCmd )
+    {
+      m_TimepixTelescopeBinaryFlag = m_TimepixTelescopeBinaryCmd->GetNewBoolValue(newValue);
+    }
+
 
 
   //nalipour: MC hits
@@ -298,8 +360,40 @@ void AllPixPrimaryGeneratorMessenger::SetNewValue(
 	  system(TString::Format("mkdir -p %s",m_Write_MC_FolderName.data()));
 	}
     }
+  if (command == m_Write_MC_FillEveryCmd)
+    {
+      m_Write_MC_FillEvery = m_Write_MC_FillEveryCmd->GetNewIntValue(newValue);
+    }
   
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4int AllPixPrimaryGeneratorMessenger::SampleFrameMultiplicity()
+{
+  if ( m_beamTypeHitFunc == "gauss" )
+    {
+      m_hits = CLHEP::RandGauss::shoot(m_beamTypePar1,m_beamTypePar2);
+    }
+  else if ( m_beamTypeHitFunc == "poisson" )
+    {
+      m_hits = CLHEP::RandPoisson::shoot(m_beamTypePar1);
+    }
+  else if ( m_beamTypeHitFunc == "expo" )
+    {
+      m_hits = CLHEP::RandExponential::shoot(m_beamTypePar1);
+    }
+  else if ( m_beamTypeHitFunc == "const")
+    {
+      m_hits = m_beamTypePar1;
+    }
+  else
+    {
+      G4cout << "============> Unknown parameter: " <<  m_beamTypeHitFunc  << "... sending "<< m_hits << " hit(s)..." << G4endl;
+    }
+
+  return m_hits;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
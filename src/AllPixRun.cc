@@ -20,11 +20,25 @@
 // geometry
 #include "ReadGeoDescription.hh"
 
+// timepix telescope files
+#include "AllPixTelescopeWriter.hh"
+
+// per event output
+#include "AllPixOutputQueue.hh"
+
 //
 #include "TString.h"
 #include <map>
+#include <memory>
+#include <sstream>
 #include <time.h>
 
+// In MT mode every worker owns an AllPixRun.  Whatever is written per
+//  event (hits ntuples, lcio bridge) is handed to the AllPixOutputQueue,
+//  the workers don't wait for each other.  Frames, telescope and MC ROOT
+//  files are merged into the master's run and written at the end of the
+//  run, single threaded.
+
 
 /**
  * This constructor is called once per run
@@ -34,6 +48,18 @@ AllPixRun::AllPixRun(AllPixDetectorConstruction * det, TString ofp, TString data
   m_writeTPixTelescopeFilesFlag = writeFlag;
   m_writeMCFilesFlag=MCWriteFlag; //nalipour: flag for MC
 
+  // one frame per run unless SetFramesInRun is called
+  m_frameIndex = 0;
+  m_eventsInFrame = 0;
+  m_frameFirstEventId = 0;
+  m_telescopeEventIDflag = false;
+  m_telescopeSumTOTflag = false;
+  m_telescopeBinaryFlag = false;
+  m_telescope = new AllPixTelescopeWriter;
+  m_rootFiles = 0x0;
+  m_rootFillEvery = 0;
+  m_eventsSinceROOTFill = 0;
+
   m_detectorPtr = det;
 
   // Call for an instance to write.  Need to know how
@@ -42,8 +68,7 @@ AllPixRun::AllPixRun(AllPixDetectorConstruction * det, TString ofp, TString data
   // modules have already been created
 
   // Geo description
-  extern ReadGeoDescription * g_GeoDsc; // already loaded ! :)
-  map<int, AllPixGeoDsc *> * geoMap = g_GeoDsc->GetDetectorsMap();
+  map<int, AllPixGeoDsc *> * geoMap = ReadGeoDescription::GetInstance()->GetDetectorsMap();
   map<int, AllPixGeoDsc *>::iterator detItr;
 
   // digit collection info
@@ -157,15 +182,107 @@ AllPixRun::~AllPixRun(){
   }
   delete[] m_storableHits;
 
+  delete m_telescope;
+
+  for (unsigned int i = 0 ; i < MC_ROOT_data.size() ; i++) {
+    delete MC_ROOT_data[i];
+  }
+
+}
+
+void AllPixRun::SetFramesInRun(const vector<G4int> & frameSizes, G4String telescopeFolder,
+			       G4bool eventIDflag, G4bool sumTOTflag, AllPixWriteROOTFile ** rootFiles){
+
+  m_frameSizes = frameSizes;
+  m_frameIndex = 0;
+  m_eventsInFrame = 0;
+  m_frameFirstEventId = 0;
+  m_telescopeFolderName = telescopeFolder;
+  m_telescopeEventIDflag = eventIDflag;
+  m_telescopeSumTOTflag = sumTOTflag;
+  m_rootFiles = rootFiles;
+
+}
+
+/**
+ * Frames within a single run.  Writes the frame being filled, exactly
+ * what AllPixRunAction::EndOfRunAction writes at the end of a run in
+ * the one run per frame mode, and moves on to the next frame.
+ */
+void AllPixRun::FlushFrame(){
+
+  G4int frameId = GetFrameId();
+
+  FillFramesNtuple(frameId);
+
+  if (m_writeTPixTelescopeFilesFlag)
+    FillTelescopeFiles(frameId, m_telescopeFolderName, m_telescopeEventIDflag, m_telescopeSumTOTflag);
+
+  if (m_writeMCFilesFlag && m_rootFiles)
+    FillROOTFiles(m_rootFiles);
+
+  m_frameFirstEventId += m_eventsInFrame;
+  m_eventsInFrame = 0;
+  m_frameIndex++;
+
+}
+
+void AllPixRun::FlushPendingFrame(){
+
+  if (m_eventsInFrame > 0) {
+    G4cout << "[WARNING] run ended within frame " << GetFrameId()
+	   << " after " << m_eventsInFrame << " event(s), writing it" << G4endl;
+    FlushFrame();
+  }
+
 }
 
 
+/**
+ * MT mode.  Called on the master's run once per worker run, at the end
+ * of the run, before AllPixRunAction::EndOfRunAction.  Both runs were
+ * built from the same geometry so the detector indexing matches.
+ */
+void AllPixRun::Merge(const G4Run * aRun){
+
+  const AllPixRun * localRun = static_cast<const AllPixRun *>(aRun);
+
+  // frames
+  for(G4int i = 0 ; i < m_nOfDetectors ; i++)
+    {
+      m_frames[i]->Merge(localRun->m_frames[i]);
+    }
+
+  // telescope digits.  Events from different workers are appended
+  m_telescope->Merge(localRun->m_telescope);
+
+  // MC ROOT data
+  for (unsigned int i = 0 ; i < MC_ROOT_data.size() && i < localRun->MC_ROOT_data.size() ; i++)
+    {
+      MC_ROOT_data[i]->Merge(localRun->MC_ROOT_data[i]);
+    }
+
+  G4Run::Merge(aRun);
+
+}
+
 void AllPixRun::FillROOTFiles(AllPixWriteROOTFile** rootFiles) //nalipour
 {  
+  // streaming: nothing left since the last entry (end of run, or
+  //  of a frame)
+  if (m_rootFillEvery > 0)
+    {
+      G4bool empty = true;
+      for (uint itr=0; itr<MC_ROOT_data.size(); ++itr)
+	empty = empty && MC_ROOT_data[itr]->IsEmpty();
+      if (empty) return;
+    }
+
   for (uint itr=0; itr<MC_ROOT_data.size(); ++itr)
     {
-	  (rootFiles[itr])->SetVectors(MC_ROOT_data[itr]);
-	  (rootFiles[itr])->AllPixWriteROOTFillTree();
+	  // takes the contents, MC_ROOT_data[itr] is left empty for the
+	  //  next events
+	  (rootFiles[itr])->AllPixWriteROOTFillTree(MC_ROOT_data[itr]);
 	  /*
       (rootFiles[itr])->posX_MC=MC_ROOT_data[itr]->get_posX_MC();
       (rootFiles[itr])->posY_MC=MC_ROOT_data[itr]->get_posY_MC();
@@ -178,7 +295,13 @@ void AllPixRun::FillROOTFiles(AllPixWriteROOTFile** rootFiles) //nalipour
       (rootFiles[itr])->AllPixWriteROOTFillTree();
       */
     }
-  MC_ROOT_data.clear();
+}
+
+void AllPixRun::SetROOTFiles(AllPixWriteROOTFile ** rootFiles, G4int fillEvery)
+{
+  m_rootFiles = rootFiles;
+  m_rootFillEvery = fillEvery;
+  m_eventsSinceROOTFill = 0;
 }
 /*
 //nalipour
@@ -292,6 +415,12 @@ void AllPixRun::RecordDigits_all(const G4Event* evt) // Fill Data with charge sh
 
 void AllPixRun::FillFramesNtuple(const G4Run* aRun){
 
+  FillFramesNtuple(aRun->GetRunID());
+
+}
+
+void AllPixRun::FillFramesNtuple(G4int frameId){
+
   /*
   // geo description
   extern ReadGeoDescription * g_GeoDsc; // already loaded ! :)
@@ -315,7 +444,7 @@ void AllPixRun::FillFramesNtuple(const G4Run* aRun){
     {
 
       // fill one frame, set ID first
-      m_frames[i]->SetCurrentFrameId(aRun->GetRunID());
+      m_frames[i]->SetCurrentFrameId(frameId);
       m_frames[i]->SetAsMCData(); // <--- !! MC data !!
 
       //cout << " AllPixRun::FillFramesNtuple " << m_frames[i]->GetDetectorId() << endl;
@@ -330,154 +459,17 @@ void AllPixRun::FillFramesNtuple(const G4Run* aRun){
 
 void AllPixRun::FillTelescopeFiles(const G4Run* aRun, G4String folderName, G4bool eventIDflag, G4bool sumTOTflag){
 
-  /*
-   * FILE FORMAT (header on a signle line)
-   *
-   * # Start time (string) : Sep 22 21:27:06.913 2012 # Start time : 1348342026.913 # Acq time : 0.000000
-   * # ChipboardID : C10-W0108 # DACs : 5 100 255 127 127 0 405 7 130 128 80 62 128 128 # Mpx type : 3
-   * # Timepix clock : 40 # Eventnr 305 # RelaxD 2 devs 4 TPX DAQ = 0x110402 = START_HW STOP_HW MPX_PAR_READ COMPRESS=1
-   * <x> \t <y> \t <sumTOT> \t eventID
-   *
-   */
-
-  runID = aRun->GetRunID();
-
-  m_runTime = 1351163373; // reference time for Run 0: Thu Oct 25 10:09:33 2012 UTC
-
-  time_t seconds;
-  time(&seconds);
-
-  struct tm * ptm;
-  //ptm = gmtime(&m_runTime);
-  ptm = gmtime(&seconds);
-  ptm->tm_sec += runID; // increment by runID*seconds
-  time_t newtime = mktime(ptm);
-  //string tmp = ctime(&newtime);
-  //string s_newtime = tmp.substr(0,tmp.size()-6); // remove newline character
-
-  // format date to fit the filename requirements
-  char filedate[80];
-  strftime(filedate,sizeof(filedate),"%y%m%d-%H%M%S",gmtime(&newtime));
-
-  char date[80];
-  strftime(date,sizeof(date),"%b %d %H:%M:%S.000 %Y",gmtime(&newtime));
-
-  // open Timepix Telescope output file for this run
-  TString filename = TString::Format("%s/mpx-%s-0_%i.txt",folderName.data(),filedate,runID);
-  
-  G4cout << "Path to file: " << filename << G4endl;
-  ofstream tpixtelescope_f(filename);
+  FillTelescopeFiles(aRun->GetRunID(), folderName, eventIDflag, sumTOTflag);
 
-  // loop on data from this run, map filled by RecordTelescopeDigits
-  map<int,vector<vector<vector<int> > > >::iterator itr;
-  for (itr = m_data.begin(); itr != m_data.end(); itr++)
-    {
-      // for each telescope plane
-      int detId = itr->first;
-
-      // header line for each plane
-      tpixtelescope_f << "# Start time (string) : " << date
-		      << " # Start time : " << seconds+runID << ".000"
-		      << " # Acq time : 0.000000 # ChipboardID : Chip_" << detId
-		      << " # DACs : 5 100 255 127 127 0 405 7 130 128 80 62 128 128 # Mpx type : 3 # Timepix clock : 40 "
-		      << " # Eventnr " << runID
-		      << " # RelaxD 2 devs 4 TPX DAQ = 0x110402 = START_HW STOP_HW MPX_PAR_READ COMPRESS=1"
-		      << endl;
-
-      // maps to store multiple hits per pixel
-      map<int,int> map_xyTOT;
-      map<int,vector<int> > map_xyEvent;
-
-      // loop on events
-      vector<vector<vector<int> > > v_events = itr->second;
-      for ( unsigned int i=0; i<v_events.size(); i++ )
-	{
-	  // loop on digits for this event
-	  vector<vector<int> > v_digits = v_events[i];
-	  for ( unsigned int j=0; j<v_digits.size(); j++ )
-	    {
-	      vector<int> v_data = v_digits[j];
-	      int x    = v_data[0];
-	      int y    = v_data[1];
-	      int tot  = v_data[2];
-	      int evID = v_data[3];
-
-	      /*
-	       * sumTOTflag set by /allpix/timepixtelescope/setSumTOT messenger
-	       * in AllpixPrimaryGeneratorMesseneger
-	       * if true, fill maps in order to sum up digits in same pixel
-	       *
-	       */
-	      if ( sumTOTflag )
-		{
-		  map_xyTOT[x*1000+y] += tot;
-		  map_xyEvent[x*1000+y].push_back(evID);
-		}
-	      else
-		{
-		  /*
-		   * eventIDflag set by /allpix/timepixtelescope/setEventIDcolumn messenger
-		   * if true, dump event number column
-		   *
-		   */
-		  if ( eventIDflag )
-		    {
-		      tpixtelescope_f << x << "\t" << y << "\t" << tot << "\t" << evID << endl;
-		    }
-		  else
-		    {
-		      tpixtelescope_f << x << "\t" << y << "\t" << tot << endl;
-		    }
-		}
-	    }
-	}
+}
 
-      if ( sumTOTflag )
-	{
-	  // loop on maps in order to sum up digits in same pixels
-	  map<int,int>::iterator map_itr;
-	  for (map_itr = map_xyTOT.begin(); map_itr != map_xyTOT.end(); map_itr++)
-	    {
-	      int index = map_itr->first;
-	      div_t division = div(index,1000);
-	      int x = division.quot; // pixel x coordinate
-	      int y = division.rem;  // pixel y coordinate
-	      int tot = map_itr->second;
-
-	      /*
-	       * if more than on digit for a given pixel, evID is set to -1
-	       * else print eventID
-	       *
-	       */
-	      int evID = 0;
-	      if (map_xyEvent[index].size() > 1)
-		{
-		  evID = -1;
-		}
-	      else
-		{
-		  evID = map_xyEvent[index][0];
-		}
-
-	      // dump info in text file
-	      if(tot>=0) //nalipour not to write negative TOT 
-		{
-		  if ( eventIDflag )
-		    {
-		      tpixtelescope_f << x << "\t" << y << "\t" << tot << "\t" << evID << endl;
-		    }
-		  else
-		    {
-		      tpixtelescope_f << x << "\t" << y << "\t" << tot << endl;
-		    }
-		}
-	    }
-	}
-    }
+void AllPixRun::FillTelescopeFiles(G4int frameId, G4String folderName, G4bool eventIDflag, G4bool sumTOTflag){
+
+  runID = frameId;
+
+  // file format in AllPixTelescopeWriter.hh.  Rewinds for the next frame
+  m_telescope->Write(folderName, frameId, eventIDflag, sumTOTflag, m_telescopeBinaryFlag);
 
-  // clear map and close file for next run
-  m_data.clear();
-  tpixtelescope_f.close();
 }
 
 /**
@@ -497,10 +489,42 @@ void AllPixRun::RecordEvent(const G4Event* evt) {
 	  RecordDigits_all(evt);
       //RecordHitsForROOTFiles(evt);
       //RecordHitsForROOTFiles_withChargeSharing(evt);
+
+      // streaming: one RD53 entry every m_rootFillEvery events
+      if (m_rootFillEvery > 0 && m_rootFiles && ++m_eventsSinceROOTFill >= m_rootFillEvery)
+	{
+	  FillROOTFiles(m_rootFiles);
+	  m_eventsSinceROOTFill = 0;
+	}
+    }
+
+  // frames within a single run: write the frame once complete
+  if ( IsFramesInRun() && m_frameIndex < (G4int)m_frameSizes.size() )
+    {
+      m_eventsInFrame++;
+      if ( m_eventsInFrame == m_frameSizes[m_frameIndex] )
+	FlushFrame();
     }
 
 }
 
+/**
+ *  Columns format: AllPixNameTable id (of this thread) to the code of
+ *  the name in a hits file.  One array per file and per thread, the
+ *  name is handed to the file the first time this thread sees it,
+ *  0xffff until then.
+ */
+static UShort_t hitsCode(vector<UShort_t> & codes, G4int id, Hits_WriteToNtuple * hitsFile, bool volume) {
+
+  if ( id >= (G4int)codes.size() ) codes.resize(id + 1, 0xffff);
+  if ( codes[id] == 0xffff ) {
+    const G4String & name = AllPixNameTable::GetInstance()->GetName(id);
+    codes[id] = volume ? hitsFile->GetVolumeCode(name) : hitsFile->GetProcessCode(name);
+  }
+
+  return codes[id];
+}
+
 void AllPixRun::RecordHits(const G4Event* evt) {
 
   // will need it later
@@ -518,10 +542,33 @@ void AllPixRun::RecordHits(const G4Event* evt) {
 
   G4int nHC = HCe->GetNumberOfCollections();
 
+  // columns format, codes of the process and volume names per hits
+  //  file, see hitsCode.  The files (one per hits collection) are kept
+  //  for the whole job.
+  const bool columnar = Hits_WriteToNtuple::IsColumnar();
+  static G4ThreadLocal vector<vector<UShort_t> > * processCodes = 0x0;
+  static G4ThreadLocal vector<vector<UShort_t> > * volumeCodes = 0x0;
+  if ( !processCodes ) {
+    processCodes = new vector<vector<UShort_t> >;
+    volumeCodes = new vector<vector<UShort_t> >;
+  }
+  if ( (G4int)processCodes->size() < nHC ) {
+    processCodes->resize(nHC);
+    volumeCodes->resize(nHC);
+  }
+
   for (G4int itrCol = 0 ; itrCol < nHC ; itrCol++) {
     // get a hit in the Collection directly
     m_hitsCollection = dynamic_cast<AllPixTrackerHitsCollection *> (HCe->GetHC(itrCol));
 
+    m_datasetHits = SDman->GetHCtable()->GetHCname(itrCol);
+    Hits_WriteToNtuple * hitsFile = Hits_WriteToNtuple::GetInstance(m_outputFilePrefix, m_datasetHits,
+								    m_tempdir,
+								    nHC, // here is the number of Hit Collections (SD), not detectors.
+								    itrCol);
+    vector<UShort_t> & processCode = (*processCodes)[itrCol];
+    vector<UShort_t> & volumeCode = (*volumeCodes)[itrCol];
+
     G4int NbHits = m_hitsCollection->entries();
     //G4cout << "Recording hits : " << NbHits <<  G4endl;
 
@@ -531,6 +578,17 @@ void AllPixRun::RecordHits(const G4Event* evt) {
     G4ThreeVector posTemp;
     TVector3 posTempStorable;
 
+    // columns selected with /allpix/config/setHitsColumns, the others
+    //  are left empty
+    const bool doProcess      = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColProcess);
+    const bool doPos          = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColPos);
+    const bool doPdg          = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColPdg);
+    const bool doEdep         = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColEdep);
+    const bool doTrack        = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColTrack);
+    const bool doParent       = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColParent);
+    const bool doTrackVolume  = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColTrackVolume);
+    const bool doParentVolume = Hits_WriteToNtuple::HasColumn(Hits_WriteToNtuple::kColParentVolume);
+
     for (G4int i = 0 ; i < NbHits ; i++) {
 
       //(*m_hitsCollection)[i]->Print();
@@ -539,68 +597,85 @@ void AllPixRun::RecordHits(const G4Event* evt) {
       m_storableHits[itrCol]->edepTotal += ((*m_hitsCollection)[i]->GetEdep())/keV;
 
       // Interaction name.  VECTOR
-      m_storableHits[itrCol]->interactions.push_back(
-						     ((*m_hitsCollection)[i]->GetProcessName()).data()
-						     );
+      if ( doProcess && columnar )
+	m_storableHits[itrCol]->processCode.push_back(
+						      hitsCode(processCode, (*m_hitsCollection)[i]->GetProcessId(), hitsFile, false)
+						      );
+      else if ( doProcess )
+	m_storableHits[itrCol]->interactions.push_back(
+						       ((*m_hitsCollection)[i]->GetProcessName()).data()
+						       );
 
       // Translate pos to storable format.  VECTOR
-      posTemp = (*m_hitsCollection)[i]->GetPos();
-      posTempStorable.SetXYZ( posTemp.x(), posTemp.y(), posTemp.z() );
-      m_storableHits[itrCol]->pos.push_back(
-					    posTempStorable
-					    );
+      if ( doPos ) {
+	posTemp = (*m_hitsCollection)[i]->GetPos();
+	posTempStorable.SetXYZ( posTemp.x(), posTemp.y(), posTemp.z() );
+	m_storableHits[itrCol]->pos.push_back(
+					      posTempStorable
+					      );
+      }
 
       //if(m_hitsCollection->GetName().contains("scint")) {
       //	G4cout << "--> " << m_hitsCollection->GetName() << " : posx = " << posTemp.x()/mm << " [mm]" << G4endl;
       //}
 
       // pdgId of parent particle
-      m_storableHits[itrCol]->pdgId.push_back(
-					      (*m_hitsCollection)[i]->GetTrackPdgId()
-					      );
+      if ( doPdg )
+	m_storableHits[itrCol]->pdgId.push_back(
+						(*m_hitsCollection)[i]->GetTrackPdgId()
+						);
 
       // energy dep per hit
-      m_storableHits[itrCol]->edep.push_back(
-					     ((*m_hitsCollection)[i]->GetEdep())/keV
-					     );
+      if ( doEdep )
+	m_storableHits[itrCol]->edep.push_back(
+					       ((*m_hitsCollection)[i]->GetEdep())/keV
+					       );
 
       // particle Id
-      m_storableHits[itrCol]->trackId.push_back(
-						(*m_hitsCollection)[i]->GetTrackID()
-						);
+      if ( doTrack )
+	m_storableHits[itrCol]->trackId.push_back(
+						  (*m_hitsCollection)[i]->GetTrackID()
+						  );
 
       // parent Id
-      m_storableHits[itrCol]->parentId.push_back(
-						 (*m_hitsCollection)[i]->GetParentID()
-						 );
+      if ( doParent )
+	m_storableHits[itrCol]->parentId.push_back(
+						   (*m_hitsCollection)[i]->GetParentID()
+						   );
 
       // Name of volume for this hit
-      m_storableHits[itrCol]->trackVolumeName.push_back(
-							(*m_hitsCollection)[i]->GetTrackVolumeName()
-							);
+      if ( doTrackVolume && columnar )
+	m_storableHits[itrCol]->trackVolumeCode.push_back(
+							  hitsCode(volumeCode, (*m_hitsCollection)[i]->GetTrackVolumeId(), hitsFile, true)
+							  );
+      else if ( doTrackVolume )
+	m_storableHits[itrCol]->trackVolumeName.push_back(
+							  (*m_hitsCollection)[i]->GetTrackVolumeName()
+							  );
 
       // Name of volume where particle was created
-      m_storableHits[itrCol]->parentVolumeName.push_back(
-							 (*m_hitsCollection)[i]->GetParentVolumeName()
-							 );
+      if ( doParentVolume && columnar )
+	m_storableHits[itrCol]->parentVolumeCode.push_back(
+							   hitsCode(volumeCode, (*m_hitsCollection)[i]->GetParentVolumeId(), hitsFile, true)
+							   );
+      else if ( doParentVolume )
+	m_storableHits[itrCol]->parentVolumeName.push_back(
+							   (*m_hitsCollection)[i]->GetParentVolumeName()
+							   );
     }
 
     // event id
     m_storableHits[itrCol]->event = evt->GetEventID();
 
     // run id
-    m_storableHits[itrCol]->run = GetRunID();
+    m_storableHits[itrCol]->run = GetFrameId();
 
     /** It is guaranteed by SD::ProcessHits that the hits contain
      *  energy deposit.  Thus we store every hit collection.
      */
 
     // fillVars rewinds values
-    m_datasetHits = SDman->GetHCtable()->GetHCname(itrCol);
-    Hits_WriteToNtuple::GetInstance(m_outputFilePrefix, m_datasetHits,
-				    m_tempdir,
-				    nHC, // here is the number of Hit Collections (SD), not detectors.
-				    itrCol)->fillVars(m_storableHits[itrCol]);
+    hitsFile->fillVars(m_storableHits[itrCol]);
 
   }
 }
@@ -667,10 +742,13 @@ void AllPixRun::RecordDigits(const G4Event* evt){
     exit(1);
   }
 
-  // lcio bridge
+  // lcio bridge.  Built in m_lcioEvent/m_lcioDutEvent and handed to
+  //  the output queue at the end, in MT mode all workers share the same files.
+  G4bool lciobridge = AllPixLCIOBridgeWriter::GetFormat() != AllPixLCIOBridgeWriter::kNone;
+
   // runId
-  *m_lciobridge_f << "R " << GetRunID() << endl;
-  *m_lciobridge_dut_f << "R " << GetRunID() << endl;
+  m_lcioEvent.Clear(GetFrameId());
+  m_lcioDutEvent.Clear(GetFrameId());
 
   /*
   // check event for information about the track
@@ -727,8 +805,8 @@ void AllPixRun::RecordDigits(const G4Event* evt){
 
     // lcio bridge
     // FIXME !
-    if(detId >= 300) *m_lciobridge_f << detId << " ";
-    if(detId < 300) *m_lciobridge_dut_f << detId << " ";
+    AllPixLCIOBridgeEvent & lcioEvent = detId >= 300 ? m_lcioEvent : m_lcioDutEvent;
+    if(lciobridge) lcioEvent.AddPlane(detId);
 
     for (G4int itr  = 0 ; itr < nDigits ; itr++) {
 
@@ -748,25 +826,28 @@ void AllPixRun::RecordDigits(const G4Event* evt){
 							     );
 
       // lcio bridge
-      // FIXME !
-      if (detId >= 300) {
-	*m_lciobridge_f << (*digitsCollection)[itr]->GetPixelIDX() << " "
-			<< (*digitsCollection)[itr]->GetPixelIDY() << " "
-			<< (*digitsCollection)[itr]->GetPixelCounts() << " ";
-      } else {
-	*m_lciobridge_dut_f << (*digitsCollection)[itr]->GetPixelIDX() << " "
-			    << (*digitsCollection)[itr]->GetPixelIDY() << " "
-			    << (*digitsCollection)[itr]->GetPixelCounts() << " ";
+      if (lciobridge) {
+	lcioEvent.AddPixel((*digitsCollection)[itr]->GetPixelIDX(),
+			   (*digitsCollection)[itr]->GetPixelIDY(),
+			   (*digitsCollection)[itr]->GetPixelCounts());
       }
     }
-
-    //if(detId >= 300 and nDigits == 0) *m_lciobridge_f << '*';
-
-    // lcio bridge
-    // FIXME !
-    if(detId >= 300) *m_lciobridge_f << endl;
-    if(detId < 300) *m_lciobridge_dut_f << endl;
   }
+
+  if(!lciobridge) return;
+
+  // the job owns the events, m_lcioEvent/m_lcioDutEvent are cleared
+  //  by the next one
+  std::shared_ptr<AllPixLCIOBridgeEvent> ev(new AllPixLCIOBridgeEvent);
+  std::shared_ptr<AllPixLCIOBridgeEvent> evDut(new AllPixLCIOBridgeEvent);
+  std::swap(*ev, m_lcioEvent);
+  std::swap(*evDut, m_lcioDutEvent);
+  AllPixLCIOBridgeWriter * f = m_lciobridge_f;
+  AllPixLCIOBridgeWriter * fDut = m_lciobridge_dut_f;
+  AllPixOutputQueue::GetInstance()->Push([f, fDut, ev, evDut]{
+      f->Write(*ev);
+      fDut->Write(*evDut);
+    });
 }
 
 void AllPixRun::RecordTelescopeDigits(const G4Event* evt){
@@ -778,7 +859,8 @@ void AllPixRun::RecordTelescopeDigits(const G4Event* evt){
     return;
   }
 
-  G4int eventID = evt->GetEventID();
+  // event number within the frame
+  G4int eventID = evt->GetEventID() - m_frameFirstEventId;
   //G4cout << "============================================================================> Event ID: " << eventID << G4endl;
 
   G4int nDC = DCe->GetNumberOfCollections();
@@ -807,7 +889,8 @@ void AllPixRun::RecordTelescopeDigits(const G4Event* evt){
     theIndex_S.Remove(0,6); // remove BoxSD_
     int detId = atoi(theIndex_S.Data());
 
-    vector<vector<int> > v_det;
+    // the plane gets its header even without digits
+    m_telescope->AddPlane(detId);
 
     for (G4int itr  = 0 ; itr < nDigits ; itr++) {
 
@@ -816,21 +899,11 @@ void AllPixRun::RecordTelescopeDigits(const G4Event* evt){
       int tot = (*digitsCollection)[itr]->GetPixelCounts();
       //int tot = (*digitsCollection)[itr]->GetPixelEnergyDep();
 
-      // store x,y,tot,eventID in vector
-      vector<int> v_digit;
-      v_digit.push_back(x);
-      v_digit.push_back(y);
-      v_digit.push_back(tot);
-      v_digit.push_back(eventID);
-
-      // append to vector for keeping
-      v_det.push_back(v_digit);
+      // streamed to the plane's scratch file, x,y,tot,eventID
+      m_telescope->Add(detId, x, y, tot, eventID);
 
     }
 
-    // append to detector vector
-    m_data[detId].push_back(v_det);
-
   }
 
 }
@@ -44,15 +44,20 @@
 #include "AllPix_Frames_WriteToEntuple.h"
 #include "allpix_dm.h"
 #include "AllPixPrimaryGeneratorMessenger.hh"
+#include "AllPixOutputQueue.hh"
 
 #include <vector>
 #include <string>
 using namespace std;
 
+// master's RD53 files (AllPixRunAction::writeROOTFile), for the workers
+static AllPixWriteROOTFile ** g_writeROOTFile = 0x0;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-// this constructor is called only once in the whole program
-AllPixRunAction::AllPixRunAction(AllPixDetectorConstruction * det, TString ds, TString td, TString lciofn, TString lciofn_dut)
+// this constructor is called once in the whole program, or once per
+//  thread (plus the master) in MT mode.
+AllPixRunAction::AllPixRunAction(AllPixDetectorConstruction * det, TString ds, TString td, AllPixLCIOBridgeWriter * lcio_f, AllPixLCIOBridgeWriter * lcio_dut_f)
 {
 
   m_detectorPtr = det;
@@ -62,8 +67,8 @@ AllPixRunAction::AllPixRunAction(AllPixDetectorConstruction * det, TString ds, T
   timer = new G4Timer;
 
   // file for lcio format conversion
-  m_lciobridge_f = new ofstream(lciofn);
-  m_lciobridge_dut_f = new ofstream(lciofn_dut);
+  m_lciobridge_f = lcio_f;
+  m_lciobridge_dut_f = lcio_dut_f;
 
   //nalipour: Initilise the ROOT files with the NULL pointer
   writeROOTFile=NULL; 
@@ -75,9 +80,6 @@ AllPixRunAction::AllPixRunAction(AllPixDetectorConstruction * det, TString ds, T
 AllPixRunAction::~AllPixRunAction()
 {
 
-  m_lciobridge_f->close();
-  m_lciobridge_dut_f->close();
-
   delete timer;
 }
 
@@ -93,11 +95,12 @@ G4Run * AllPixRunAction::GenerateRun(){
   m_AllPixRun = new AllPixRun(m_detectorPtr, m_detectorPtr->GetOutputFilePrefix(),
 			      m_dataset, m_tempdir, m_writeTPixTelescopeFilesFlag, m_writeMCROOTFilesFlag); // keep this pointer //nalipour: Add the flag for the ROOT files
   m_AllPixRun->SetLCIOBridgeFileDsc(m_lciobridge_f, m_lciobridge_dut_f);
+  m_AllPixRun->SetTelescopeBinary(AllPixMessenger->GetTimepixTelescopeBinaryFlag());
 
-  if(m_writeMCROOTFilesFlag && writeROOTFile==NULL) //nalipour: Initialise the ROOT files (once in the whole program)
+  // The ROOT files are only written by the master (or the only) thread
+  if(m_writeMCROOTFilesFlag && writeROOTFile==NULL && IsMaster()) //nalipour: Initialise the ROOT files (once in the whole program)
     {
-      extern ReadGeoDescription * g_GeoDsc; // already loaded ! :)
-      map<int, AllPixGeoDsc *> * geoMap = g_GeoDsc->GetDetectorsMap();
+      map<int, AllPixGeoDsc *> * geoMap = ReadGeoDescription::GetInstance()->GetDetectorsMap();
       map<int, AllPixGeoDsc *>::iterator detItr;
 	  
       writeROOTFile=new AllPixWriteROOTFile* [(int)geoMap->size()];
@@ -107,6 +110,26 @@ G4Run * AllPixRunAction::GenerateRun(){
 	  writeROOTFile[m_AllPixRun->return_detIdToIndex((*detItr).first)]=new AllPixWriteROOTFile((*detItr).first, AllPixMessenger->GetWrite_MC_FolderName());
 	}
     }
+
+  // RD53 files, created by the master, shared with the worker
+  //  runs when streaming (/allpix/WriteROOTFiles/setFillEvery)
+  if(IsMaster()) g_writeROOTFile = writeROOTFile;
+  if(m_writeMCROOTFilesFlag)
+    {
+      m_AllPixRun->SetROOTFiles(g_writeROOTFile, AllPixMessenger->GetWrite_MC_FillEvery());
+    }
+
+  // /allpix/beam/framesInRun: the frames are written by the run itself
+  //  as they complete (sequential mode only, see the messenger)
+  const vector<G4int> & framesInRun = AllPixMessenger->GetFramesInRun();
+  if ( !framesInRun.empty() && IsMaster() )
+    {
+      m_AllPixRun->SetFramesInRun(framesInRun,
+				  AllPixMessenger->GetTimepixTelescopeFolderName(),
+				  AllPixMessenger->GetTimepixTelescopeDoEventFlag(),
+				  AllPixMessenger->GetTimepixTelescopeSumTOTFlag(),
+				  writeROOTFile);
+    }
   
   return m_AllPixRun;
 }
@@ -124,6 +147,38 @@ void AllPixRunAction::BeginOfRunAction(const G4Run* aRun)
 void AllPixRunAction::EndOfRunAction(const G4Run* aRun)
 {   
 
+  // In MT mode the workers' runs are merged into the master's AllPixRun
+  //  (AllPixRun::Merge) before this is called on the master.  Output is
+  //  written from there only.
+  if(!IsMaster()) {
+    timer->Stop();
+    G4cout << "worker events = " << aRun->GetNumberOfEvent()
+	   << " " << *timer << G4endl;
+    return;
+  }
+
+  // frames within the run have been written as they completed
+  if(m_AllPixRun->IsFramesInRun()) {
+    m_AllPixRun->FlushPendingFrame();
+  } else {
+    FillRunOutput(aRun);
+  }
+
+  // writer queue summary.  Not drained here, the writing of this run
+  //  goes on while the next one is simulated.
+  AllPixOutputQueue * outputQueue = AllPixOutputQueue::GetInstance();
+  outputQueue->PrintStats(G4cout);
+  outputQueue->ResetStats();
+
+  timer->Stop();
+  G4cout << "event Id = " << aRun->GetNumberOfEvent()
+	 << " " << *timer << G4endl;
+
+}
+
+void AllPixRunAction::FillRunOutput(const G4Run* aRun)
+{
+
   // at the end of the run
   G4cout << "Filling frames ntuple" << G4endl;
   m_AllPixRun->FillFramesNtuple(aRun);
@@ -147,9 +202,6 @@ void AllPixRunAction::EndOfRunAction(const G4Run* aRun)
     {
       m_AllPixRun->FillROOTFiles(writeROOTFile);
     }
-  timer->Stop();
-  G4cout << "event Id = " << aRun->GetNumberOfEvent()
-	 << " " << *timer << G4endl;
 
 }
 
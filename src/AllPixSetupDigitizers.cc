@@ -25,14 +25,21 @@
 // geometry
 #include "ReadGeoDescription.hh"
 
+#include "G4AutoLock.hh"
+
+namespace {
+	// SetupDigitizers runs in every worker thread in MT mode
+	//  and they all share the geometry description
+	G4Mutex setupDigitizersMutex = G4MUTEX_INITIALIZER;
+}
+
 void AllPixEventAction::SetupDigitizers(){
 
 	// Digit manager
 	G4DigiManager * fDM = G4DigiManager::GetDMpointer();
 
 	// geo description
-	extern ReadGeoDescription * g_GeoDsc; // already loaded ! :)
-	map<int, AllPixGeoDsc *> * geoMap = g_GeoDsc->GetDetectorsMap();
+	map<int, AllPixGeoDsc *> * geoMap = ReadGeoDescription::GetInstance()->GetDetectorsMap(); // already loaded ! :)
 
 	// I need as many digitizer as detectors.
 	// I decide that through the hitCollections
@@ -85,7 +92,10 @@ void AllPixEventAction::SetupDigitizers(){
 		}
 
 		// Load the name of the collection
-		(*geoMap)[detectorId]->SetDigitCollectionName(digitizerModName);
+		{
+			G4AutoLock l(&setupDigitizersMutex);
+			(*geoMap)[detectorId]->SetDigitCollectionName(digitizerModName);
+		}
 
 		// first check if this digitizer module is already there
 		vector<G4String>::iterator it;
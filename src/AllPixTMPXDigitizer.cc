@@ -12,6 +12,7 @@
 #include "G4DigiManager.hh"
 #include "G4VDigitizerModule.hh"
 #include "AllPixGeoDsc.hh"
+#include "AllPixErf.hh"
 
 #include "TMath.h"
 #include "TF1.h"
@@ -61,7 +62,7 @@ void AllPixTMPXDigitizer::Digitize()
 
   // temporary data structure
   map<pair<G4int, G4int>, MC_content> pixelsContent_MC; //contains information with only MC
-  map<pair<G4int, G4int>, G4double > pixelsContent; //contains information with charge sharing
+  AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator(); //contains information with charge sharing
   pair<G4int, G4int> tempPixel;
   G4int nEntries = hitsCollection->entries();
 
@@ -213,7 +214,7 @@ void AllPixTMPXDigitizer::Digitize()
 
   //------------------ RECORD DIGITS ------------------//
   // With charge sharing
-  map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+  AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
   for( ; pCItr != pixelsContent.end() ; pCItr++)
     {
       // Double_t threshold=CLHEP::RandGauss::shoot(m_digitIn.thl, 35); // ~35 electrons noise on the threshold
@@ -271,8 +272,6 @@ void AllPixTMPXDigitizer::Digitize()
 
  G4double AllPixTMPXDigitizer::IntegrateGaussian(G4double xhit,G4double yhit,G4double Sigma, G4double x1, G4double x2, G4double y1, G4double y2, G4double Energy)
  {
-   G4double Integral=(-TMath::Erf((x1-xhit)/(TMath::Sqrt(2.)*Sigma))+TMath::Erf((x2-xhit)/(TMath::Sqrt(2.)*Sigma)))*(-TMath::Erf((y1-yhit)/(TMath::Sqrt(2.)*Sigma))+TMath::Erf((y2-yhit)/(TMath::Sqrt(2.0)*Sigma)));
-
-   G4double energybis=Integral*Energy/4.0; //*(TMath::Pi())*(TMath::Pi());
-   return energybis;
+   // AllPixErf.hh
+   return AllPixGaussianBoxIntegral(xhit, yhit, Sigma, x1, x2, y1, y2, Energy);
 }
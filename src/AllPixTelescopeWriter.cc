@@ -0,0 +1,377 @@
+#include "AllPixTelescopeWriter.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+
+#include "TString.h"
+
+// scratch file buffer, records read back per block, output buffer
+static const size_t c_scratchBuffer = 1 << 20;
+static const size_t c_blockRecords = 1 << 14;
+static const size_t c_outBuffer = 1 << 20;
+
+static const G4int c_recordWidth = 4; // x, y, tot, eventID
+
+// decimal, no locale, no stream.  Returns the position after the digits
+static char * putInt(char * p, G4int v) {
+
+	char tmp[12];
+	int n = 0;
+	unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+	do {
+		tmp[n++] = '0' + u%10;
+		u /= 10;
+	} while(u);
+	if(v < 0) *p++ = '-';
+	while(n) *p++ = tmp[--n];
+
+	return p;
+}
+
+static unsigned int hashKey(G4int key) {
+	unsigned int h = (unsigned int)key;
+	h ^= h >> 16;
+	h *= 0x45d9f3b;
+	h ^= h >> 16;
+	return h;
+}
+
+AllPixTelescopeWriter::AllPixTelescopeWriter() {
+
+	m_sumEntries = 0;
+	m_block.resize(c_blockRecords*c_recordWidth);
+	m_out.resize(c_outBuffer);
+
+}
+
+AllPixTelescopeWriter::~AllPixTelescopeWriter() {
+
+	map<G4int, Plane>::iterator itr = m_planes.begin();
+	for( ; itr != m_planes.end() ; itr++) {
+		if(itr->second.scratch) fclose(itr->second.scratch);
+	}
+
+}
+
+AllPixTelescopeWriter::Plane & AllPixTelescopeWriter::GetPlane(G4int detId) {
+
+	map<G4int, Plane>::iterator itr = m_planes.find(detId);
+	if(itr != m_planes.end()) {
+		itr->second.active = true;
+		return itr->second;
+	}
+
+	Plane p;
+	p.scratch = tmpfile();
+	if(!p.scratch) {
+		G4cout << "[ERROR] (in AllPixTelescopeWriter::GetPlane) can't create a scratch file for detector "
+				<< detId << " ... Giving up." << G4endl;
+		exit(1);
+	}
+	setvbuf(p.scratch, 0x0, _IOFBF, c_scratchBuffer);
+	p.nRecords = 0;
+	p.active = true;
+
+	return m_planes[detId] = p;
+}
+
+void AllPixTelescopeWriter::AddPlane(G4int detId) {
+
+	GetPlane(detId);
+
+}
+
+void AllPixTelescopeWriter::Add(G4int detId, G4int x, G4int y, G4int tot, G4int eventID) {
+
+	Plane & p = GetPlane(detId);
+
+	G4int rec[c_recordWidth] = { x, y, tot, eventID };
+	fwrite(rec, sizeof(G4int), c_recordWidth, p.scratch);
+	p.nRecords++;
+
+}
+
+void AllPixTelescopeWriter::Merge(AllPixTelescopeWriter * other) {
+
+	map<G4int, Plane>::iterator itr = other->m_planes.begin();
+	for( ; itr != other->m_planes.end() ; itr++) {
+
+		if(!itr->second.active) continue;
+
+		Plane & from = itr->second;
+		Plane & to = GetPlane(itr->first);
+
+		fflush(from.scratch);
+		fseek(from.scratch, 0, SEEK_SET);
+		long left = from.nRecords;
+		while(left > 0) {
+			size_t n = left < (long)c_blockRecords ? left : c_blockRecords;
+			n = fread(&m_block[0], sizeof(G4int)*c_recordWidth, n, from.scratch);
+			if(n == 0) break;
+			fwrite(&m_block[0], sizeof(G4int)*c_recordWidth, n, to.scratch);
+			to.nRecords += n;
+			left -= n;
+		}
+		fseek(from.scratch, 0, SEEK_SET);
+
+	}
+
+}
+
+void AllPixTelescopeWriter::Rewind() {
+
+	map<G4int, Plane>::iterator itr = m_planes.begin();
+	for( ; itr != m_planes.end() ; itr++) {
+		fseek(itr->second.scratch, 0, SEEK_SET);
+		itr->second.nRecords = 0;
+		itr->second.active = false;
+	}
+
+}
+
+/**
+ *  Sum the TOT per pixel of a plane into m_sorted, ordered by pixel key
+ *  (x*1000+y) as the file has always been.  Pixels with a negative
+ *  total are dropped.
+ */
+void AllPixTelescopeWriter::SumPlane(Plane & p) {
+
+	// power of two, at most half full
+	size_t capacity = 1024;
+	while(capacity < 2*(size_t)p.nRecords) capacity <<= 1;
+	if(m_sum.size() != capacity) m_sum.resize(capacity);
+	for(size_t i = 0 ; i < capacity ; i++) m_sum[i].key = -1;
+	m_sumEntries = 0;
+	size_t mask = capacity - 1;
+
+	fflush(p.scratch);
+	fseek(p.scratch, 0, SEEK_SET);
+	long left = p.nRecords;
+	while(left > 0) {
+		size_t n = left < (long)c_blockRecords ? left : c_blockRecords;
+		n = fread(&m_block[0], sizeof(G4int)*c_recordWidth, n, p.scratch);
+		if(n == 0) break;
+		left -= n;
+
+		for(size_t i = 0 ; i < n ; i++) {
+			const G4int * rec = &m_block[i*c_recordWidth];
+			G4int key = rec[0]*1000 + rec[1];
+			size_t slot = hashKey(key) & mask;
+			while(m_sum[slot].key != -1 && m_sum[slot].key != key) slot = (slot + 1) & mask;
+			PixelSum & s = m_sum[slot];
+			if(s.key == -1) {
+				s.key = key;
+				s.tot = 0;
+				s.eventID = rec[3];
+				s.nDigits = 0;
+				m_sumEntries++;
+			}
+			s.tot += rec[2];
+			s.nDigits++;
+		}
+	}
+
+	m_sorted.clear();
+	m_sorted.reserve(m_sumEntries);
+	for(size_t i = 0 ; i < capacity ; i++) {
+		if(m_sum[i].key != -1 && m_sum[i].tot >= 0) m_sorted.push_back(m_sum[i]);
+	}
+	std::sort(m_sorted.begin(), m_sorted.end(),
+			[](const PixelSum & a, const PixelSum & b) { return a.key < b.key; });
+
+}
+
+void AllPixTelescopeWriter::WritePlaneText(FILE * f, Plane & p, G4bool eventIDflag, G4bool sumTOTflag) {
+
+	// longest line: 4 ints and separators
+	const size_t lineMax = 4*12;
+	char * out = &m_out[0];
+	char * end = out + m_out.size() - lineMax;
+	char * pos = out;
+
+	if(sumTOTflag) {
+
+		SumPlane(p);
+		for(size_t i = 0 ; i < m_sorted.size() ; i++) {
+			div_t division = div(m_sorted[i].key, 1000);
+			pos = putInt(pos, division.quot); *pos++ = '\t';
+			pos = putInt(pos, division.rem); *pos++ = '\t';
+			pos = putInt(pos, m_sorted[i].tot);
+			if(eventIDflag) {
+				*pos++ = '\t';
+				// more than one digit in the pixel: no event Id
+				pos = putInt(pos, m_sorted[i].nDigits > 1 ? -1 : m_sorted[i].eventID);
+			}
+			*pos++ = '\n';
+			if(pos >= end) { fwrite(out, 1, pos - out, f); pos = out; }
+		}
+
+	} else {
+
+		fflush(p.scratch);
+		fseek(p.scratch, 0, SEEK_SET);
+		long left = p.nRecords;
+		while(left > 0) {
+			size_t n = left < (long)c_blockRecords ? left : c_blockRecords;
+			n = fread(&m_block[0], sizeof(G4int)*c_recordWidth, n, p.scratch);
+			if(n == 0) break;
+			left -= n;
+
+			for(size_t i = 0 ; i < n ; i++) {
+				const G4int * rec = &m_block[i*c_recordWidth];
+				pos = putInt(pos, rec[0]); *pos++ = '\t';
+				pos = putInt(pos, rec[1]); *pos++ = '\t';
+				pos = putInt(pos, rec[2]);
+				if(eventIDflag) { *pos++ = '\t'; pos = putInt(pos, rec[3]); }
+				*pos++ = '\n';
+				if(pos >= end) { fwrite(out, 1, pos - out, f); pos = out; }
+			}
+		}
+
+	}
+
+	if(pos != out) fwrite(out, 1, pos - out, f);
+
+}
+
+void AllPixTelescopeWriter::WritePlaneBinary(FILE * f, Plane & p, G4bool eventIDflag, G4bool sumTOTflag) {
+
+	G4int width = eventIDflag ? 4 : 3;
+	G4int * out = (G4int *) &m_out[0];
+	size_t outRecords = m_out.size()/(sizeof(G4int)*width);
+	size_t n_out = 0;
+
+	if(sumTOTflag) {
+
+		SumPlane(p);
+		G4int nRecords = m_sorted.size();
+		fwrite(&nRecords, sizeof(G4int), 1, f);
+		for(size_t i = 0 ; i < m_sorted.size() ; i++) {
+			div_t division = div(m_sorted[i].key, 1000);
+			G4int * rec = out + n_out*width;
+			rec[0] = division.quot;
+			rec[1] = division.rem;
+			rec[2] = m_sorted[i].tot;
+			if(eventIDflag) rec[3] = m_sorted[i].nDigits > 1 ? -1 : m_sorted[i].eventID;
+			if(++n_out == outRecords) { fwrite(out, sizeof(G4int)*width, n_out, f); n_out = 0; }
+		}
+
+	} else {
+
+		G4int nRecords = p.nRecords;
+		fwrite(&nRecords, sizeof(G4int), 1, f);
+
+		fflush(p.scratch);
+		fseek(p.scratch, 0, SEEK_SET);
+		long left = p.nRecords;
+		while(left > 0) {
+			size_t n = left < (long)c_blockRecords ? left : c_blockRecords;
+			n = fread(&m_block[0], sizeof(G4int)*c_recordWidth, n, p.scratch);
+			if(n == 0) break;
+			left -= n;
+
+			if(!eventIDflag) {
+				for(size_t i = 0 ; i < n ; i++) {
+					memcpy(out + n_out*width, &m_block[i*c_recordWidth], sizeof(G4int)*width);
+					if(++n_out == outRecords) { fwrite(out, sizeof(G4int)*width, n_out, f); n_out = 0; }
+				}
+			} else {
+				// same layout as the scratch records
+				fwrite(&m_block[0], sizeof(G4int)*c_recordWidth, n, f);
+			}
+		}
+
+	}
+
+	if(n_out) fwrite(out, sizeof(G4int)*width, n_out, f);
+
+}
+
+void AllPixTelescopeWriter::Write(G4String folderName, G4int frameId, G4bool eventIDflag, G4bool sumTOTflag, G4bool binary) {
+
+	/*
+	 * FILE FORMAT (header on a signle line)
+	 *
+	 * # Start time (string) : Sep 22 21:27:06.913 2012 # Start time : 1348342026.913 # Acq time : 0.000000
+	 * # ChipboardID : C10-W0108 # DACs : 5 100 255 127 127 0 405 7 130 128 80 62 128 128 # Mpx type : 3
+	 * # Timepix clock : 40 # Eventnr 305 # RelaxD 2 devs 4 TPX DAQ = 0x110402 = START_HW STOP_HW MPX_PAR_READ COMPRESS=1
+	 * <x> \t <y> \t <sumTOT> \t eventID
+	 *
+	 */
+
+	time_t seconds;
+	time(&seconds);
+
+	struct tm * ptm;
+	ptm = gmtime(&seconds);
+	ptm->tm_sec += frameId; // increment by frameId*seconds
+	time_t newtime = mktime(ptm);
+
+	// format date to fit the filename requirements
+	char filedate[80];
+	strftime(filedate,sizeof(filedate),"%y%m%d-%H%M%S",gmtime(&newtime));
+
+	char date[80];
+	strftime(date,sizeof(date),"%b %d %H:%M:%S.000 %Y",gmtime(&newtime));
+
+	// open Timepix Telescope output file for this frame
+	TString filename = TString::Format("%s/mpx-%s-0_%i.%s",folderName.data(),filedate,frameId, binary ? "bin" : "txt");
+
+	G4cout << "Path to file: " << filename << G4endl;
+	FILE * f = fopen(filename.Data(), binary ? "wb" : "w");
+	if(!f) {
+		G4cout << "[ERROR] (in AllPixTelescopeWriter::Write) can't open " << filename << G4endl;
+		Rewind();
+		return;
+	}
+	setvbuf(f, 0x0, _IOFBF, c_outBuffer);
+
+	if(binary) {
+		G4int nPlanes = 0;
+		map<G4int, Plane>::iterator itr = m_planes.begin();
+		for( ; itr != m_planes.end() ; itr++) if(itr->second.active) nPlanes++;
+
+		G4int version = 1;
+		long long startTime = (long long)seconds + frameId;
+		G4int flags = (eventIDflag ? 1 : 0) | (sumTOTflag ? 2 : 0);
+		fwrite("ATPX", 1, 4, f);
+		fwrite(&version, sizeof(G4int), 1, f);
+		fwrite(&frameId, sizeof(G4int), 1, f);
+		fwrite(&startTime, sizeof(long long), 1, f);
+		fwrite(&flags, sizeof(G4int), 1, f);
+		fwrite(&nPlanes, sizeof(G4int), 1, f);
+	}
+
+	// planes in detector Id order
+	map<G4int, Plane>::iterator itr = m_planes.begin();
+	for( ; itr != m_planes.end() ; itr++) {
+
+		if(!itr->second.active) continue;
+		G4int detId = itr->first;
+
+		if(binary) {
+			fwrite(&detId, sizeof(G4int), 1, f);
+			WritePlaneBinary(f, itr->second, eventIDflag, sumTOTflag);
+			continue;
+		}
+
+		// header line for each plane
+		fprintf(f, "# Start time (string) : %s # Start time : %lld.000"
+				" # Acq time : 0.000000 # ChipboardID : Chip_%d"
+				" # DACs : 5 100 255 127 127 0 405 7 130 128 80 62 128 128 # Mpx type : 3 # Timepix clock : 40 "
+				" # Eventnr %d"
+				" # RelaxD 2 devs 4 TPX DAQ = 0x110402 = START_HW STOP_HW MPX_PAR_READ COMPRESS=1\n",
+				date, (long long)seconds + frameId, detId, frameId);
+
+		WritePlaneText(f, itr->second, eventIDflag, sumTOTflag);
+
+	}
+
+	fclose(f);
+
+	// next frame
+	Rewind();
+
+}
@@ -12,6 +12,7 @@
 #include "G4DigiManager.hh"
 #include "G4VDigitizerModule.hh"
 #include "AllPixGeoDsc.hh"
+#include "AllPixErf.hh"
 
 #include "TMath.h"
 #include "TF1.h"
@@ -28,18 +29,6 @@ AllPixTimepixDigitizer::AllPixTimepixDigitizer(G4String modName, G4String hitsCo
 	
 	doFastErf= true;
 
-	if(doFastErf){
-	ifstream erfFile("share/Erf.dat");
-
-	while(!erfFile.eof()){
-
-		G4double XT,YT;
-		erfFile >> XT >> YT;
-		ErrorFunction[XT]=YT;
-	}
-	erfFile.close();
-	}
-
 //	for(G4double i= -4 ; i< 4 ; i+=0.01){
 //		cout << "ERF Test " << i << " " << MyErf(i) << endl;
 //	}
@@ -130,13 +119,16 @@ AllPixTimepixDigitizer::AllPixTimepixDigitizer(G4String modName, G4String hitsCo
 
 
 	//for(double E=0;E<=100000/cm;E+=50/cm){
-	for(int i = 0 ; i<=2001;i++){
+	for(int i = 0 ; i<2001;i++){
 		EMobilityHoleLUT[i]=i*dE;
 		MobilityHoleLUT[i]=Default_Hole_Mobility*
 				TMath::Power((1.0/(1.+ TMath::Power((Default_Hole_Mobility*i*dE)/
 						Hole_Saturation_Velocity,Hole_Beta))),1.0/Hole_Beta);
 	}
 
+	m_electronMobility = AllPixCaugheyThomasMobility(Default_Electron_Mobility, Electron_Saturation_Velocity/Default_Electron_Mobility, Electron_Beta);
+	m_holeMobility = AllPixTabulatedMobility(MobilityHoleLUT, dE, 2001);
+
 
 
 
@@ -170,6 +162,12 @@ AllPixTimepixDigitizer::AllPixTimepixDigitizer(G4String modName, G4String hitsCo
 	electricFieldX = 0; // V/um
 	electricFieldY = 0; // V/um
 
+	// linear field along z, zero beyond the depleted depth
+	G4double fieldSign = (readoutType==ELECTRON) ? 1. : -1.;
+	m_driftField = AllPixLinearField1D(fieldSign*(biasVoltage+depletionVoltage)/detectorThickness,
+			-fieldSign*2*depletionVoltage/(detectorThickness*detectorThickness),
+			depletedDepth);
+
 	//G4cout << "!!!!!!!Radiation Damage Report !!!!!!!!" << endl
 //		 << TString::Format("depletionVoltage : %f depleted Depth : %f",depletionVoltage,depletedDepth/um) << endl
 //		 << TString::Format("Neff : %e Neff0 : %e ",Neff*cm3,Neff0*cm3);
@@ -369,6 +367,32 @@ AllPixTimepixDigitizer::AllPixTimepixDigitizer(G4String modName, G4String hitsCo
 
 
 
+
+	// Drift response tables for the 1D field, instead of one full
+	//  integration per hit.  /allpix/det/setDriftTable false to disable.
+	doDriftTable = GetDetectorGeoDscPtr()->GetDriftTable();
+	if(doFullField && doDriftTable) BuildDriftTable();
+
+}
+
+void AllPixTimepixDigitizer::BuildDriftTable(){
+
+	// drifts while -thickness/2 <= z <= thickness/2
+	G4int nNodes = 501;
+	// split at the depleted depth, where the field stops
+	m_driftTable.Init(-detectorThickness/2, detectorThickness/2, nNodes, depletedDepth);
+
+	for(G4int i=0;i<m_driftTable.GetNNodes();i++){
+		G4double z = m_driftTable.GetZ(i);
+		m_driftTable.Set(i, ComputeDriftTimeFullField(0., 0., z, 0.));
+	}
+
+	hitindex=0;
+
+	G4cout << "[Timepix Digitizer] drift table with " << m_driftTable.GetNNodes() << " nodes in z";
+	if(m_driftTable.IsSplit()) G4cout << ", split at the depleted depth " << m_driftTable.GetSplitZ()/um << " um";
+	G4cout << G4endl;
+
 }
 
 AllPixTimepixDigitizer::~AllPixTimepixDigitizer(){
@@ -386,32 +410,9 @@ void AllPixTimepixDigitizer::SetDetectorDigitInputs(G4double thl){
 
 G4double AllPixTimepixDigitizer::MyErf(G4double x){
 
-	G4double yl;
-
-	if(doFastErf){
-		if(x<ErrorFunction.begin()->first)return -1;
-		else if(x>-ErrorFunction.begin()->first)return 1;
-
-		else{
-
-		map<G4double,G4double>::iterator itrl = ErrorFunction.lower_bound(x);
-		//map<G4double,G4double>::iterator itrh = ErrorFunction.upper_bound(x);
-
-	   // xl = itrl->first;
-	   // xh= itrh->first;
-		yl= itrl->second;
-	   // yh= itrh->second;
-
-	  //  cout << TString::Format("xl:%f xh:%f yl:%f yh:%f",xl,xh,yl,yh) << endl;
-
-		//return (x-xl)*((yh-yl)/(xh-xl)) + yl;
-		return yl;
-		}
-	}
-	else{
-		yl=TMath::Erf(x);
-		return yl;
-	}
+	// AllPixErf.hh
+	if(doFastErf) return AllPixFastErf(x);
+	else return TMath::Erf(x);
 
 }
 
@@ -439,7 +440,40 @@ G4double AllPixTimepixDigitizer::GetIkrum(double energy,double aTarget){
 }
 
 
-vector<G4double>  AllPixTimepixDigitizer::ComputeDriftTimeFullField(G4double x, G4double y, G4double z,G4double energy)
+AllPixDriftResult AllPixTimepixDigitizer::ComputeDriftTimeFullField(G4double x, G4double y, G4double z,G4double energy)
+{
+
+	if(B_Field!=0.0){
+
+		// B_Field in T, mobilities in cm2/s (per V).  Along -y so that
+		//  the Lorentz deflection is along x.
+		G4ThreeVector bField(0., -B_Field*1e-4/(cm2/s), 0.);
+
+		if(readoutType==ELECTRON){
+			AllPixDriftEngine<kAllPixElectron, AllPixLinearField1D, AllPixCaugheyThomasMobility, true>
+			engine(m_driftField, m_electronMobility, bField, r_H_e);
+			return DriftCarrier(engine, x, y, z, energy);
+		}
+		else{
+			AllPixDriftEngine<kAllPixHole, AllPixLinearField1D, AllPixTabulatedMobility, true>
+			engine(m_driftField, m_holeMobility, bField, r_H_h);
+			return DriftCarrier(engine, x, y, z, energy);
+		}
+	}
+
+	if(readoutType==ELECTRON){
+		AllPixDriftEngine<kAllPixElectron, AllPixLinearField1D, AllPixCaugheyThomasMobility, false>
+		engine(m_driftField, m_electronMobility);
+		return DriftCarrier(engine, x, y, z, energy);
+	}
+
+	AllPixDriftEngine<kAllPixHole, AllPixLinearField1D, AllPixTabulatedMobility, false>
+	engine(m_driftField, m_holeMobility);
+	return DriftCarrier(engine, x, y, z, energy);
+}
+
+template <class Engine>
+AllPixDriftResult AllPixTimepixDigitizer::DriftCarrier(const Engine & engine, G4double x, G4double y, G4double z,G4double energy)
 {
 	G4double driftTime=0;
 	G4double dt=dtIni;
@@ -447,9 +481,8 @@ vector<G4double>  AllPixTimepixDigitizer::ComputeDriftTimeFullField(G4double x,
 	G4double ytemp=y;
 	G4double ztemp=z;
 	//cout << "z : " << z/um << endl;
-	vector<G4double> step;
-	int counter=0;
-	
+	AllPixDriftStep step;
+
 	vector<G4double> vx,vy,vz,vt; 
 	
 	
@@ -467,36 +500,15 @@ vector<G4double>  AllPixTimepixDigitizer::ComputeDriftTimeFullField(G4double x,
 		
 		driftTime+=dt;
 		
-		if(B_Field!=0.0){
-			
-			if(readoutType==ELECTRON){
-			step=RKF5IntegrationBFieldElectrons(xtemp,ytemp,ztemp,dt);
-			}
-			else{
-			step=RKF5IntegrationBFieldHoles(xtemp,ytemp,ztemp,dt);				
-			}
-		}
-		else {
-			if(readoutType==ELECTRON){
-			step=RKF5IntegrationElectrons(xtemp,ytemp,ztemp,dt);
-			}
-			else{
-			step=RKF5IntegrationHoles(xtemp,ytemp,ztemp,dt);				
-			}
-		};
-		
-		
+		step=engine.Step(xtemp,ytemp,ztemp,dt);
 	
-		xtemp+=step[0];
-		ytemp+=step[1];
-		ztemp+=step[2];
+		xtemp+=step.dx;
+		ytemp+=step.dy;
+		ztemp+=step.dz;
 		
 
-		if(GetElectricFieldNorm(xtemp,ytemp,ztemp)==0)ztemp=detectorThickness;
-		dt=SetDt(dt,step[3]);
-		
-		
-		counter++;
+		if(m_driftField.Ez(ztemp)==0)ztemp=detectorThickness;
+		dt=SetDt(dt,step.err);
 		
 		iter++;
 		//cout << "!!!!!! Drifting youhou! !!!!! " << TString::Format("x: %f y : %f z : %f ",xtemp/um,ytemp/um,ztemp/um) << endl;
@@ -507,11 +519,11 @@ vector<G4double>  AllPixTimepixDigitizer::ComputeDriftTimeFullField(G4double x,
 	if(doAnimation)anim->AddTrack(vx,vy,vz,vt,ComputeDiffusionRMS(driftTime)/um,energy);
 	//cout << "[animation]" << ComputeDiffusionRMS(driftTime)/um << endl;
 
-	vector<G4double> output(4);
-	output[0]=xtemp;
-	output[1]=ytemp;
-	output[2]=ztemp;
-	output[3]=driftTime;
+	AllPixDriftResult output;
+	output.x=xtemp;
+	output.y=ytemp;
+	output.z=ztemp;
+	output.t=driftTime;
 
 	return output;
 }
@@ -522,12 +534,6 @@ void AllPixTimepixDigitizer::ComputeElectricField(G4double /*x*/, G4double /*y*/
 		Efield1D(z);
 }
 
-void AllPixTimepixDigitizer::ComputeEffectiveElectricField(G4double x, G4double y, G4double z){
-
-		Efield1D(z);
-		electricFieldX =electricFieldZ*TMath::Tan(ComputeLorentzAngle(x,y,z)) ;
-}
-
 G4double AllPixTimepixDigitizer::GetElectricFieldNorm(G4double /*x*/, G4double /*y*/, G4double /*z*/){
 
 	return TMath::Sqrt(electricFieldX*electricFieldX +electricFieldY*electricFieldY +electricFieldZ*electricFieldZ );
@@ -537,10 +543,7 @@ G4double  AllPixTimepixDigitizer::MobilityElectron(G4double /*x*/, G4double /*y*
 
 	//ComputeElectricField(x,y,z);
 	G4double parElectricField = electricFieldZ;//GetElectricFieldNorm(x,y,z);
-	G4double mobilite = Default_Electron_Mobility*
-	TMath::Power((1.0/(1.+ TMath::Power((Default_Electron_Mobility*parElectricField)/
-			Electron_Saturation_Velocity,Electron_Beta))),1.0/Electron_Beta);
-	return mobilite;
+	return m_electronMobility(TMath::Abs(parElectricField));
 	//cout << "!!!!!!!!!" << mobilite << " " << parElectricField*cm << endl;
 
 }
@@ -551,14 +554,7 @@ G4double AllPixTimepixDigitizer::MobilityHole(G4double x, G4double y, G4double z
 	ComputeElectricField(x,y,z);
 	G4double parElectricField = GetElectricFieldNorm(x,y,z);
 
-	if(parElectricField<0) return Default_Hole_Mobility;
-	else if (parElectricField>EMobilityHoleLUT[2000]) parElectricField=EMobilityHoleLUT[2000];
-
-
-	//map<G4double,G4double>::iterator itrl =MobilityHoleLUT.lower_bound(parElectricField);
-	//G4double mobilite = itrl->second;
-	G4double mobilite = MobilityHoleLUT[TMath::FloorNint(parElectricField/(dE))];
-	return mobilite;
+	return m_holeMobility(parElectricField);
 
 
 }
@@ -599,6 +595,8 @@ G4double AllPixTimepixDigitizer::IntegrateGaussian(G4double xhit,G4double yhit,G
 {
 	//G4cout << TString::Format("Integration borns xhit=%f yhit=%f x1=%f x2=%f y1=%f y2=%f",xhit/1e3,yhit/1e3,x1/1e3,x2/1e3,y1/1e3,y2/1e3) << endl;
 	//G4cout << TString::Format("TMath::Erf test %f %f %f %f",TMath::Erf((x1 - xhit)/(Sqrt(2.)*Sigma)),TMath::Erf((x2 - xhit)/(TMath::Sqrt(2.)*Sigma)),TMath::Erf((y1 - yhit)/(TMath::Sqrt(2.)*Sigma)),TMath::Erf((y2 - yhit)/(TMath::Sqrt(2.)*Sigma)))<< endl;
+	if(doFastErf) return AllPixGaussianBoxIntegral(xhit, yhit, Sigma, x1, x2, y1, y2, Energy);
+
 	double energybis= (Energy*(-MyErf((x1 - xhit)/(Sqrt(2.)*Sigma)) + MyErf((x2 - xhit)/(TMath::Sqrt(2.)*Sigma)))
 			*(-MyErf((y1 - yhit)/(TMath::Sqrt(2.)*Sigma)) + MyErf((y2 - yhit)/(TMath::Sqrt(2.0)*Sigma))))/4.;
 
@@ -610,24 +608,7 @@ G4double AllPixTimepixDigitizer::IntegrateGaussian(G4double xhit,G4double yhit,G
 
 void AllPixTimepixDigitizer::Efield1D(G4double z){
 
-
-	if(readoutType==ELECTRON)
-	{
-		electricFieldZ=(biasVoltage-depletionVoltage)/detectorThickness+(1-z/detectorThickness)*2*depletionVoltage/detectorThickness;
-		
-		//electricFieldZ=(detectorThickness-z)*biasVoltage/depletedDepth;
-	}
-	else {
-		electricFieldZ=-((biasVoltage-depletionVoltage)/detectorThickness+(1-z/detectorThickness)*2*depletionVoltage/detectorThickness);
-		//electricFieldZ=-(detectorThickness-z)*biasVoltage/depletedDepth;
-	}
-	
-	if(z>depletedDepth){
-		electricFieldZ=0;
-		//cout << "bip" << endl;
-	}
-
-	//G4cout << electricFieldZ<< endl;
+	electricFieldZ=m_driftField.Ez(z);
 
 }
 
@@ -654,7 +635,7 @@ void AllPixTimepixDigitizer::Digitize(){
 
 	// Temporary data structure to store hits
 	//  collection information
-	map<pair<G4int, G4int>, G4double > pixelsContent;
+	AllPixPixelAccumulator & pixelsContent = ResetPixelAccumulator();
 	pair<G4int, G4int> tempPixel;
 
 	// Loop over the whole Hits Collection
@@ -769,11 +750,13 @@ void AllPixTimepixDigitizer::Digitize(){
 		else{
 
 			// Until we get out position
-			vector<G4double> data = ComputeDriftTimeFullField(xpos,ypos,zpos,eHit);
-			driftTime = data[3];
+			// tabulated response when available, full integration otherwise
+			AllPixDriftResult data = (doDriftTable && !doAnimation && m_driftTable.IsInRange(zpos)) ?
+					m_driftTable.Lookup(xpos,ypos,zpos) : ComputeDriftTimeFullField(xpos,ypos,zpos,eHit);
+			driftTime = data.t;
 			sigma = ComputeDiffusionRMS(driftTime);
-			xpos=data[0];
-			ypos=data[1];
+			xpos=data.x;
+			ypos=data.y;
 			//G4cout << TString::Format("!!!!!!!!! vd/vdep : %f drift time : %f sigma : %f",depletedDepth/detectorThickness,driftTime,sigma) << endl;
 
 		}
@@ -852,7 +835,7 @@ void AllPixTimepixDigitizer::Digitize(){
 	//G4cout << "total = " << hitsETotal/keV << " keV" << G4endl;
 
 	// Now create digits.  One per pixel
-	map<pair<G4int, G4int>, G4double >::iterator pCItr = pixelsContent.begin();
+	AllPixPixelAccumulator::iterator pCItr = pixelsContent.begin();
 
 	for( ; pCItr != pixelsContent.end() ; pCItr++)
 	{
@@ -923,301 +906,6 @@ void AllPixTimepixDigitizer::Digitize(){
 
 
 
-vector<G4double>  AllPixTimepixDigitizer::RKF5IntegrationHoles(G4double x, G4double y, G4double z,G4double dt)
-{
-// This function transport using Euler integration, for field (Ex,Ey,Ez),
-// considered constant over time dt. The movement equation are those
-// of charges in semi-conductors, sx= mu*E*dt;;
-	double k1x,k2x,k3x,k4x,k5x,k6x;
-	double k1y,k2y,k3y,k4y,k5y,k6y;
-	double k1z,k2z,k3z,k4z,k5z,k6z;
-	double dx,dy,dz;
-
-      ComputeElectricField(x,y,z);
-
-      k1x=MobilityHole(x,y,z)*electricFieldX*dt;
-      k1y=MobilityHole(x,y,z)*electricFieldY*dt;
-      k1z=MobilityHole(x,y,z)*electricFieldZ*dt;
-
-      ComputeElectricField(x+k1x/4,y+k1y/4,z+k1z/4);
-
-      k2x=MobilityHole(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldX*dt;
-      k2y=MobilityHole(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldY*dt;
-      k2z=MobilityHole(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldZ*dt;
-
-     ComputeElectricField(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z);
-
-      k3x=MobilityHole(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldX*dt;
-      k3y=MobilityHole(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldY*dt;
-      k3z=MobilityHole(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldZ*dt;
-
-      ComputeElectricField(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z);
-
-      k4x=MobilityHole(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldX*dt;
-      k4y=MobilityHole(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldY*dt;
-      k4z=MobilityHole(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldZ*dt;
-
-      ComputeElectricField(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z);
-
-      k5x=MobilityHole(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldX*dt;
-      k5y=MobilityHole(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldY*dt;
-      k5z=MobilityHole(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldZ*dt;
-
-      ComputeElectricField(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z);
-
-      k6x=MobilityHole(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldX*dt;
-      k6y=MobilityHole(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldY*dt;
-      k6z=MobilityHole(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldZ*dt;
-
-      dx=((16./135)*k1x+(6656./12825)*k3x+(28561./56430)*k4x-(9./50)*k5x+(2./55)*k6x);
-      dy=((16./135)*k1y+(6656./12825)*k3y+(28561./56430)*k4y-(9./50)*k5y+(2./55)*k6y);
-      dz=((16./135)*k1z+(6656./12825)*k3z+(28561./56430)*k4z-(9./50)*k5z+(2./55)*k6z);
-
-      double Ex,Ey,Ez,Erreur;
-      Ex=((1./360)*k1x-(128./4275)*k3x-(2197./75240)*k4x-(1./50)*k5x+(2./55)*k6x);
-      Ey=((1./360)*k1y-(128./4275)*k3y-(2197./75240)*k4y-(1./50)*k5y+(2./55)*k6y);
-      Ez=((1./360)*k1z-(128./4275)*k3z-(2197./75240)*k4z-(1./50)*k5z+(2./55)*k6z);
-      Erreur=sqrt(Ex*Ex+Ey*Ey+Ez*Ez);
-
-      vector<G4double> newpoint(4);
-      newpoint[0]=(dx);
-      newpoint[1]=(dy);
-      newpoint[2]=(dz);
-      newpoint[3]=(Erreur);
-
-     return newpoint;
-
-}
-
-vector<G4double>  AllPixTimepixDigitizer::RKF5IntegrationBFieldHoles(G4double x, G4double y, G4double z,G4double dt)
-{
-// This function transport using Euler integration, for field (Ex,Ey,Ez),
-// considered constant over time dt. The movement equation are those
-// of charges in semi-conductors, sx= mu*E*dt;;
-	double k1x,k2x,k3x,k4x,k5x,k6x;
-	double k1y,k2y,k3y,k4y,k5y,k6y;
-	double k1z,k2z,k3z,k4z,k5z,k6z;
-	double dx,dy,dz;
-
-      ComputeEffectiveElectricField(x,y,z);
-
-      k1x=r_H_h*MobilityHole(x,y,z)*electricFieldX*dt;
-      k1y=r_H_h*MobilityHole(x,y,z)*electricFieldY*dt;
-      k1z=r_H_h*MobilityHole(x,y,z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x+k1x/4,y+k1y/4,z+k1z/4);
-
-      k2x=r_H_h*MobilityHole(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldX*dt;
-      k2y=r_H_h*MobilityHole(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldY*dt;
-      k2z=r_H_h*MobilityHole(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldZ*dt;
-
-     ComputeEffectiveElectricField(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z);
-
-      k3x=r_H_h*MobilityHole(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldX*dt;
-      k3y=r_H_h*MobilityHole(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldY*dt;
-      k3z=r_H_h*MobilityHole(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z);
-
-      k4x=r_H_h*MobilityHole(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldX*dt;
-      k4y=r_H_h*MobilityHole(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldY*dt;
-      k4z=r_H_h*MobilityHole(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z);
-
-      k5x=r_H_h*MobilityHole(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldX*dt;
-      k5y=r_H_h*MobilityHole(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldY*dt;
-      k5z=r_H_h*MobilityHole(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z);
-
-      k6x=r_H_h*MobilityHole(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldX*dt;
-      k6y=r_H_h*MobilityHole(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldY*dt;
-      k6z=r_H_h*MobilityHole(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldZ*dt;
-
-      dx=((16./135)*k1x+(6656./12825)*k3x+(28561./56430)*k4x-(9./50)*k5x+(2./55)*k6x);
-      dy=((16./135)*k1y+(6656./12825)*k3y+(28561./56430)*k4y-(9./50)*k5y+(2./55)*k6y);
-      dz=((16./135)*k1z+(6656./12825)*k3z+(28561./56430)*k4z-(9./50)*k5z+(2./55)*k6z);
-
-      double Ex,Ey,Ez,Erreur;
-      Ex=((1./360)*k1x-(128./4275)*k3x-(2197./75240)*k4x-(1./50)*k5x+(2./55)*k6x);
-      Ey=((1./360)*k1y-(128./4275)*k3y-(2197./75240)*k4y-(1./50)*k5y+(2./55)*k6y);
-      Ez=((1./360)*k1z-(128./4275)*k3z-(2197./75240)*k4z-(1./50)*k5z+(2./55)*k6z);
-      Erreur=sqrt(Ex*Ex+Ey*Ey+Ez*Ez);
-
-      vector<G4double> newpoint(4);
-      newpoint[0]=(dx);
-      newpoint[1]=(dy);
-      newpoint[2]=(dz);
-      newpoint[3]=(Erreur);
-
-     return newpoint;
-
-}
-
-vector<G4double>  AllPixTimepixDigitizer::RKF5IntegrationElectrons(G4double x, G4double y, G4double z,G4double dt)
-{
-// This function transport using Euler integration, for field (Ex,Ey,Ez),
-// considered constant over time dt. The movement equation are those
-// of charges in semi-conductors, sx= mu*E*dt;;
-	double k1x,k2x,k3x,k4x,k5x,k6x;
-	double k1y,k2y,k3y,k4y,k5y,k6y;
-	double k1z,k2z,k3z,k4z,k5z,k6z;
-	double dx,dy,dz;
-
-      ComputeElectricField(x,y,z);
-
-      k1x=-MobilityElectron(x,y,z)*electricFieldX*dt;
-      k1y=-MobilityElectron(x,y,z)*electricFieldY*dt;
-      k1z=-MobilityElectron(x,y,z)*electricFieldZ*dt;
-
-      ComputeElectricField(x+k1x/4,y+k1y/4,z+k1z/4);
-
-      k2x=-MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldX*dt;
-      k2y=-MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldY*dt;
-      k2z=-MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldZ*dt;
-
-     ComputeElectricField(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z);
-
-      k3x=-MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldX*dt;
-      k3y=-MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldY*dt;
-      k3z=-MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldZ*dt;
-
-      ComputeElectricField(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z);
-
-      k4x=-MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldX*dt;
-      k4y=-MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldY*dt;
-      k4z=-MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldZ*dt;
-
-      ComputeElectricField(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z);
-
-      k5x=-MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldX*dt;
-      k5y=-MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldY*dt;
-      k5z=-MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldZ*dt;
-
-      ComputeElectricField(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z);
-
-      k6x=-MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldX*dt;
-      k6y=-MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldY*dt;
-      k6z=-MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldZ*dt;
-
-      dx=((16./135)*k1x+(6656./12825)*k3x+(28561./56430)*k4x-(9./50)*k5x+(2./55)*k6x);
-      dy=((16./135)*k1y+(6656./12825)*k3y+(28561./56430)*k4y-(9./50)*k5y+(2./55)*k6y);
-      dz=((16./135)*k1z+(6656./12825)*k3z+(28561./56430)*k4z-(9./50)*k5z+(2./55)*k6z);
-
-      double Ex,Ey,Ez,Erreur;
-      Ex=((1./360)*k1x-(128./4275)*k3x-(2197./75240)*k4x-(1./50)*k5x+(2./55)*k6x);
-      Ey=((1./360)*k1y-(128./4275)*k3y-(2197./75240)*k4y-(1./50)*k5y+(2./55)*k6y);
-      Ez=((1./360)*k1z-(128./4275)*k3z-(2197./75240)*k4z-(1./50)*k5z+(2./55)*k6z);
-      Erreur=sqrt(Ex*Ex+Ey*Ey+Ez*Ez);
-
-      vector<G4double> newpoint(4);
-      newpoint[0]=(dx);
-      newpoint[1]=(dy);
-      newpoint[2]=(dz);
-      newpoint[3]=(Erreur);
-
-     return newpoint;
-
-}
-
-vector<G4double>  AllPixTimepixDigitizer::RKF5IntegrationBFieldElectrons(G4double x, G4double y, G4double z,G4double dt)
-{
-// This function transport using Euler integration, for field (Ex,Ey,Ez),
-// considered constant over time dt. The movement equation are those
-// of charges in semi-conductors, sx= mu*E*dt;;
-	double k1x,k2x,k3x,k4x,k5x,k6x;
-	double k1y,k2y,k3y,k4y,k5y,k6y;
-	double k1z,k2z,k3z,k4z,k5z,k6z;
-	double dx,dy,dz;
-
-      ComputeEffectiveElectricField(x,y,z);
-
-      k1x=-r_H_e*MobilityElectron(x,y,z)*electricFieldX*dt;
-      k1y=-r_H_e*MobilityElectron(x,y,z)*electricFieldY*dt;
-      k1z=-r_H_e*MobilityElectron(x,y,z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x+k1x/4,y+k1y/4,z+k1z/4);
-
-      k2x=-r_H_e*MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldX*dt;
-      k2y=-r_H_e*MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldY*dt;
-      k2z=-r_H_e*MobilityElectron(x+k1x/4,y+k1y/4,z+k1z/4)*electricFieldZ*dt;
-
-     ComputeEffectiveElectricField(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z);
-
-      k3x=-r_H_e*MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldX*dt;
-      k3y=-r_H_e*MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldY*dt;
-      k3z=-r_H_e*MobilityElectron(x+(9./32)*k2x+(3./32)*k1x,y+(9./32)*k2y+(3./32)*k1y,z+(9./32)*k2z+(3./32)*k1z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z);
-
-      k4x=-r_H_e*MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldX*dt;
-      k4y=-r_H_e*MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldY*dt;
-      k4z=-r_H_e*MobilityElectron(x-(7200./2197)*k2x+(1932./2197)*k1x+(7296./2197)*k3x,y-(7200./2197)*k2y+(1932./2197)*k1y+(7296./2197)*k3y,z-(7200./2197)*k2z+(1932./2197)*k1z+(7296./2197)*k3z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z);
-
-      k5x=-r_H_e*MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldX*dt;
-      k5y=-r_H_e*MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldY*dt;
-      k5z=-r_H_e*MobilityElectron(x-(8)*k2x+(439./216)*k1x+(3680./513)*k3x-(845./4104)*k4x,y-(8)*k2y+(439./216)*k1y+(3680./513)*k3y-(845./4104)*k4y,z-(8)*k2z+(439./216)*k1z+(3680./513)*k3z-(845./4104)*k4z)*electricFieldZ*dt;
-
-      ComputeEffectiveElectricField(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z);
-
-      k6x=-r_H_e*MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldX*dt;
-      k6y=-r_H_e*MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldY*dt;
-      k6z=-r_H_e*MobilityElectron(x+(2)*k2x-(8./27)*k1x-(3544./2565)*k3x-(1859./4104)*k4x-(11./40)*k5x,
-    	      y+(2)*k2y-(8./27)*k1y-(3544./2565)*k3y-(1859./4104)*k4y-(11./40)*k5y,
-    	      z+(2)*k2z-(8./27)*k1z-(3544./2565)*k3z-(1859./4104)*k4z-(11./40)*k5z)*electricFieldZ*dt;
-
-      dx=((16./135)*k1x+(6656./12825)*k3x+(28561./56430)*k4x-(9./50)*k5x+(2./55)*k6x);
-      dy=((16./135)*k1y+(6656./12825)*k3y+(28561./56430)*k4y-(9./50)*k5y+(2./55)*k6y);
-      dz=((16./135)*k1z+(6656./12825)*k3z+(28561./56430)*k4z-(9./50)*k5z+(2./55)*k6z);
-
-      double Ex,Ey,Ez,Erreur;
-      Ex=((1./360)*k1x-(128./4275)*k3x-(2197./75240)*k4x-(1./50)*k5x+(2./55)*k6x);
-      Ey=((1./360)*k1y-(128./4275)*k3y-(2197./75240)*k4y-(1./50)*k5y+(2./55)*k6y);
-      Ez=((1./360)*k1z-(128./4275)*k3z-(2197./75240)*k4z-(1./50)*k5z+(2./55)*k6z);
-      Erreur=sqrt(Ex*Ex+Ey*Ey+Ez*Ez);
-
-      vector<G4double> newpoint(4);
-      newpoint[0]=(dx);
-      newpoint[1]=(dy);
-      newpoint[2]=(dz);
-      newpoint[3]=(Erreur);
-
-     return newpoint;
-
-}
 
 
 //______________________________________________________________________________
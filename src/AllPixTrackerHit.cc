@@ -67,10 +67,12 @@ AllPixTrackerHit::AllPixTrackerHit(const AllPixTrackerHit& right)
 	edep      = right.edep;
 	pos       = right.pos;
 	m_posWithRespectToPixel = right.m_posWithRespectToPixel;
-	processName = right.processName;
+	m_posInLocalReferenceFrame = right.m_posInLocalReferenceFrame;
+	processId = right.processId;
 	pdgIdTrack = right.pdgIdTrack;
-	trackVolumeName = right.trackVolumeName;
-	parentVolumeName = right.parentVolumeName;
+	trackVolumeId = right.trackVolumeId;
+	parentVolumeId = right.parentVolumeId;
+	kinEParent = right.kinEParent;
 	//kinE      = right.kinE;
 }
 
@@ -88,10 +90,12 @@ const AllPixTrackerHit& AllPixTrackerHit::operator=(const AllPixTrackerHit& righ
 	edep      = right.edep;
 	pos       = right.pos;
 	m_posWithRespectToPixel = right.m_posWithRespectToPixel;
-	processName = right.processName;
+	m_posInLocalReferenceFrame = right.m_posInLocalReferenceFrame;
+	processId = right.processId;
 	pdgIdTrack = right.pdgIdTrack;
-	trackVolumeName = right.trackVolumeName;
-	parentVolumeName = right.parentVolumeName;
+	trackVolumeId = right.trackVolumeId;
+	parentVolumeId = right.parentVolumeId;
+	kinEParent = right.kinEParent;
 	//kinE      = right.kinE;
 	return *this;
 }
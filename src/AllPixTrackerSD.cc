@@ -43,15 +43,18 @@
 #include "G4VProcess.hh"
 #include "G4DecayTable.hh"
 #include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Navigator.hh"
+#include "G4TouchableHistory.hh"
+#include "G4TransportationManager.hh"
 
 #include "AllPixGeoDsc.hh"
+#include "AllPixNameTable.hh"
 
 #include "TMath.h"
 #include "TString.h"
 
-// temp
-G4double g_temp_edep = 0.;
-G4int g_temp_pdgId = 0;
+#include <algorithm>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -69,11 +72,19 @@ AllPixTrackerSD::AllPixTrackerSD(G4String name,
 	// Absolute position of SD
 	m_absolutePosOfWrapper = absPosWrapper;
 	m_relativePosOfSD = relPosSD;
-	m_rotationOfWrapper = rot;
+	// rot is the rotation of the frame given to the placement of the
+	//  wrapper, it takes global directions to the wrapper frame
+	if(rot) m_invRotationOfWrapper = *rot;
+	m_posOfChip = m_invRotationOfWrapper * m_absolutePosOfWrapper + m_relativePosOfSD;
 	m_gD = gD; // Geo description
 	m_thisIsAPixelDetector = true;
+	m_analyticPixelIndexing = false;
+	m_transportationId = -1;
+	m_fastNavigator = 0x0;
+	m_fastTouchable = 0x0;
 
 	m_globalTrackId_Dump = 0;
+	m_HCID = -1;
 	firstStrikePrimary = false;
 	_totalEdep = 0;
 
@@ -92,11 +103,18 @@ AllPixTrackerSD::AllPixTrackerSD(G4String name, G4ThreeVector absPos, G4Rotation
 	// reduced set of parameters for a SD which is not a pixel detector
 	m_absolutePosOfWrapper = absPos;
 	m_relativePosOfSD = G4ThreeVector(0,0,0);
-	m_rotationOfWrapper = rot;
+	if(rot) m_invRotationOfWrapper = *rot;
+	m_posOfChip = m_invRotationOfWrapper * m_absolutePosOfWrapper + m_relativePosOfSD;
 	m_gD = 0x0; // Geo description
 	m_thisIsAPixelDetector = false;
+	m_analyticPixelIndexing = false;
+	m_transportationId = -1;
+	m_fastNavigator = 0x0;
+	m_fastTouchable = 0x0;
 
 	m_globalTrackId_Dump = 0;
+	m_HCID = -1;
+	firstStrikePrimary = false;
 	_totalEdep = 0;
 
 }
@@ -105,6 +123,9 @@ AllPixTrackerSD::AllPixTrackerSD(G4String name, G4ThreeVector absPos, G4Rotation
 
 AllPixTrackerSD::~AllPixTrackerSD(){ 
 
+	delete m_fastTouchable;
+	delete m_fastNavigator;
+
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -120,15 +141,17 @@ void AllPixTrackerSD::Initialize(G4HCofThisEvent* HCE)
 	hitsCollection = new AllPixTrackerHitsCollection
 			(SensitiveDetectorName, collectionName[0]);
 
-	static G4int HCID = -1;
-	HCID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
+	// The collection ID doesn't change.  Look it up only the first time.
+	if(m_HCID < 0) m_HCID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
 
 	// Add to hits collection of this event
-	HCE->AddHitsCollection( HCID, hitsCollection );
+	HCE->AddHitsCollection( m_HCID, hitsCollection );
 
+#ifdef ALLPIX_SD_CHECKS
 	// Insert the pointer in a set to check its existence later
 	// Normally there is only one instance of AllPixTrackerSD per sensitive volume
 	m_hitsCollectionSet.insert(hitsCollection);
+#endif
 
 }
 
@@ -138,6 +161,7 @@ void AllPixTrackerSD::Initialize(G4HCofThisEvent* HCE)
 G4bool AllPixTrackerSD::ProcessHits(G4Step * aStep, G4TouchableHistory *)
 {
 
+#ifdef ALLPIX_SD_CHECKS
 	// Check first if we are working in a valid HitCollection
 	// This should never happen if the user don't replicate detector Id in the macro.
 	// A check is done in ReadGeoDescription ... I probably don't need to check this here.
@@ -152,6 +176,7 @@ G4bool AllPixTrackerSD::ProcessHits(G4Step * aStep, G4TouchableHistory *)
 		G4cout << "          has been given. AllPixTrackerSD::ProcessHits returns false." << G4endl;
 		return false;
 	}
+#endif
 
 	// track
 	G4Track * aTrack = aStep->GetTrack();
@@ -176,6 +201,12 @@ G4bool AllPixTrackerSD::ProcessHits(G4Step * aStep, G4TouchableHistory *)
 	G4double edep = aStep->GetTotalEnergyDeposit();
 	if(edep==0.) return false;
 
+	// single sensitive box, the step is cut at the pixel boundaries
+	if (m_thisIsAPixelDetector && m_analyticPixelIndexing) {
+		ProcessHitsAnalytic(aStep, edep);
+		return true;
+	}
+
 	G4StepPoint * preStepPoint = aStep->GetPreStepPoint();
 	G4StepPoint * postStepPoint = aStep->GetPostStepPoint();
 
@@ -195,30 +226,10 @@ G4bool AllPixTrackerSD::ProcessHits(G4Step * aStep, G4TouchableHistory *)
 		G4ThreeVector prePos = preStepPoint->GetPosition();
 
 
-		// Find the inverse rotation
-		//G4RotationMatrix invRot2 = CLHEP::inverseOf(*m_rotationOfWrapper);
-		G4RotationMatrix invRot = m_rotationOfWrapper->inverse().inverse();
-
-		// Absolute center of Si wafer
-		G4ThreeVector absCenterOfDetector = m_absolutePosOfWrapper ;
-		//G4cout << "Absolute position of Wrapper : " << absCenterOfDetector << endl;
-
-		// Bring the detector (Si layer) to the Origin
-		correctedPos = prePos;
-		correctedPos -= absCenterOfDetector;
-		// apply rotation !
-		correctedPos = invRot * correctedPos;
-		PosOnChip = correctedPos - m_relativePosOfSD;
-
-		// Now let's finally provide pixel-centered coordinates for each hit
-		// Build the center of the Pixel
-		G4ThreeVector centerOfPixel(
-				m_gD->GetPixelX()*TMath::FloorNint(correctedPos.x() / m_gD->GetPixelX()) + m_gD->GetHalfPixelX(),
-				m_gD->GetPixelY()*TMath::FloorNint(correctedPos.y() / m_gD->GetPixelY()) + m_gD->GetHalfPixelY(),
-				0.); // in the middle of the tower
-
-		// The position within the pixel !!!
-		correctedPos = correctedPos - centerOfPixel - m_relativePosOfSD;
+		// Bring the detector (Si layer) to the Origin and apply the rotation.
+		// The transformation is precomputed in the constructor
+		PosOnChip = GetPosOnChip(prePos);
+		correctedPos = GetPosWithRespectToPixel(PosOnChip);
 
 		//G4cout << "uncorrectedPos : " << prePos.x()/um << " " << prePos.y()/um
 		//	   << " " << prePos.z()/um << " [um]" << G4endl;
@@ -267,18 +278,13 @@ G4bool AllPixTrackerSD::ProcessHits(G4Step * aStep, G4TouchableHistory *)
 	newHit->SetPosWithRespectToPixel( correctedPos );
 	newHit->SetPosInLocalReferenceFrame(PosOnChip);
 
-	newHit->SetProcessName(aProcessPointer->GetProcessName());
+	newHit->SetProcessId(GetProcessId(aProcessPointer));
 	newHit->SetTrackPdgId(aParticle->GetPDGEncoding());
 
 	newHit->SetKinEParent( _kinEPrimary );
 
-	/////////////////////////////////////////////
-	g_temp_edep = edep;
-	g_temp_pdgId = aParticle->GetPDGEncoding();
-	/////////////////////////////////////////////
-
-	newHit->SetTrackVolumeName(aTrack->GetVolume()->GetName());
-	newHit->SetParentVolumeName(aTrack->GetLogicalVolumeAtVertex()->GetName());
+	newHit->SetTrackVolumeId(GetVolumeId(aTrack->GetVolume()));
+	newHit->SetParentVolumeId(GetVolumeId(aTrack->GetLogicalVolumeAtVertex()));
 
 	//G4cout << "hitsCollection : " << hitsCollection << G4endl;
 	//G4cout << "     entries --> " << hitsCollection->entries() << G4endl;
@@ -286,15 +292,292 @@ G4bool AllPixTrackerSD::ProcessHits(G4Step * aStep, G4TouchableHistory *)
 	//newHit->Print();
 	//newHit->Draw();
 
+#ifdef ALLPIX_SD_CHECKS
 	if ( _totalEdep > _kinEPrimary ) {
 		cout << "[WARNING] totalEdep = " << _totalEdep << ", kinEPrimary = " << _kinEPrimary << endl;
 	}
+#endif
 
 	return true;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+/**
+ * Single sensitive box.  With the pixel volumes Geant4 ends a step at
+ * every pixel boundary; here a step may go through several pixels, so it
+ * is cut at the boundaries and every piece gives the hit the pixel
+ * volumes would have given: its share of the energy (by length), the
+ * position where it starts and ends, "Transportation" as the process of
+ * all but the last one and the pixel of the next piece as post pixel.
+ */
+void AllPixTrackerSD::ProcessHitsAnalytic(G4Step * aStep, G4double edep)
+{
+
+	G4Track * aTrack = aStep->GetTrack();
+	G4StepPoint * preStepPoint = aStep->GetPreStepPoint();
+	G4StepPoint * postStepPoint = aStep->GetPostStepPoint();
+
+	G4ThreeVector prePos = preStepPoint->GetPosition();
+	G4ThreeVector postPos = postStepPoint->GetPosition();
+	G4ThreeVector preOnChip = GetPosOnChip(prePos);
+	G4ThreeVector postOnChip = GetPosOnChip(postPos);
+
+	GetPixelCrossings(preOnChip, postOnChip, m_crossings);
+	m_crossings.push_back(1.);
+
+	if (m_transportationId < 0) m_transportationId = AllPixNameTable::GetInstance()->GetId("Transportation");
+	G4int processId = GetProcessId(postStepPoint->GetProcessDefinedStep());
+	G4int trackVolumeId = GetVolumeId(aTrack->GetVolume());
+	G4int parentVolumeId = GetVolumeId(aTrack->GetLogicalVolumeAtVertex());
+
+	// pixel of the first piece
+	G4double f0 = 0.;
+	G4int copyIDx = -1;
+	G4int copyIDy = -1;
+	GetPixelIndex(preOnChip + 0.5*m_crossings[0]*(postOnChip - preOnChip), copyIDx, copyIDy);
+
+	for (size_t i = 0 ; i < m_crossings.size() ; i++) {
+
+		G4double f1 = m_crossings[i];
+		G4bool last = (i + 1 == m_crossings.size());
+
+		G4int copyIDx_post = -1;
+		G4int copyIDy_post = -1;
+		if (!last) {
+			GetPixelIndex(preOnChip + 0.5*(f1 + m_crossings[i+1])*(postOnChip - preOnChip), copyIDx_post, copyIDy_post);
+		} else if (preStepPoint->GetPhysicalVolume() == postStepPoint->GetPhysicalVolume()) {
+			GetPixelIndex(postOnChip, copyIDx_post, copyIDy_post);
+		}
+
+		G4ThreeVector PosOnChip = preOnChip + f0*(postOnChip - preOnChip);
+
+		AllPixTrackerHit * newHit = new AllPixTrackerHit();
+		newHit->SetTrackID(aTrack->GetTrackID());
+		newHit->SetParentID(aTrack->GetParentID());
+		newHit->SetPixelNbX(copyIDx);
+		newHit->SetPixelNbY(copyIDy);
+		newHit->SetPostPixelNbX(copyIDx_post);
+		newHit->SetPostPixelNbY(copyIDy_post);
+		newHit->SetEdep(edep*(f1 - f0));
+		newHit->SetPos(last ? postPos : prePos + f1*(postPos - prePos));
+
+		newHit->SetPosWithRespectToPixel( GetPosWithRespectToPixel(PosOnChip) );
+		newHit->SetPosInLocalReferenceFrame(PosOnChip);
+
+		newHit->SetProcessId(last ? processId : m_transportationId);
+		newHit->SetTrackPdgId(aTrack->GetDefinition()->GetPDGEncoding());
+
+		newHit->SetKinEParent( _kinEPrimary );
+
+		newHit->SetTrackVolumeId(trackVolumeId);
+		newHit->SetParentVolumeId(parentVolumeId);
+
+		hitsCollection->insert(newHit);
+
+		f0 = f1;
+		copyIDx = copyIDx_post;
+		copyIDy = copyIDy_post;
+	}
+
+	_totalEdep += edep;
+
+}
+
+/**
+ * Fractions (0 --> 1) of the segment p0 --> p1, Si wafer frame, where it
+ * crosses a pixel boundary inside the sensor.  Sorted, without repeats
+ * (a corner is one crossing).
+ */
+void AllPixTrackerSD::GetPixelCrossings(const G4ThreeVector & p0, const G4ThreeVector & p1, vector<G4double> & f)
+{
+
+	f.clear();
+
+	for (G4int axis = 0 ; axis < 2 ; axis++) {
+
+		G4int nPixels = axis == 0 ? m_gD->GetNPixelsX() : m_gD->GetNPixelsY();
+		G4double half = axis == 0 ? m_gD->GetHalfSensorX() : m_gD->GetHalfSensorY();
+		G4double sensor = axis == 0 ? m_gD->GetSensorX() : m_gD->GetSensorY();
+
+		// in pixel units from the edge of the sensor, boundaries at the integers
+		G4double u0 = (p0[axis] + half) * nPixels / sensor;
+		G4double u1 = (p1[axis] + half) * nPixels / sensor;
+		if (u0 == u1) continue;
+
+		G4int kMin = TMath::FloorNint(std::min(u0, u1)) + 1;
+		G4int kMax = TMath::CeilNint(std::max(u0, u1)) - 1;
+		if (kMin < 1) kMin = 1;
+		if (kMax > nPixels - 1) kMax = nPixels - 1;
+
+		for (G4int k = kMin ; k <= kMax ; k++) f.push_back((k - u0)/(u1 - u0));
+	}
+
+	std::sort(f.begin(), f.end());
+	f.erase(std::unique(f.begin(), f.end()), f.end());
+	// nothing left on the ends
+	while (!f.empty() && f.back() >= 1.) f.pop_back();
+	while (!f.empty() && f.front() <= 0.) f.erase(f.begin());
+
+}
+
+/**
+ * Global position --> position in the frame of the Si wafer (center of the wafer
+ * at the origin).  Same transformation ProcessHits applies to the preStep point.
+ */
+G4ThreeVector AllPixTrackerSD::GetPosOnChip(const G4ThreeVector & globalPos)
+{
+
+	return m_invRotationOfWrapper * globalPos - m_posOfChip;
+}
+
+/**
+ * Pixel-centered coordinates of a position in the Si wafer frame.
+ */
+G4ThreeVector AllPixTrackerSD::GetPosWithRespectToPixel(const G4ThreeVector & posOnChip)
+{
+
+	G4ThreeVector correctedPos = posOnChip + m_relativePosOfSD;
+
+	// Build the center of the Pixel
+	G4ThreeVector centerOfPixel(
+			m_gD->GetPixelX()*TMath::FloorNint(correctedPos.x() / m_gD->GetPixelX()) + m_gD->GetHalfPixelX(),
+			m_gD->GetPixelY()*TMath::FloorNint(correctedPos.y() / m_gD->GetPixelY()) + m_gD->GetHalfPixelY(),
+			0.); // in the middle of the tower
+
+	// The position within the pixel !!!
+	return correctedPos - centerOfPixel - m_relativePosOfSD;
+}
+
+/**
+ * Pixel indexes from the position in the Si wafer frame.  Reproduces the copy
+ * numbers of the G4PVDivision's (x slices starting at -HalfSensorX, y pixels
+ * starting at -HalfSensorY).  A point sitting exactly on the far edge of the
+ * wafer is given to the last pixel.
+ */
+void AllPixTrackerSD::GetPixelIndex(const G4ThreeVector & posOnChip, G4int & idX, G4int & idY)
+{
+
+	// the divisions use the sensor width over the number of pixels
+	idX = TMath::FloorNint( (posOnChip.x() + m_gD->GetHalfSensorX()) * m_gD->GetNPixelsX() / m_gD->GetSensorX() );
+	idY = TMath::FloorNint( (posOnChip.y() + m_gD->GetHalfSensorY()) * m_gD->GetNPixelsY() / m_gD->GetSensorY() );
+
+	if (idX < 0) idX = 0;
+	if (idX >= m_gD->GetNPixelsX()) idX = m_gD->GetNPixelsX() - 1;
+	if (idY < 0) idY = 0;
+	if (idY >= m_gD->GetNPixelsY()) idY = m_gD->GetNPixelsY() - 1;
+
+}
+
+/**
+ * Hit from a parameterised sensor (AllPixFastPlaneModel), no step behind
+ * it.  pos is where the energy is deposited, postPos the end of that
+ * piece of path, both global and in the same pixel.  Same content as
+ * the hits of ProcessHits, the pixel index from the position with a
+ * single sensitive box, from the pixel volume at pos otherwise.
+ */
+void AllPixTrackerSD::AddFastHit(const G4Track * aTrack, const G4ThreeVector & pos,
+		const G4ThreeVector & postPos, G4double edep, G4int processId)
+{
+
+	if ( aTrack->GetTrackID() == 1 && ! firstStrikePrimary ) {
+		_kinEPrimary = aTrack->GetKineticEnergy()/keV;
+		firstStrikePrimary = true;
+	}
+
+	if ( edep == 0. || ! m_thisIsAPixelDetector ) return;
+
+	G4ThreeVector PosOnChip = GetPosOnChip(pos);
+	G4int copyIDx = -1;
+	G4int copyIDy = -1;
+	if ( m_analyticPixelIndexing ) {
+		GetPixelIndex(PosOnChip, copyIDx, copyIDy);
+	} else {
+		// pixel volumes, the copy numbers of the touchable as in
+		//  ProcessHits.  A navigator of its own, the one of the
+		//  tracking is in the middle of the step.
+		if ( ! m_fastNavigator ) {
+			m_fastNavigator = new G4Navigator;
+			m_fastNavigator->SetWorldVolume( G4TransportationManager::GetTransportationManager()
+					->GetNavigatorForTracking()->GetWorldVolume() );
+			m_fastTouchable = new G4TouchableHistory;
+		}
+		m_fastNavigator->LocateGlobalPointAndUpdateTouchable(pos, m_fastTouchable, false);
+		// depth 1 --> x
+		// depth 0 --> y
+		copyIDy = m_fastTouchable->GetCopyNumber();
+		copyIDx = m_fastTouchable->GetCopyNumber(1);
+	}
+
+	AllPixTrackerHit * newHit = new AllPixTrackerHit();
+	newHit->SetTrackID(aTrack->GetTrackID());
+	newHit->SetParentID(aTrack->GetParentID());
+	newHit->SetPixelNbX(copyIDx);
+	newHit->SetPixelNbY(copyIDy);
+	newHit->SetPostPixelNbX(copyIDx);
+	newHit->SetPostPixelNbY(copyIDy);
+	newHit->SetEdep(edep);
+	_totalEdep += edep;
+	newHit->SetPos(postPos);
+
+	newHit->SetPosWithRespectToPixel( GetPosWithRespectToPixel(PosOnChip) );
+	newHit->SetPosInLocalReferenceFrame(PosOnChip);
+
+	newHit->SetProcessId(processId);
+	newHit->SetTrackPdgId(aTrack->GetDefinition()->GetPDGEncoding());
+
+	newHit->SetKinEParent( _kinEPrimary );
+
+	newHit->SetTrackVolumeId(GetVolumeId(aTrack->GetVolume()));
+	newHit->SetParentVolumeId(GetVolumeId(aTrack->GetLogicalVolumeAtVertex()));
+
+	hitsCollection->insert(newHit);
+
+}
+
+/**
+ * Process and volume names are interned (AllPixNameTable), the hits keep the id.
+ * The few pointers seen by this SD are cached so the name is only
+ * looked up the first time.
+ */
+G4int AllPixTrackerSD::GetProcessId(const G4VProcess * p)
+{
+
+	unordered_map<const G4VProcess *, G4int>::iterator itr = m_processIds.find(p);
+	if (itr != m_processIds.end()) return (*itr).second;
+
+	G4int id = AllPixNameTable::GetInstance()->GetId(p->GetProcessName());
+	m_processIds[p] = id;
+
+	return id;
+}
+
+G4int AllPixTrackerSD::GetVolumeId(const G4VPhysicalVolume * v)
+{
+
+	unordered_map<const G4VPhysicalVolume *, G4int>::iterator itr = m_physVolumeIds.find(v);
+	if (itr != m_physVolumeIds.end()) return (*itr).second;
+
+	G4int id = AllPixNameTable::GetInstance()->GetId(v->GetName());
+	m_physVolumeIds[v] = id;
+
+	return id;
+}
+
+G4int AllPixTrackerSD::GetVolumeId(const G4LogicalVolume * v)
+{
+
+	unordered_map<const G4LogicalVolume *, G4int>::iterator itr = m_logVolumeIds.find(v);
+	if (itr != m_logVolumeIds.end()) return (*itr).second;
+
+	G4int id = AllPixNameTable::GetInstance()->GetId(v->GetName());
+	m_logVolumeIds[v] = id;
+
+	return id;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void AllPixTrackerSD::EndOfEvent(G4HCofThisEvent*)
 {
 
@@ -302,8 +585,10 @@ void AllPixTrackerSD::EndOfEvent(G4HCofThisEvent*)
 	//if(NbHits > 0)
 	//	G4cout << "--------> Hits Collection : " << collectionName[0] << " has " << NbHits << " hits " << G4endl;
 
+#ifdef ALLPIX_SD_CHECKS
 	// clear the Set of pointers to hitCollection used for verification
 	m_hitsCollectionSet.clear();
+#endif
 	firstStrikePrimary = false;
 	_totalEdep = 0.;
 	_kinEPrimary = 0.;
@@ -3,83 +3,78 @@
  */
 
 #include "AllPixWriteROOTFile.hh"
+#include "AllPixOutputQueue.hh"
+#include "AllPixOutputSettings.hh"
+
+#include <mutex>
+
+// records pool, taken by the simulation, given back by the writer
+static std::mutex g_recordsPoolMutex;
 
 AllPixWriteROOTFile::AllPixWriteROOTFile(Int_t detID, TString path)
 {
   detectorID=detID;
   G4cout << "nalipour AllPixWriteROOTFile" << G4endl;
   TString fileName=path+"/RD53_"+(TString)Form("%d", detID)+".root";
+  std::lock_guard<std::mutex> io(AllPixOutputQueue::GetInstance()->GetIOMutex());
   file = new TFile(fileName, "RECREATE");
+  AllPixOutputSettings::GetInstance()->ApplyTo(file);
   tree = new TTree("tree","tree data");
 
-  tree->Branch("posX", &posX);
-  tree->Branch("posY", &posY);
-  tree->Branch("energyTotal", &energyTotal);
-  tree->Branch("TOT", &TOT);
-  tree->Branch("energyMC", &energyMC);
-  tree->Branch("posX_WithRespectToPixel", &posX_WithRespectToPixel);
-  tree->Branch("posY_WithRespectToPixel", &posY_WithRespectToPixel);
-  tree->Branch("posZ_WithRespectToPixel", &posZ_WithRespectToPixel);
-/*
-  tree->Branch("nHits_MC", &nHits_MC);
-  tree->Branch("posX_MC", &posX_MC);
-  tree->Branch("posY_MC", &posY_MC);
-  tree->Branch("energy_MC", &energy_MC);
-
-  tree->Branch("nHits", &nHits);
-  tree->Branch("posX", &posX);
-  tree->Branch("posY", &posY);
-  tree->Branch("energy", &energy);
-  tree->Branch("TOT", &TOT);
-  */
+  m_out = new ROOTDataFormat(detID);
+  m_out->Branch(tree);
+  AllPixOutputSettings::GetInstance()->ApplyTo(tree);
 }
 
-void AllPixWriteROOTFile::AllPixWriteROOTFillTree()
+void AllPixWriteROOTFile::AllPixWriteROOTFillTree(ROOTDataFormat * d)
 {
-  file->cd();
-  tree->Fill();
+  ROOTDataFormat * rec = 0x0;
+  {
+    std::lock_guard<std::mutex> lock(g_recordsPoolMutex);
+    if(!m_pool.empty())
+      {
+	rec = m_pool.back();
+	m_pool.pop_back();
+      }
+  }
+  if(!rec) rec = new ROOTDataFormat(detectorID);
 
-  posX.clear();
-  posY.clear();
-  energyTotal.clear();
-  TOT.clear();
-  energyMC.clear();
-  posX_WithRespectToPixel.clear();
-  posY_WithRespectToPixel.clear();
-  posZ_WithRespectToPixel.clear();
-  /*
-  posX_MC.clear();
-  posY_MC.clear();
-  energy_MC.clear();
-  
+  // the vectors go to the record, d gets the record's empty ones
+  rec->Swap(d);
 
-  posX.clear();
-  posY.clear();
-  energy.clear();
-  TOT.clear();
-  */
+  AllPixOutputQueue::GetInstance()->Push([this, rec]{ WriteRecord(rec); });
 }
 
-void AllPixWriteROOTFile::SetVectors(ROOTDataFormat* d)
+/**
+ *  Output queue side, fill the tree with one record and recycle it.
+ */
+void AllPixWriteROOTFile::WriteRecord(ROOTDataFormat * rec)
 {
-	G4cout << "nalipour: SetVectors " << G4endl;
-	posX=d->get_posX();
-	posY=d->get_posY();
-	energyTotal=d->get_energyTotal();
-	energyMC=d->get_energyMC();
-	TOT=d->get_TOT();
-	posX_WithRespectToPixel=d->get_posX_WithRespectToPixel();
-	posY_WithRespectToPixel=d->get_posY_WithRespectToPixel();
-	posZ_WithRespectToPixel=d->get_posZ_WithRespectToPixel();
+  m_out->Swap(rec);
+
+  file->cd();
+  tree->Fill();
+
+  // rec now holds the previous entry, empty it for the next use
+  rec->Rewind();
+
+  std::lock_guard<std::mutex> lock(g_recordsPoolMutex);
+  m_pool.push_back(rec);
 }
 
 void AllPixWriteROOTFile::AllPixCloseROOTFile()
 {
   G4cout << "nalipour AllPixCloseROOTFile: detectorID=" << detectorID << G4endl;
+  AllPixOutputQueue::GetInstance()->Drain();
+  std::lock_guard<std::mutex> io(AllPixOutputQueue::GetInstance()->GetIOMutex());
   file->cd();
   tree->Write();
+  AllPixOutputSettings::GetInstance()->PrintSummary(tree, file->GetName(), G4cout);
   file->Close(); 
 }
 AllPixWriteROOTFile::~AllPixWriteROOTFile()
 {
+  for(size_t i = 0 ; i < m_pool.size() ; i++)
+    delete m_pool[i];
+  delete m_out;
 }
@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <iostream>
+#include <mutex>
 
 #include "AllPix_Frames_WriteToEntuple.h"
 #include "allpix_dm.h"
@@ -11,9 +12,15 @@
 // geometry
 #include "ReadGeoDescription.hh"
 
+#include "AllPixOutputQueue.hh"
+#include "AllPixOutputSettings.hh"
+
 static WriteToNtuple ** instance = 0;
 static Int_t * indexToDetectorIdMap = 0;
 
+// frames pool, taken by the simulation, given back by the writer
+static std::mutex g_framesPoolMutex;
+
 WriteToNtuple::WriteToNtuple(TString prefix, TString dataSet, TString tempScratchDir, Int_t detID, TString openmode /* default "RECREATE" */){
 
 	m_MPXDataSetNumber = dataSet;
@@ -37,19 +44,25 @@ WriteToNtuple::WriteToNtuple(TString prefix, TString dataSet, TString tempScratc
 	m_ntupleFileName += ".root";
 
 	nt = new TFile(m_ntupleFileName, openmode);
+	AllPixOutputSettings::GetInstance()->ApplyTo(nt);
 	t2 = new TTree("MPXTree","Medi/TimePix data");
 
 	// This instance of FrameStruct won't be stored
-	// it'll be overriden when calling WriteToNtuple::fillVars
+	// it'll be overriden when calling WriteToNtuple::fillVars.
+	// First buffer of the pool.
 	m_frame = new FrameStruct(m_MPXDataSetNumber);
-	t2->Branch("FramesData", "FrameStruct", &m_frame, 128000, 2);
+	t2->Branch("FramesData", "FrameStruct", &m_frame,
+			AllPixOutputSettings::GetInstance()->GetBasketSize(128000), 2);
+	AllPixOutputSettings::GetInstance()->ApplyTo(t2);
+	m_pool.push_back(m_frame);
 
 }
 
 WriteToNtuple::~WriteToNtuple(){
 
-	// deleting FrameStruct instance
-	delete m_frame;
+	// deleting FrameStruct instances, m_frame is one of them
+	for(size_t i = 0 ; i < m_pool.size() ; i++)
+		delete m_pool[i];
 
 }
 
@@ -67,8 +80,7 @@ WriteToNtuple * WriteToNtuple::GetInstance(TString prefix, TString dataset, TStr
 		indexToDetectorIdMap = new Int_t [nOfDetectors];
 
 		// Geo description
-		extern ReadGeoDescription * g_GeoDsc; // already loaded ! :)
-		map<int, AllPixGeoDsc *> * geoMap = g_GeoDsc->GetDetectorsMap();
+		map<int, AllPixGeoDsc *> * geoMap = ReadGeoDescription::GetInstance()->GetDetectorsMap(); // already loaded ! :)
 		map<int, AllPixGeoDsc *>::iterator detItr;
 
 		int cntr = 0;
@@ -77,7 +89,10 @@ WriteToNtuple * WriteToNtuple::GetInstance(TString prefix, TString dataset, TStr
 			tempDataset = dataset;
 			tempDataset += (*detItr).first; // append detector id
 
-			instance[cntr] = new WriteToNtuple(prefix, tempDataset, tempdir, (*detItr).first, openmode);
+			{
+				std::lock_guard<std::mutex> io(AllPixOutputQueue::GetInstance()->GetIOMutex());
+				instance[cntr] = new WriteToNtuple(prefix, tempDataset, tempdir, (*detItr).first, openmode);
+			}
 			indexToDetectorIdMap[cntr] = (*detItr).first;
 
 			cntr++;
@@ -105,21 +120,51 @@ WriteToNtuple * WriteToNtuple::GetInstance(TString prefix, TString dataset, TStr
 
 void WriteToNtuple::fillVars(FramesHandler * frameHandlerObj) {
 
+	// Copy the frame to a buffer of the pool for the output queue, the
+	//  handler is free for the next frame right away.
+	FrameStruct * buf = 0x0;
+	{
+		std::lock_guard<std::mutex> lock(g_framesPoolMutex);
+		if(!m_pool.empty()){
+			buf = m_pool.back();
+			m_pool.pop_back();
+		}
+	}
+	if(!buf) buf = new FrameStruct(m_MPXDataSetNumber);
+
+	*buf = *(frameHandlerObj->getFrameStructObject());
+	// clean up
+	frameHandlerObj->RewindAll();
+
+	AllPixOutputQueue::GetInstance()->Push([this, buf]{ writeFrame(buf); });
+
+}
+
+/**
+ *  Output queue side, fill the Tree with one frame and recycle it.
+ */
+void WriteToNtuple::writeFrame(FrameStruct * buf) {
+
 	// Variables(class) in the Tree
-	m_frame = frameHandlerObj->getFrameStructObject();
+	m_frame = buf;
 	// fill the Tree
 	nt->cd();
 	t2->Fill();
-	// clean up
-	frameHandlerObj->RewindAll();
+
+	std::lock_guard<std::mutex> lock(g_framesPoolMutex);
+	m_pool.push_back(buf);
 
 }
 
 void WriteToNtuple::closeNtuple()
 {
 
+	AllPixOutputQueue::GetInstance()->Drain();
+	std::lock_guard<std::mutex> io(AllPixOutputQueue::GetInstance()->GetIOMutex());
+
 	nt->cd();
 	t2->Write();
+	AllPixOutputSettings::GetInstance()->PrintSummary(t2, m_ntupleFileName, std::cout);
 	nt->Close();
 
 }
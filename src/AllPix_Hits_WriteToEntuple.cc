@@ -8,8 +8,45 @@
 
 #include "AllPix_Hits_WriteToEntuple.h"
 
+#include <TObjString.h>
+
+#include <mutex>
+
+#include "AllPixOutputQueue.hh"
+#include "AllPixOutputSettings.hh"
+
 static Hits_WriteToNtuple ** instance_hit = 0;
 int g_instance_hit_Cntr = 0;
+// the instances are asked for by every worker thread, every event
+static std::mutex g_instanceHitMutex;
+
+// output configuration, see SetFormat and SetColumns
+static bool g_hitsColumnar = false;
+static unsigned int g_hitsColumns = Hits_WriteToNtuple::kColAll;
+
+// initial size of the column arrays, grown as needed
+#define __hits_columns_capacity 64
+
+// buffers pool, taken by the simulation, given back by the writer
+static std::mutex g_hitsPoolMutex;
+
+static void swapHits(SimpleHits & a, SimpleHits & b){
+	std::swap(a.edepTotal, b.edepTotal);
+	std::swap(a.kinEParent, b.kinEParent);
+	a.interactions.swap(b.interactions);
+	a.pos.swap(b.pos);
+	a.pdgId.swap(b.pdgId);
+	a.edep.swap(b.edep);
+	a.trackId.swap(b.trackId);
+	a.parentId.swap(b.parentId);
+	a.trackVolumeName.swap(b.trackVolumeName);
+	a.parentVolumeName.swap(b.parentVolumeName);
+	a.processCode.swap(b.processCode);
+	a.trackVolumeCode.swap(b.trackVolumeCode);
+	a.parentVolumeCode.swap(b.parentVolumeCode);
+	std::swap(a.event, b.event);
+	std::swap(a.run, b.run);
+}
 
 Hits_WriteToNtuple::Hits_WriteToNtuple(TString prefix, TString dataSet, TString tempScratchDir,
 		Int_t /*detID*/, TString openmode /* default "RECREATE" */){
@@ -33,14 +70,117 @@ Hits_WriteToNtuple::Hits_WriteToNtuple(TString prefix, TString dataSet, TString
 	m_ntupleFileName += ".root";
 
 	nt = new TFile(m_ntupleFileName, openmode);
+	AllPixOutputSettings::GetInstance()->ApplyTo(nt);
 	t2 = new TTree("AllPixHits", dataSet);
 
 	m_storableHits = new SimpleHits;
 	m_storableHits->Rewind();
-	t2->Branch("SimpleHits", "SimpleHits", &m_storableHits);
+
+	m_columnar = g_hitsColumnar;
+	m_columns = g_hitsColumns;
+	m_capacity = 0;
+
+	if(!m_columnar){
+		t2->Branch("SimpleHits", "SimpleHits", &m_storableHits);
+		AllPixOutputSettings::GetInstance()->ApplyTo(t2);
+		return;
+	}
+
+	// columns format.  Per event scalars ...
+	t2->Branch("event", &m_event, "event/I");
+	t2->Branch("run", &m_run, "run/I");
+	t2->Branch("edepTotal", &m_edepTotal, "edepTotal/D");
+	t2->Branch("kinEParent", &m_kinEParent, "kinEParent/D");
+	t2->Branch("nHits", &m_nHits, "nHits/I");
+
+	// ... and per hit arrays of nHits entries.  Addresses are set
+	//  by growColumns.
+	growColumns(__hits_columns_capacity);
+	if(m_columns & kColX) t2->Branch("x", &m_x[0], "x[nHits]/F");
+	if(m_columns & kColY) t2->Branch("y", &m_y[0], "y[nHits]/F");
+	if(m_columns & kColZ) t2->Branch("z", &m_z[0], "z[nHits]/F");
+	if(m_columns & kColEdep) t2->Branch("edep", &m_edep[0], "edep[nHits]/F");
+	if(m_columns & kColPdg) t2->Branch("pdgId", &m_pdg[0], "pdgId[nHits]/I");
+	if(m_columns & kColTrack) t2->Branch("trackId", &m_track[0], "trackId[nHits]/I");
+	if(m_columns & kColParent) t2->Branch("parentId", &m_parent[0], "parentId[nHits]/I");
+	if(m_columns & kColProcess) t2->Branch("process", &m_process[0], "process[nHits]/s");
+	if(m_columns & kColTrackVolume) t2->Branch("trackVolume", &m_trackVolume[0], "trackVolume[nHits]/s");
+	if(m_columns & kColParentVolume) t2->Branch("parentVolume", &m_parentVolume[0], "parentVolume[nHits]/s");
+
+	AllPixOutputSettings::GetInstance()->ApplyTo(t2);
 
 }
 
+/**
+ *  Output format, "object" or "columns".  Applies to the files
+ *  opened afterwards.
+ */
+bool Hits_WriteToNtuple::SetFormat(TString format){
+
+	format.ToLower();
+	if(format == "object") g_hitsColumnar = false;
+	else if(format == "columns") g_hitsColumnar = true;
+	else {
+		std::cout << "[ERROR] (in Hits_WriteToNtuple::SetFormat) unknown hits format \"" << format
+				<< "\", use object or columns" << std::endl;
+		return false;
+	}
+
+	if(g_instance_hit_Cntr > 0)
+		std::cout << "[WARNING] (in Hits_WriteToNtuple::SetFormat) hits files already open, "
+				<< "the format applies to new files only" << std::endl;
+
+	return true;
+}
+
+/**
+ *  Per hit columns to write, space separated: x y z (or pos) edep pdgId
+ *  trackId parentId process trackVolume parentVolume, or all.
+ */
+bool Hits_WriteToNtuple::SetColumns(TString columns){
+
+	unsigned int mask = 0;
+	TObjArray * tokens = columns.Tokenize(" ,");
+	for(Int_t i = 0 ; i < tokens->GetEntriesFast() ; i++){
+		TString col = ((TObjString *) tokens->At(i))->GetString();
+		if(col == "all") mask |= kColAll;
+		else if(col == "pos") mask |= kColPos;
+		else if(col == "x") mask |= kColX;
+		else if(col == "y") mask |= kColY;
+		else if(col == "z") mask |= kColZ;
+		else if(col == "edep") mask |= kColEdep;
+		else if(col == "pdgId") mask |= kColPdg;
+		else if(col == "trackId") mask |= kColTrack;
+		else if(col == "parentId") mask |= kColParent;
+		else if(col == "process") mask |= kColProcess;
+		else if(col == "trackVolume") mask |= kColTrackVolume;
+		else if(col == "parentVolume") mask |= kColParentVolume;
+		else {
+			std::cout << "[ERROR] (in Hits_WriteToNtuple::SetColumns) unknown hits column \"" << col
+					<< "\"" << std::endl;
+			delete tokens;
+			return false;
+		}
+	}
+	delete tokens;
+
+	g_hitsColumns = mask;
+
+	if(g_instance_hit_Cntr > 0)
+		std::cout << "[WARNING] (in Hits_WriteToNtuple::SetColumns) hits files already open, "
+				<< "the selection applies to new files only" << std::endl;
+
+	return true;
+}
+
+bool Hits_WriteToNtuple::IsColumnar(){
+	return g_hitsColumnar;
+}
+
+bool Hits_WriteToNtuple::HasColumn(unsigned int col){
+	return (g_hitsColumns & col) != 0;
+}
+
 /**
  *  Delivers one instance per detector
  *
@@ -55,17 +195,19 @@ Hits_WriteToNtuple * Hits_WriteToNtuple::GetInstance(TString prefix, TString dat
 	}
 
 	TString tempDataset = dataset;
+	std::lock_guard<std::mutex> lock(g_instanceHitMutex);
 	if (instance_hit == 0){
 		// create pointers for all instances
-		instance_hit = new Hits_WriteToNtuple * [nOfInstances];
+		instance_hit = new Hits_WriteToNtuple * [nOfInstances]();
 	}
 
 	// but instanciate only once at a time
-	if(g_instance_hit_Cntr < nOfInstances)
+	if(!instance_hit[detID])
 	{
 		std::cout << "Creating hits file : "
 				<< "\"" << tempDataset
 				<< "\"" << std::endl;
+		std::lock_guard<std::mutex> io(AllPixOutputQueue::GetInstance()->GetIOMutex());
 		instance_hit[detID] = new Hits_WriteToNtuple(prefix, tempDataset, tempdir, detID, openmode);
 		g_instance_hit_Cntr++;
 	}
@@ -75,23 +217,238 @@ Hits_WriteToNtuple * Hits_WriteToNtuple::GetInstance(TString prefix, TString dat
 
 void Hits_WriteToNtuple::fillVars(SimpleHits * hits_i){
 
-	// Variables(class) in the Tree
-	m_storableHits = hits_i;
+	// Hand the event over to the output queue in a buffer of the pool.
+	//  hits_i gets the (empty) vectors of the buffer in exchange.
+	SimpleHits * buf = 0x0;
+	{
+		std::lock_guard<std::mutex> lock(g_hitsPoolMutex);
+		if(!m_pool.empty()){
+			buf = m_pool.back();
+			m_pool.pop_back();
+		}
+	}
+	if(!buf) buf = new SimpleHits;
+
+	swapHits(*buf, *hits_i);
+	hits_i->Rewind();
+
+	AllPixOutputQueue::GetInstance()->Push([this, buf]{ writeHits(buf); });
+
+}
+
+/**
+ *  Output queue side, fill the Tree with one event and recycle it.
+ */
+void Hits_WriteToNtuple::writeHits(SimpleHits * buf){
+
+	if(m_columnar){
+		fillColumns(buf);
+	} else {
+		// Variables(class) in the Tree
+		m_storableHits = buf;
+
+		// fill the Tree
+		nt->cd();
+		t2->Fill();
+	}
+
+	// clean up
+	buf->Rewind();
+	std::lock_guard<std::mutex> lock(g_hitsPoolMutex);
+	m_pool.push_back(buf);
+
+}
+
+/**
+ *  Columns format.  Copy one event in the column arrays and fill.
+ */
+void Hits_WriteToNtuple::fillColumns(SimpleHits * hits_i){
+
+	// all the filled vectors of an event have the same size
+	Int_t n = 0;
+	if(!hits_i->edep.empty()) n = (Int_t)hits_i->edep.size();
+	else if(!hits_i->pos.empty()) n = (Int_t)hits_i->pos.size();
+	else if(!hits_i->pdgId.empty()) n = (Int_t)hits_i->pdgId.size();
+	else if(!hits_i->trackId.empty()) n = (Int_t)hits_i->trackId.size();
+	else if(!hits_i->parentId.empty()) n = (Int_t)hits_i->parentId.size();
+	else if(!hits_i->processCode.empty()) n = (Int_t)hits_i->processCode.size();
+	else if(!hits_i->trackVolumeCode.empty()) n = (Int_t)hits_i->trackVolumeCode.size();
+	else n = (Int_t)hits_i->parentVolumeCode.size();
+
+	if(n > m_capacity) growColumns(n);
+
+	m_event = hits_i->event;
+	m_run = hits_i->run;
+	m_edepTotal = hits_i->edepTotal;
+	m_kinEParent = hits_i->kinEParent;
+	m_nHits = n;
+
+	// A selected column shorter or longer than the others is a bug in
+	//  the SD.  Said loudly, and the missing entries are zeroed so
+	//  nothing of the previous event is written.
+	Int_t m;
+	if(m_columns & kColPos){
+		m = columnSize(hits_i->pos.size(), n, "pos", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++){
+			m_x[i] = hits_i->pos[i].X();
+			m_y[i] = hits_i->pos[i].Y();
+			m_z[i] = hits_i->pos[i].Z();
+		}
+		for(Int_t i = m ; i < n ; i++) m_x[i] = m_y[i] = m_z[i] = 0.;
+	}
+	if(m_columns & kColEdep){
+		m = columnSize(hits_i->edep.size(), n, "edep", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_edep[i] = hits_i->edep[i];
+		for(Int_t i = m ; i < n ; i++) m_edep[i] = 0.;
+	}
+	if(m_columns & kColPdg){
+		m = columnSize(hits_i->pdgId.size(), n, "pdgId", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_pdg[i] = hits_i->pdgId[i];
+		for(Int_t i = m ; i < n ; i++) m_pdg[i] = 0;
+	}
+	if(m_columns & kColTrack){
+		m = columnSize(hits_i->trackId.size(), n, "trackId", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_track[i] = hits_i->trackId[i];
+		for(Int_t i = m ; i < n ; i++) m_track[i] = 0;
+	}
+	if(m_columns & kColParent){
+		m = columnSize(hits_i->parentId.size(), n, "parentId", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_parent[i] = hits_i->parentId[i];
+		for(Int_t i = m ; i < n ; i++) m_parent[i] = 0;
+	}
+	if(m_columns & kColProcess){
+		m = columnSize(hits_i->processCode.size(), n, "processCode", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_process[i] = hits_i->processCode[i];
+		for(Int_t i = m ; i < n ; i++) m_process[i] = 0;
+	}
+	if(m_columns & kColTrackVolume){
+		m = columnSize(hits_i->trackVolumeCode.size(), n, "trackVolumeCode", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_trackVolume[i] = hits_i->trackVolumeCode[i];
+		for(Int_t i = m ; i < n ; i++) m_trackVolume[i] = 0;
+	}
+	if(m_columns & kColParentVolume){
+		m = columnSize(hits_i->parentVolumeCode.size(), n, "parentVolumeCode", hits_i->event);
+		for(Int_t i = 0 ; i < m ; i++) m_parentVolume[i] = hits_i->parentVolumeCode[i];
+		for(Int_t i = m ; i < n ; i++) m_parentVolume[i] = 0;
+	}
 
-	// fill the Tree
 	nt->cd();
 	t2->Fill();
 
-	// clean up
-	m_storableHits->Rewind();
+}
+
+/**
+ *  Entries of a column to copy, n if it has the size of the others.
+ */
+Int_t Hits_WriteToNtuple::columnSize(size_t size, Int_t n, const char * column, Int_t event){
+
+	if((Int_t)size == n) return n;
 
+	std::cout << "[ERROR] (in Hits_WriteToNtuple::fillColumns) " << m_ntupleFileName << " event " << event
+			<< " : " << size << " " << column << " for " << n << " hits, cut or padded with zeros" << std::endl;
+
+	return (Int_t)size < n ? (Int_t)size : n;
+}
+
+/**
+ *  Make room for n hits.  The arrays may move, reset the branch
+ *  addresses.
+ */
+void Hits_WriteToNtuple::growColumns(Int_t n){
+
+	if(n < 2*m_capacity) n = 2*m_capacity;
+
+	m_x.resize(n);
+	m_y.resize(n);
+	m_z.resize(n);
+	m_edep.resize(n);
+	m_pdg.resize(n);
+	m_track.resize(n);
+	m_parent.resize(n);
+	m_process.resize(n);
+	m_trackVolume.resize(n);
+	m_parentVolume.resize(n);
+
+	// the branches are not there yet when called from the constructor
+	if(m_capacity > 0){
+		if(m_columns & kColX) t2->SetBranchAddress("x", &m_x[0]);
+		if(m_columns & kColY) t2->SetBranchAddress("y", &m_y[0]);
+		if(m_columns & kColZ) t2->SetBranchAddress("z", &m_z[0]);
+		if(m_columns & kColEdep) t2->SetBranchAddress("edep", &m_edep[0]);
+		if(m_columns & kColPdg) t2->SetBranchAddress("pdgId", &m_pdg[0]);
+		if(m_columns & kColTrack) t2->SetBranchAddress("trackId", &m_track[0]);
+		if(m_columns & kColParent) t2->SetBranchAddress("parentId", &m_parent[0]);
+		if(m_columns & kColProcess) t2->SetBranchAddress("process", &m_process[0]);
+		if(m_columns & kColTrackVolume) t2->SetBranchAddress("trackVolume", &m_trackVolume[0]);
+		if(m_columns & kColParentVolume) t2->SetBranchAddress("parentVolume", &m_parentVolume[0]);
+	}
+
+	m_capacity = n;
+
+}
+
+/**
+ *  Code of a process or volume name in this file.  Called by the
+ *  simulation threads once per name they see (see AllPixRun::RecordHits),
+ *  not per hit.
+ */
+UShort_t Hits_WriteToNtuple::GetProcessCode(const string & name){
+
+	std::lock_guard<std::mutex> lock(m_codesMutex);
+	return getCode(m_processCodes, m_processNames, name);
+}
+
+UShort_t Hits_WriteToNtuple::GetVolumeCode(const string & name){
+
+	std::lock_guard<std::mutex> lock(m_codesMutex);
+	return getCode(m_volumeCodes, m_volumeNames, name);
+}
+
+/**
+ *  Code of a name in a per file dictionary, new names get the next
+ *  code.  0xffff is left for the overflow.
+ */
+UShort_t Hits_WriteToNtuple::getCode(map<string, UShort_t> & codes, vector<string> & names, const string & name){
+
+	map<string, UShort_t>::iterator itr = codes.find(name);
+	if(itr != codes.end()) return itr->second;
+
+	if(names.size() >= 0xffff){
+		std::cout << "[WARNING] (in Hits_WriteToNtuple::getCode) too many names in " << m_ntupleFileName
+				<< ", \"" << name << "\" written as 0xffff" << std::endl;
+		codes[name] = 0xffff;
+		return 0xffff;
+	}
+
+	UShort_t code = (UShort_t) names.size();
+	codes[name] = code;
+	names.push_back(name);
+
+	return code;
 }
 
 void Hits_WriteToNtuple::closeNtuple()
 {
 
+	AllPixOutputQueue::GetInstance()->Drain();
+	std::lock_guard<std::mutex> io(AllPixOutputQueue::GetInstance()->GetIOMutex());
+
 	nt->cd();
 	t2->Write();
+	AllPixOutputSettings::GetInstance()->PrintSummary(t2, m_ntupleFileName, std::cout);
+
+	// columns format: names of the process and volume codes
+	if(m_columnar){
+		std::lock_guard<std::mutex> lock(m_codesMutex);
+		TTree * codes = new TTree("AllPixHitsCodes", "names of the process and volume codes, index = code");
+		vector<string> * processNames = &m_processNames;
+		vector<string> * volumeNames = &m_volumeNames;
+		codes->Branch("process", &processNames);
+		codes->Branch("volume", &volumeNames);
+		codes->Fill();
+		codes->Write();
+	}
+
 	nt->Close();
 
 }
@@ -115,6 +472,9 @@ void SimpleHits::Rewind(){
 	parentId.clear();
 	trackVolumeName.clear();
 	parentVolumeName.clear();
+	processCode.clear();
+	trackVolumeCode.clear();
+	parentVolumeCode.clear();
 
 	event = 0;
 	run = 0;
@@ -9,6 +9,54 @@ ROOTDataFormat::~ROOTDataFormat()
 {
 }
 
+void ROOTDataFormat::Merge(const ROOTDataFormat * d)
+{
+  posX.insert(posX.end(), d->posX.begin(), d->posX.end());
+  posY.insert(posY.end(), d->posY.begin(), d->posY.end());
+  energyTotal.insert(energyTotal.end(), d->energyTotal.begin(), d->energyTotal.end());
+  TOT.insert(TOT.end(), d->TOT.begin(), d->TOT.end());
+  energyMC.insert(energyMC.end(), d->energyMC.begin(), d->energyMC.end());
+  posX_WithRespectToPixel.insert(posX_WithRespectToPixel.end(), d->posX_WithRespectToPixel.begin(), d->posX_WithRespectToPixel.end());
+  posY_WithRespectToPixel.insert(posY_WithRespectToPixel.end(), d->posY_WithRespectToPixel.begin(), d->posY_WithRespectToPixel.end());
+  posZ_WithRespectToPixel.insert(posZ_WithRespectToPixel.end(), d->posZ_WithRespectToPixel.begin(), d->posZ_WithRespectToPixel.end());
+}
+
+void ROOTDataFormat::Swap(ROOTDataFormat * d)
+{
+  posX.swap(d->posX);
+  posY.swap(d->posY);
+  energyTotal.swap(d->energyTotal);
+  TOT.swap(d->TOT);
+  energyMC.swap(d->energyMC);
+  posX_WithRespectToPixel.swap(d->posX_WithRespectToPixel);
+  posY_WithRespectToPixel.swap(d->posY_WithRespectToPixel);
+  posZ_WithRespectToPixel.swap(d->posZ_WithRespectToPixel);
+}
+
+void ROOTDataFormat::Branch(TTree * t)
+{
+  t->Branch("posX", &posX);
+  t->Branch("posY", &posY);
+  t->Branch("energyTotal", &energyTotal);
+  t->Branch("TOT", &TOT);
+  t->Branch("energyMC", &energyMC);
+  t->Branch("posX_WithRespectToPixel", &posX_WithRespectToPixel);
+  t->Branch("posY_WithRespectToPixel", &posY_WithRespectToPixel);
+  t->Branch("posZ_WithRespectToPixel", &posZ_WithRespectToPixel);
+}
+
+void ROOTDataFormat::Rewind()
+{
+  posX.clear();
+  posY.clear();
+  energyTotal.clear();
+  TOT.clear();
+  energyMC.clear();
+  posX_WithRespectToPixel.clear();
+  posY_WithRespectToPixel.clear();
+  posZ_WithRespectToPixel.clear();
+}
+
 /*
 void ROOTDataFormat::set_posX_MC(vector<Int_t> vec)
 {
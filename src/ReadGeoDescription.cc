@@ -14,12 +14,38 @@
 #include <TString.h>
 
 #include <set>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
 using namespace std;
 
 
 // to be used as extern later
 ReadGeoDescription * g_GeoDsc;
 
+static string g_geoCacheDir = "";
+
+// FNV-1a 64 of the file contents, 0 if it can't be read
+static uint64_t hashFile(string file) {
+
+	FILE * f = fopen(file.c_str(), "rb");
+	if(!f) return 0;
+
+	uint64_t h = 14695981039346656037ULL;
+	char buf[1 << 16];
+	size_t n;
+	while((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+		for(size_t i = 0 ; i < n ; i++) {
+			h ^= (unsigned char)buf[i];
+			h *= 1099511628211ULL;
+		}
+	}
+	fclose(f);
+
+	return h;
+}
+
 ReadGeoDescription::ReadGeoDescription(string xmlFile){
 
 	if(g_GeoDsc){
@@ -40,20 +66,48 @@ ReadGeoDescription::ReadGeoDescription(string xmlFile){
 	m_unitsMap["m"] = CLHEP::m;
 
 	// list of expected tags
-	TDOMParser *domParser = new TDOMParser();
+	BuildListOfExpectedTags();
+	m_currentTag = 0x0;
 	m_firstIndx = -1;
+	m_xmlfile = xmlFile;
+
+	clock_t start = clock();
+
+	// the cache is only good for this very xml content
+	uint64_t xmlHash = hashFile(xmlFile);
+	string cacheFile = "";
+	if(g_geoCacheDir.length() > 0 && xmlHash != 0) {
+		string name = xmlFile.substr(xmlFile.find_last_of('/') + 1);
+		name = name.substr(0, name.find_last_of('.'));
+		char hashS[17];
+		snprintf(hashS, sizeof(hashS), "%016llx", (unsigned long long)xmlHash);
+		cacheFile = g_geoCacheDir + "/" + name + "_" + hashS + ".geocache";
+	}
+
+	G4bool fromCache = ReadCache(cacheFile, xmlHash);
 
-	domParser->SetValidate(false); // do not validate with DTD for now
-	domParser->ParseFile(xmlFile.c_str());
+	if(!fromCache) {
 
-	TXMLNode *node = domParser->GetXMLDocument()->GetRootNode();
+		TDOMParser *domParser = new TDOMParser();
 
-	// parse
-	ParseContext(node);
-	// apply requested replicas
-	ReplicateDetectors();
+		domParser->SetValidate(false); // do not validate with DTD for now
+		domParser->ParseFile(xmlFile.c_str());
 
-	cout << "Summary: read "<< (int)m_detsGeo.size() << " detectors from xml database " << endl;
+		TXMLNode *node = domParser->GetXMLDocument()->GetRootNode();
+
+		// parse
+		ParseContext(node);
+		// apply requested replicas
+		ReplicateDetectors();
+
+		delete domParser;
+
+		WriteCache(cacheFile, xmlHash);
+	}
+
+	cout << "Summary: read "<< (int)m_detsGeo.size() << " detectors from "
+			<< (fromCache ? "geometry cache " + cacheFile : "xml database") << " in "
+			<< (double)(clock() - start)/CLOCKS_PER_SEC << " s" << endl;
 	map<int, AllPixGeoDsc *>::iterator itr = m_detsGeo.begin();
 	for( ; itr != m_detsGeo.end() ; itr++){
 		(*itr).second->Dump();
@@ -133,8 +187,191 @@ G4int ReadGeoDescription::UseTheseDetectorsOnly(vector<G4int> useDetectors){
 	return nErased;
 }
 
+static ReadGeoTag intTag(void (AllPixGeoDsc::*set)(G4int)) {
+	ReadGeoTag t = { ReadGeoTag::kInt, set, 0x0, 0x0 };
+	return t;
+}
+
+// value in the units of the "units" attribute
+static ReadGeoTag lengthTag(void (AllPixGeoDsc::*set)(G4double)) {
+	ReadGeoTag t = { ReadGeoTag::kLength, 0x0, set, 0x0 };
+	return t;
+}
+
+static ReadGeoTag doubleTag(void (AllPixGeoDsc::*set)(G4double)) {
+	ReadGeoTag t = { ReadGeoTag::kDouble, 0x0, set, 0x0 };
+	return t;
+}
+
+static ReadGeoTag stringTag(void (AllPixGeoDsc::*set)(G4String)) {
+	ReadGeoTag t = { ReadGeoTag::kString, 0x0, 0x0, set };
+	return t;
+}
+
 void ReadGeoDescription::BuildListOfExpectedTags(){
 
+	m_tags[__npix_x_S] = intTag(&AllPixGeoDsc::SetNPixelsX);
+	m_tags[__npix_y_S] = intTag(&AllPixGeoDsc::SetNPixelsY);
+	m_tags[__npix_z_S] = intTag(&AllPixGeoDsc::SetNPixelsZ);
+
+	m_tags[__chip_hx_S] = lengthTag(&AllPixGeoDsc::SetChipHX);
+	m_tags[__chip_hy_S] = lengthTag(&AllPixGeoDsc::SetChipHY);
+	m_tags[__chip_hz_S] = lengthTag(&AllPixGeoDsc::SetChipHZ);
+	m_tags[__chip_posx_S] = lengthTag(&AllPixGeoDsc::SetChipPosX);
+	m_tags[__chip_posy_S] = lengthTag(&AllPixGeoDsc::SetChipPosY);
+	m_tags[__chip_posz_S] = lengthTag(&AllPixGeoDsc::SetChipPosZ);
+	m_tags[__chip_offsetx_S] = lengthTag(&AllPixGeoDsc::SetChipOffsetX);
+	m_tags[__chip_offsety_S] = lengthTag(&AllPixGeoDsc::SetChipOffsetY);
+	m_tags[__chip_offsetz_S] = lengthTag(&AllPixGeoDsc::SetChipOffsetZ);
+
+	m_tags[__pixsize_x_S] = lengthTag(&AllPixGeoDsc::SetPixSizeX);
+	m_tags[__pixsize_y_S] = lengthTag(&AllPixGeoDsc::SetPixSizeY);
+	m_tags[__pixsize_z_S] = lengthTag(&AllPixGeoDsc::SetPixSizeZ);
+
+	m_tags[__sensor_hx_S] = lengthTag(&AllPixGeoDsc::SetSensorHX);
+	m_tags[__sensor_hy_S] = lengthTag(&AllPixGeoDsc::SetSensorHY);
+	m_tags[__sensor_hz_S] = lengthTag(&AllPixGeoDsc::SetSensorHZ);
+	m_tags[__sensor_posx_S] = lengthTag(&AllPixGeoDsc::SetSensorPosX);
+	m_tags[__sensor_posy_S] = lengthTag(&AllPixGeoDsc::SetSensorPosY);
+	m_tags[__sensor_posz_S] = lengthTag(&AllPixGeoDsc::SetSensorPosZ);
+
+	m_tags[__pcb_hx_S] = lengthTag(&AllPixGeoDsc::SetPCBHX);
+	m_tags[__pcb_hy_S] = lengthTag(&AllPixGeoDsc::SetPCBHY);
+	m_tags[__pcb_hz_S] = lengthTag(&AllPixGeoDsc::SetPCBHZ);
+
+	m_tags[__sensor_gr_excess_htop_S] = lengthTag(&AllPixGeoDsc::SetSensorExcessHTop);
+	m_tags[__sensor_gr_excess_hbottom_S] = lengthTag(&AllPixGeoDsc::SetSensorExcessHBottom);
+	m_tags[__sensor_gr_excess_hright_S] = lengthTag(&AllPixGeoDsc::SetSensorExcessHRight);
+	m_tags[__sensor_gr_excess_hleft_S] = lengthTag(&AllPixGeoDsc::SetSensorExcessHLeft);
+
+	m_tags[__digitizer_S] = stringTag(&AllPixGeoDsc::SetSensorDigitizer);
+
+	m_tags[__sensor_Resistivity] = doubleTag(&AllPixGeoDsc::SetResistivity);
+	m_tags[__MIP_Tot_S] = intTag(&AllPixGeoDsc::SetMIPTot);
+	m_tags[__MIP_Charge_S] = doubleTag(&AllPixGeoDsc::SetMIPCharge);
+	m_tags[__Counter_Depth_S] = intTag(&AllPixGeoDsc::SetCounterDepth);
+	m_tags[__Clock_Unit_S] = doubleTag(&AllPixGeoDsc::SetClockUnit);
+	m_tags[__Chip_Noise_S] = doubleTag(&AllPixGeoDsc::SetChipNoise);
+	m_tags[__Chip_Threshold_S] = doubleTag(&AllPixGeoDsc::SetThreshold);
+	m_tags[__Cross_Talk_S] = doubleTag(&AllPixGeoDsc::SetCrossTalk);
+	m_tags[__Saturation_Energy_S] = doubleTag(&AllPixGeoDsc::SetSaturationEnergy);
+
+	m_tags[__Bump_Radius_S] = lengthTag(&AllPixGeoDsc::SetBumpRadius);
+	m_tags[__Bump_Height_S] = lengthTag(&AllPixGeoDsc::SetBumpHeight);
+	m_tags[__Bump_OffsetX_S] = lengthTag(&AllPixGeoDsc::SetBumpOffsetX);
+	m_tags[__Bump_OffsetY_S] = lengthTag(&AllPixGeoDsc::SetBumpOffsetY);
+	m_tags[__Bump_Dr_S] = lengthTag(&AllPixGeoDsc::SetBumpDr);
+
+}
+
+void ReadGeoDescription::SetCacheDir(string dir){
+
+	g_geoCacheDir = dir;
+
+}
+
+void ReadGeoDescription::SetFromTag(const ReadGeoTag & tag, const string & content){
+
+	AllPixGeoDsc * det = m_detsGeo[m_firstIndx];
+
+	// values read as float, as they always were
+	switch (tag.type)
+	{
+	case ReadGeoTag::kInt:
+		(det->*tag.setInt)(atoi(content.c_str()));
+		break;
+	case ReadGeoTag::kLength:
+		(det->*tag.setDouble)((float)atof(content.c_str())*m_unitsMap[m_currentAtt]);
+		break;
+	case ReadGeoTag::kDouble:
+		(det->*tag.setDouble)((float)atof(content.c_str()));
+		break;
+	case ReadGeoTag::kString:
+		(det->*tag.setString)(G4String(content.c_str()));
+		break;
+	}
+
+}
+
+bool ReadGeoDescription::ReadCache(string file, uint64_t xmlHash){
+
+	if(file.length() == 0) return false;
+
+	FILE * f = fopen(file.c_str(), "rb");
+	if(!f) return false;
+
+	AllPixGeoCacheHeader h;
+	bool ok = fread(&h, sizeof(h), 1, f) == 1
+			&& strncmp(h.magic, ALLPIX_GEOCACHE_MAGIC, sizeof(h.magic)) == 0
+			&& h.version == ALLPIX_GEOCACHE_VERSION
+			&& h.recordBytes == (int32_t)sizeof(AllPixGeoDscRecord)
+			&& h.xmlHash == xmlHash
+			&& h.nDetectors >= 0;
+
+	vector<AllPixGeoDscRecord> records(ok ? h.nDetectors : 0);
+	if(ok && h.nDetectors > 0)
+		ok = fread(&records[0], sizeof(AllPixGeoDscRecord), h.nDetectors, f) == (size_t)h.nDetectors;
+	fclose(f);
+
+	if(!ok) {
+		cout << "[WARNING] geometry cache " << file << " unusable, reading the xml database" << endl;
+		return false;
+	}
+
+	for(size_t i = 0 ; i < records.size() ; i++) {
+		records[i].digitizer[ALLPIX_GEODSC_DIGITIZER_SIZE - 1] = 0;
+		AllPixGeoDsc * det = new AllPixGeoDsc;
+		det->SetRecord(records[i]);
+		m_detsGeo[records[i].id] = det;
+	}
+
+	return true;
+}
+
+void ReadGeoDescription::WriteCache(string file, uint64_t xmlHash){
+
+	if(file.length() == 0) return;
+
+	vector<AllPixGeoDscRecord> records(m_detsGeo.size());
+	map<int, AllPixGeoDsc *>::iterator itr = m_detsGeo.begin();
+	for(size_t i = 0 ; itr != m_detsGeo.end() ; itr++, i++) {
+		if(!(*itr).second->GetRecord(records[i])) {
+			cout << "[WARNING] digitizer name of detector " << (*itr).first
+					<< " too long for the geometry cache, not written" << endl;
+			return;
+		}
+	}
+
+	AllPixGeoCacheHeader h;
+	memset(&h, 0, sizeof(h));
+	strncpy(h.magic, ALLPIX_GEOCACHE_MAGIC, sizeof(h.magic));
+	h.version = ALLPIX_GEOCACHE_VERSION;
+	h.recordBytes = sizeof(AllPixGeoDscRecord);
+	h.nDetectors = records.size();
+	h.xmlHash = xmlHash;
+
+	// jobs of a campaign may start together, each writes its own file and
+	//  renames it, readers never see a partial cache
+	char tmpS[32];
+	snprintf(tmpS, sizeof(tmpS), ".%d", (int)getpid());
+	string tmp = file + tmpS;
+
+	FILE * f = fopen(tmp.c_str(), "wb");
+	if(!f) {
+		cout << "[WARNING] can't write the geometry cache " << tmp << endl;
+		return;
+	}
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+	if(h.nDetectors > 0)
+		ok = ok && fwrite(&records[0], sizeof(AllPixGeoDscRecord), h.nDetectors, f) == (size_t)h.nDetectors;
+	ok = (fclose(f) == 0) && ok;
+
+	if(ok && rename(tmp.c_str(), file.c_str()) == 0) {
+		cout << "Geometry cache written: " << file << endl;
+	} else {
+		cout << "[WARNING] can't write the geometry cache " << file << endl;
+		remove(tmp.c_str());
+	}
 
 }
 
@@ -160,6 +397,10 @@ void ReadGeoDescription::ParseContext(TXMLNode *node)
 
 			m_currentNodeName = string(node->GetNodeName());
 
+			// one lookup per element, the text node below uses it
+			unordered_map<string, ReadGeoTag>::const_iterator tagItr = m_tags.find(m_currentNodeName);
+			m_currentTag = tagItr == m_tags.end() ? 0x0 : &(tagItr->second);
+
 			//cout << m_currentNodeName << endl;
 
 			/*
@@ -228,258 +469,12 @@ void ReadGeoDescription::ParseContext(TXMLNode *node)
 			tempContent = string(node->GetContent());
 
 			//if(m_detsGeoIndx[__FIRST_DET_INDX] > -1 && StringIsRelevant(tempContent)){
-			if(StringIsRelevant(tempContent)){
-
-				if(m_currentNodeName == __npix_x_S) {
-
-					int val = atoi(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetNPixelsX(val);
-
-				}else if(m_currentNodeName == __npix_y_S){
-
-					int val = atoi(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetNPixelsY(val);
-
-				}else if(m_currentNodeName == __npix_z_S){
-
-					int val = atoi(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetNPixelsZ(val);
-
-				}else if(m_currentNodeName == __chip_hx_S){
-
-					float val = atof(tempContent.c_str());
-
-					m_detsGeo[m_firstIndx]->SetChipHX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_hy_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipHY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_hz_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipHZ(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_posx_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipPosX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_posy_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipPosY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_posz_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipPosZ(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_offsetx_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipOffsetX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_offsety_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipOffsetY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __chip_offsetz_S){
+			if(m_currentTag && StringIsRelevant(tempContent)){
 
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipOffsetZ(val*m_unitsMap[m_currentAtt]);
+				SetFromTag(*m_currentTag, tempContent);
 
-				}else if(m_currentNodeName == __pixsize_x_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetPixSizeX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __pixsize_y_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetPixSizeY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __pixsize_z_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetPixSizeZ(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_hx_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorHX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_hy_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorHY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_hz_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorHZ(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_posx_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorPosX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_posy_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorPosY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_posz_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorPosZ(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __pcb_hx_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetPCBHX(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __pcb_hy_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetPCBHY(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __pcb_hz_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetPCBHZ(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_gr_excess_htop_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorExcessHTop(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_gr_excess_hbottom_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorExcessHBottom(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_gr_excess_hright_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorExcessHRight(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __sensor_gr_excess_hleft_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorExcessHLeft(val*m_unitsMap[m_currentAtt]);
-
-				}else if(m_currentNodeName == __digitizer_S){
-
-					G4String valS(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSensorDigitizer(valS);
-
-				}
-	
-				else if(m_currentNodeName == __sensor_Resistivity){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetResistivity(val);
-
-				}				
-				
-				
-				else if(m_currentNodeName == __MIP_Tot_S){
-
-					float val = atoi(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetMIPTot(val);
-
-				}
-				
-				else if(m_currentNodeName == __MIP_Charge_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetMIPCharge(val);
-
-				}
-								
-				else if(m_currentNodeName == __Counter_Depth_S){
-
-					float val = atoi(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetCounterDepth(val);
-
-				}				
-
-				else if(m_currentNodeName == __Clock_Unit_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetClockUnit(val);
-
-				}					
-				
-				else if(m_currentNodeName == __Chip_Noise_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetChipNoise(val);
-
-				}
-
-				else if(m_currentNodeName == __Chip_Threshold_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetThreshold(val);
-
-				}
-				
-				else if(m_currentNodeName == __Cross_Talk_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetCrossTalk(val);
-
-				}
-								
-
-				else if(m_currentNodeName == __Saturation_Energy_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetSaturationEnergy(val);
-
-				}
-								
-				else if(m_currentNodeName == __Bump_Radius_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetBumpRadius(val*m_unitsMap[m_currentAtt]);
-
-				}
-				
-				else if(m_currentNodeName == __Bump_Height_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetBumpHeight(val*m_unitsMap[m_currentAtt]);
-
-				}
-				
-				else if(m_currentNodeName == __Bump_OffsetX_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetBumpOffsetX(val*m_unitsMap[m_currentAtt]);
-
-				}
-
-				else if(m_currentNodeName == __Bump_OffsetY_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetBumpOffsetY(val*m_unitsMap[m_currentAtt]);
-
-				}
-
-				else if(m_currentNodeName == __Bump_Dr_S){
-
-					float val = atof(tempContent.c_str());
-					m_detsGeo[m_firstIndx]->SetBumpDr(val*m_unitsMap[m_currentAtt]);
-
-				}
-				
 			}
-			
+
 			/*
 			if(StringIsRelevant(tempContent))
 				cout << "+" << tempContent << "-" << endl;
@@ -556,8 +551,7 @@ void ReadGeoDescription::ReplicateDetectors(){
 
 bool ReadGeoDescription::StringIsRelevant(string s){
 
-	TString t(s);
-	if(t.Contains('\n') || t.Contains('\t'))
+	if(s.find_first_of("\n\t") != string::npos)
 		return false;
 
 	return true;
@@ -5,11 +5,14 @@
 
 #include <fstream>
 #include <istream>
+#include <sstream>
+#include <algorithm>
 
 #include <string>
 #include "TH2.h"
 
 #include "allpix_dm.h"
+#include "AllPixFrameFile.hh"
 
 using namespace std;
 
@@ -26,15 +29,48 @@ FrameContainer::FrameContainer(){
 
 }
 
+// optional arrays get the size of the index the first time they are used
+template <class T>
+static void widen(std::vector<T> & v, size_t n) {
+	if(v.empty()) v.resize(n, 0);
+}
+
+template <class T>
+static void insertZero(std::vector<T> & v, size_t pos) {
+	if(!v.empty()) v.insert(v.begin() + pos, 0);
+}
+
+size_t FrameContainer::PixelPosition(Int_t X, Bool_t & added){
+
+	added = false;
+
+	// pixels mostly come in ascending order, appended
+	size_t pos = m_pixelIndex.size();
+	if(!m_pixelIndex.empty() && m_pixelIndex.back() >= X) {
+		pos = std::lower_bound(m_pixelIndex.begin(), m_pixelIndex.end(), X) - m_pixelIndex.begin();
+		if(m_pixelIndex[pos] == X) return pos;
+	}
+
+	m_pixelIndex.insert(m_pixelIndex.begin() + pos, X);
+	m_pixelCounts.insert(m_pixelCounts.begin() + pos, 0);
+	insertZero(m_pixelLVL1, pos);
+	insertZero(m_pixelTruthE, pos);
+	insertZero(m_pixelE, pos);
+	added = true;
+
+	return pos;
+}
+
 void FrameContainer::FillOneElement(Int_t xi, Int_t yi, Int_t width, Int_t counts) {
 
 	// X,Y,C --> X,C : yi*width + xi
-	Int_t X = yi*width + xi;
+	Bool_t added;
+	size_t pos = PixelPosition(yi*width + xi, added);
 
-	m_frameXC[X] += counts;        // TOT or count(binary detector)
+	m_pixelCounts[pos] += counts;  // TOT or count(binary detector)
 
 	// If the pixel didn't exist this is an extra entry
-	if(m_frameXC.find(X) == m_frameXC.end()) m_nEntriesPad++;
+	if(added) m_nEntriesPad++;
 	// But always an extra hit
 	m_nHitsInPad++;
 	// Increase the total counts
@@ -48,10 +84,13 @@ void FrameContainer::FillOneElement(Int_t xi, Int_t yi, Int_t width, Int_t count
 	FillOneElement(xi, yi, width, counts);
 
 	// X,Y,C --> X,C : yi*width + xi
-	Int_t X = yi*width + xi;
+	Bool_t added;
+	size_t pos = PixelPosition(yi*width + xi, added);
 
-	m_frameXC_TruthE[X] += truthE; // Truth energy
-	m_frameXC_E[X] += E;           // Energy with detector effects
+	widen(m_pixelTruthE, m_pixelIndex.size());
+	widen(m_pixelE, m_pixelIndex.size());
+	m_pixelTruthE[pos] += truthE;  // Truth energy
+	m_pixelE[pos] += E;            // Energy with detector effects
 
 }
 
@@ -74,9 +113,129 @@ void FrameContainer::FillOneElement(Int_t xi, Int_t yi, Int_t width, Int_t count
 void FrameContainer::SetLVL1(Int_t xi, Int_t yi, Int_t width, Int_t lvl1){
 
 	// X,Y,C --> X,C : yi*width + xi
-	Int_t X = yi*width + xi;
+	Bool_t added;
+	size_t pos = PixelPosition(yi*width + xi, added);
+
+	widen(m_pixelLVL1, m_pixelIndex.size());
+	m_pixelLVL1[pos] += lvl1;
+}
+
+// value of the optional array at i, 0 if the array is empty
+template <class T>
+static T valueAt(const std::vector<T> & v, size_t i) {
+	return v.empty() ? 0 : v[i];
+}
+
+/**
+ *  Both sides sorted, one linear pass into new arrays.
+ */
+void FrameContainer::Merge(const FrameContainer & right){
+
+	size_t nl = m_pixelIndex.size(), nr = right.m_pixelIndex.size();
+	Bool_t withLVL1 = !m_pixelLVL1.empty() || !right.m_pixelLVL1.empty();
+	Bool_t withTruthE = !m_pixelTruthE.empty() || !right.m_pixelTruthE.empty();
+	Bool_t withE = !m_pixelE.empty() || !right.m_pixelE.empty();
+
+	std::vector<Int_t> index, counts, lvl1;
+	std::vector<Double_t> truthE, E;
+	index.reserve(nl + nr);
+	counts.reserve(nl + nr);
+
+	size_t l = 0, r = 0;
+	while(l < nl || r < nr) {
+		Bool_t takeL = l < nl && (r >= nr || m_pixelIndex[l] <= right.m_pixelIndex[r]);
+		Bool_t takeR = r < nr && (l >= nl || right.m_pixelIndex[r] <= m_pixelIndex[l]);
+		index.push_back(takeL ? m_pixelIndex[l] : right.m_pixelIndex[r]);
+		counts.push_back((takeL ? m_pixelCounts[l] : 0) + (takeR ? right.m_pixelCounts[r] : 0));
+		if(withLVL1) lvl1.push_back((takeL ? valueAt(m_pixelLVL1, l) : 0) + (takeR ? valueAt(right.m_pixelLVL1, r) : 0));
+		if(withTruthE) truthE.push_back((takeL ? valueAt(m_pixelTruthE, l) : 0) + (takeR ? valueAt(right.m_pixelTruthE, r) : 0));
+		if(withE) E.push_back((takeL ? valueAt(m_pixelE, l) : 0) + (takeR ? valueAt(right.m_pixelE, r) : 0));
+		if(takeL) l++;
+		if(takeR) r++;
+	}
+
+	m_pixelIndex.swap(index);
+	m_pixelCounts.swap(counts);
+	m_pixelLVL1.swap(lvl1);
+	m_pixelTruthE.swap(truthE);
+	m_pixelE.swap(E);
+
+	m_nEntriesPad += right.m_nEntriesPad;
+	m_nHitsInPad += right.m_nHitsInPad;
+	m_nChargeInPad += right.m_nChargeInPad;
+	m_isMCData = m_isMCData || right.m_isMCData;
+
+}
+
+/**
+ *  Pixels come sorted, into an empty frame they are copied as they
+ *  are.
+ */
+void FrameContainer::FillZeroSuppressed(const UInt_t * index, const UShort_t * counts, Int_t n){
+
+	if(m_pixelIndex.empty()) {
+		m_pixelIndex.assign(index, index + n);
+		m_pixelCounts.assign(counts, counts + n);
+		m_pixelLVL1.clear();
+		m_pixelTruthE.clear();
+		m_pixelE.clear();
+		for(Int_t i = 0 ; i < n ; i++) m_nChargeInPad += counts[i];
+	} else {
+		Bool_t added;
+		for(Int_t i = 0 ; i < n ; i++) {
+			m_pixelCounts[PixelPosition(index[i], added)] += counts[i];
+			m_nChargeInPad += counts[i];
+		}
+	}
+
+	m_nEntriesPad += n;
+	m_nHitsInPad += n;
+
+}
+
+void FrameContainer::GetPixels(std::vector<UInt_t> & index, std::vector<Int_t> & counts) const {
+
+	index.clear();
+	counts.clear();
+
+	for(size_t i = 0 ; i < m_pixelIndex.size() ; i++) {
+		if(m_pixelCounts[i] == 0) continue;
+		index.push_back(m_pixelIndex[i]);
+		counts.push_back(m_pixelCounts[i]);
+	}
+
+}
+
+/**
+ *  Old files: the four maps don't necessarily have the same pixels,
+ *  the arrays get the union of them.
+ */
+void FrameContainer::FillFromMaps(const std::map<int, int> & xc, const std::map<int, int> & lvl1,
+		const std::map<int, int> & truthE, const std::map<int, int> & E){
+
+	CleanUpMatrix();
+
+	std::map<int, int>::const_iterator itr;
+	Bool_t added;
+	for(itr = xc.begin() ; itr != xc.end() ; itr++)
+		m_pixelCounts[PixelPosition((*itr).first, added)] = (*itr).second;
+	if(!lvl1.empty()) {
+		for(itr = lvl1.begin() ; itr != lvl1.end() ; itr++) PixelPosition((*itr).first, added);
+		widen(m_pixelLVL1, m_pixelIndex.size());
+		for(itr = lvl1.begin() ; itr != lvl1.end() ; itr++)
+			m_pixelLVL1[PixelPosition((*itr).first, added)] = (*itr).second;
+	}
+	if(!truthE.empty() || !E.empty()) {
+		for(itr = truthE.begin() ; itr != truthE.end() ; itr++) PixelPosition((*itr).first, added);
+		for(itr = E.begin() ; itr != E.end() ; itr++) PixelPosition((*itr).first, added);
+		widen(m_pixelTruthE, m_pixelIndex.size());
+		widen(m_pixelE, m_pixelIndex.size());
+		for(itr = truthE.begin() ; itr != truthE.end() ; itr++)
+			m_pixelTruthE[PixelPosition((*itr).first, added)] = (*itr).second;
+		for(itr = E.begin() ; itr != E.end() ; itr++)
+			m_pixelE[PixelPosition((*itr).first, added)] = (*itr).second;
+	}
 
-	m_lvl1[X] += lvl1;
 }
 
 void FrameContainer::ResetCountersPad(){
@@ -148,6 +307,16 @@ void FrameStruct::SetPrimaryVertex(Double_t vx, Double_t vy, Double_t vz){
 
 }
 
+void FrameStruct::Merge(const FrameStruct & right){
+
+	FrameContainer::Merge(right);
+
+	m_primaryVertex_x.insert(m_primaryVertex_x.end(), right.m_primaryVertex_x.begin(), right.m_primaryVertex_x.end());
+	m_primaryVertex_y.insert(m_primaryVertex_y.end(), right.m_primaryVertex_y.begin(), right.m_primaryVertex_y.end());
+	m_primaryVertex_z.insert(m_primaryVertex_z.end(), right.m_primaryVertex_z.begin(), right.m_primaryVertex_z.end());
+
+}
+
 void FrameStruct::FillMetaData(TString METAString, Int_t metaCode){
 
 	TString tempEntry = "";
@@ -324,11 +493,11 @@ Int_t FramesHandler::IdentifyTypeOfInput(TString fullDSCFileName){
 }
 
 void FrameContainer::CleanUpMatrix(){
-	m_frameXC.clear();
-	m_lvl1.clear();
-	m_frameXC_TruthE.clear();
-	//m_frameXC_TruthE_multiThl.clear();
-	m_frameXC_E.clear();
+	m_pixelIndex.clear();
+	m_pixelCounts.clear();
+	m_pixelLVL1.clear();
+	m_pixelTruthE.clear();
+	m_pixelE.clear();
 }
 
 /* Rewind frame and metadata */
@@ -343,8 +512,17 @@ void FramesHandler::RewindAll(){
 
 }
 
+void FramesHandler::Merge(FramesHandler * right){
+
+	m_aFrame->Merge(*(right->getFrameStructObject()));
+
+}
+
 Bool_t FramesHandler::readOneFrame(TString fullFileName, TString fullDSCFileName){
 
+	if(AllPixFrameFile::IsFrameFile(fullFileName.Data()))
+		return readOneFrameZS(fullFileName, fullDSCFileName);
+
 	RewindAll();
 	m_aFrame->IncreaseId(); // the first time it'll come to 0 (initialized at -1)
 	m_nFrames++;
@@ -618,26 +796,13 @@ Bool_t FramesHandler::readOneFrame(TString fullFileName, TString fullDSCFileName
 
 	// Now fetching MetaData
 	fstream META_filestr;
-	Int_t nLineMetaFile = 0;
 	META_filestr.exceptions ( ifstream::eofbit | ifstream::failbit | ifstream::badbit );
 
 	// read metadata
 	try {
 
 		META_filestr.open(fullDSCFileName, fstream::in);
-
-		Char_t * METAtemp;
-		METAtemp = new char[META_DATA_LINE_SIZE];
-
-		while (META_filestr.good()){
-			META_filestr.getline(METAtemp, META_DATA_LINE_SIZE);
-			if(m_ParseAndHold) parseMetaLine((TString)METAtemp, nLineMetaFile); // pass currentLine
-
-			if(nLineMetaFile++ == m_metaBit){
-				m_aFrame->FillMetaData((TString)METAtemp, m_metaCode);
-				m_ParseAndHold = true;
-			}
-		}
+		readMetaData(META_filestr);
 	}
 	catch (ifstream::failure &e){
 		//std::cout << "[ERROR] Exception opening/reading file: " << fullDSCFileName << std::endl;
@@ -649,6 +814,67 @@ Bool_t FramesHandler::readOneFrame(TString fullFileName, TString fullDSCFileName
 	return true;
 }
 
+/**
+ *  Zero suppressed binary frame, mmap'ed.  The pixels are copied as
+ *  they are stored, no parsing.  The metadata comes from the .dsc if
+ *  given, else from the copy of the .dsc stored in the frame file.
+ */
+Bool_t FramesHandler::readOneFrameZS(TString fullFileName, TString fullDSCFileName){
+
+	RewindAll();
+	m_aFrame->IncreaseId(); // the first time it'll come to 0 (initialized at -1)
+	m_nFrames++;
+
+	AllPixFrameFile frameFile;
+	if(!frameFile.Open(fullFileName.Data()))
+	{
+		std::cout << "[ERROR] could not read the frame file --> " << fullFileName << std::endl;
+		exit(1);
+	}
+
+	std::cout << "[INFO] opening: " << fullFileName << " --> zero suppressed, "
+			<< frameFile.GetNPixels() << " pixels" << std::endl;
+
+	SetnX(frameFile.GetWidth());
+	SetnY(frameFile.GetHeight());
+	m_aFrame->FillZeroSuppressed(frameFile.GetIndex(), frameFile.GetCounts(), frameFile.GetNPixels());
+
+	std::istringstream embeddedMeta(frameFile.GetMetaData());
+	fstream META_filestr;
+	std::istream * meta = &embeddedMeta;
+	if(fullDSCFileName.Length() > 0)
+	{
+		META_filestr.open(fullDSCFileName, fstream::in);
+		if(META_filestr.is_open()) meta = &META_filestr;
+	}
+
+	meta->exceptions ( ifstream::eofbit | ifstream::failbit | ifstream::badbit );
+	try {
+		readMetaData(*meta);
+	}
+	catch (ifstream::failure &e){
+	}
+
+	return true;
+}
+
+void FramesHandler::readMetaData(std::istream & META_filestr){
+
+	Int_t nLineMetaFile = 0;
+	Char_t METAtemp[META_DATA_LINE_SIZE];
+
+	while (META_filestr.good()){
+		META_filestr.getline(METAtemp, META_DATA_LINE_SIZE);
+		if(m_ParseAndHold) parseMetaLine((TString)METAtemp, nLineMetaFile); // pass currentLine
+
+		if(nLineMetaFile++ == m_metaBit){
+			m_aFrame->FillMetaData((TString)METAtemp, m_metaCode);
+			m_ParseAndHold = true;
+		}
+	}
+
+}
+
 void FramesHandler::push_back_nbytes(unsigned int * val, char * bytes, Int_t nbytes) {
 
 	// indexes go like this
@@ -0,0 +1,97 @@
+/**
+ *  Bending of the primary track between two planes (columns format).
+ *
+ *  allpix-test-bfield <dx min> <dx max> <hits file 0> <hits file 1>
+ *
+ *  Per event, the mean x of the hits of the primary (trackId 1) in each
+ *  plane.  Returns 0 if the mean of x1 - x0 over the events seen in both
+ *  planes is within [dx min, dx max], in mm.
+ */
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <iostream>
+#include <map>
+#include <cstdlib>
+
+using namespace std;
+
+#define __max_hits 4096
+
+// run, event -> mean x of the primary [mm]
+static bool primaryX(const char * name, map<pair<Int_t, Int_t>, Double_t> & xs) {
+
+	TFile f(name, "READ");
+	TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("AllPixHits");
+	if(!t || !t->GetBranch("x") || !t->GetBranch("trackId")) {
+		cout << "[ERROR] no AllPixHits tree with x and trackId in " << name << endl;
+		return false;
+	}
+
+	Int_t run = 0, event = 0, nHits = 0;
+	static Float_t x[__max_hits];
+	static Int_t trackId[__max_hits];
+	t->SetBranchAddress("run", &run);
+	t->SetBranchAddress("event", &event);
+	t->SetBranchAddress("nHits", &nHits);
+	t->SetBranchAddress("x", x);
+	t->SetBranchAddress("trackId", trackId);
+
+	for(Long64_t i = 0 ; i < t->GetEntries() ; i++) {
+		t->GetEntry(i);
+		if(nHits > __max_hits) {
+			cout << "[ERROR] " << nHits << " hits in event " << event << " of " << name << endl;
+			return false;
+		}
+		Double_t sum = 0.;
+		Int_t n = 0;
+		for(Int_t h = 0 ; h < nHits ; h++) {
+			if(trackId[h] != 1) continue;
+			sum += x[h];
+			n++;
+		}
+		if(n) xs[make_pair(run, event)] = sum/n;
+	}
+
+	return true;
+}
+
+int main(int argc, char ** argv){
+
+	if(argc != 5) {
+		cout << "usage: " << argv[0] << " <dx min> <dx max> <hits file 0> <hits file 1>" << endl;
+		return 1;
+	}
+
+	Double_t dxMin = atof(argv[1]);
+	Double_t dxMax = atof(argv[2]);
+
+	map<pair<Int_t, Int_t>, Double_t> x0, x1;
+	if(!primaryX(argv[3], x0) || !primaryX(argv[4], x1)) return 1;
+
+	Double_t sum = 0.;
+	Int_t n = 0;
+	map<pair<Int_t, Int_t>, Double_t>::iterator itr = x0.begin();
+	for( ; itr != x0.end() ; itr++) {
+		map<pair<Int_t, Int_t>, Double_t>::iterator itr1 = x1.find(itr->first);
+		if(itr1 == x1.end()) continue;
+		sum += itr1->second - itr->second;
+		n++;
+	}
+
+	if(!n) {
+		cout << "[ERROR] no event with the primary in both planes" << endl;
+		return 1;
+	}
+
+	Double_t dx = sum/n;
+	cout << n << " events, mean x1 - x0 = " << dx << " mm, expected in [" << dxMin << ", " << dxMax << "]" << endl;
+
+	if(!(dx >= dxMin && dx <= dxMax)) {
+		cout << "[ERROR] the primary is not bent as expected" << endl;
+		return 1;
+	}
+
+	return 0;
+}
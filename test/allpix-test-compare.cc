@@ -0,0 +1,165 @@
+/**
+ *  Compares two detectors crossed by the same tracks, simulated two
+ *  different ways (pixel volumes against single sensitive box, full
+ *  simulation against AllPixFastPlaneModel).
+ *
+ *  allpix-test-compare [-t tolerance] <frames A> <frames B> <hits A> <hits B>
+ *
+ *  From the hits files (AllPixHits, edepTotal): the MPV (Landau fit),
+ *  the median and the mean below 3 x median of the energy deposited per
+ *  event.  From the frames files (MPXTree, one track per frame): the
+ *  mean number of pixels of the frames with pixels, i.e. the cluster
+ *  size.  Every one of them must agree within the relative tolerance
+ *  (default 0.1).  Returns 0 if so.
+ */
+
+#include "allpix_dm.h"
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TLeaf.h>
+#include <TH1D.h>
+#include <TF1.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace std;
+
+struct Summary {
+	Long64_t events;
+	Long64_t withHits;
+	double mpv;
+	double median;
+	double truncatedMean;
+	Long64_t frames;
+	Long64_t withPixels;
+	double clusterSize;
+};
+
+static bool readHits(const char * file, Summary & s) {
+
+	TFile f(file, "READ");
+	TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("AllPixHits");
+	TLeaf * leaf = t ? t->GetLeaf("edepTotal") : 0x0;
+	if(!leaf) {
+		cout << "[ERROR] no AllPixHits tree with edepTotal in " << file << endl;
+		return false;
+	}
+
+	vector<double> edep;
+	s.events = t->GetEntries();
+	for(Long64_t e = 0 ; e < s.events ; e++) {
+		leaf->GetBranch()->GetEntry(e);
+		double v = leaf->GetValue();
+		if(v > 0.) edep.push_back(v);
+	}
+	s.withHits = edep.size();
+	if(edep.empty()) {
+		cout << "[ERROR] no energy deposited in " << file << endl;
+		return false;
+	}
+
+	vector<double> sorted(edep);
+	std::sort(sorted.begin(), sorted.end());
+	s.median = sorted[sorted.size()/2];
+
+	double sum = 0.;
+	size_t n = 0;
+	for(size_t i = 0 ; i < edep.size() ; i++)
+		if(edep[i] < 3.*s.median) { sum += edep[i]; n++; }
+	s.truncatedMean = n ? sum/n : 0.;
+
+	// Landau around the peak
+	TH1D h("edep", "edep", 60, 0., 3.*s.median);
+	h.SetDirectory(0);
+	for(size_t i = 0 ; i < edep.size() ; i++) h.Fill(edep[i]);
+	TF1 landau("landauEdep", "landau", 0.3*s.median, 3.*s.median);
+	landau.SetParameters(h.GetMaximum(), s.median, 0.1*s.median);
+	h.Fit(&landau, "QNR");
+	s.mpv = landau.GetParameter(1);
+
+	return true;
+}
+
+static bool readFrames(const char * file, Summary & s) {
+
+	TFile f(file, "READ");
+	TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("MPXTree");
+	if(!t) {
+		cout << "[ERROR] no MPXTree in " << file << endl;
+		return false;
+	}
+
+	FrameStruct * frame = new FrameStruct("");
+	t->SetBranchAddress("FramesData", &frame);
+	s.frames = t->GetEntries();
+	s.withPixels = 0;
+	double sum = 0.;
+	vector<UInt_t> index;
+	vector<Int_t> counts;
+	for(Long64_t e = 0 ; e < s.frames ; e++) {
+		t->GetEntry(e);
+		frame->GetPixels(index, counts);
+		if(index.empty()) continue;
+		s.withPixels++;
+		sum += index.size();
+	}
+	s.clusterSize = s.withPixels ? sum/s.withPixels : 0.;
+	t->ResetBranchAddresses();
+	delete frame;
+
+	return true;
+}
+
+static int check(const char * what, double a, double b, double tolerance) {
+
+	double d = fabs(a - b)/(0.5*fabs(a + b));
+	cout << setw(20) << what << setw(14) << a << setw(14) << b << setw(10) << d << endl;
+	if(d > tolerance || !(a > 0.) || !(b > 0.)) {
+		cout << "[ERROR] " << what << " differ by more than " << tolerance << endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char ** argv){
+
+	double tolerance = 0.1;
+	vector<const char *> files;
+
+	for(int i = 1 ; i < argc ; i++) {
+		if(!strcmp(argv[i], "-t") && i+1 < argc) tolerance = atof(argv[++i]);
+		else files.push_back(argv[i]);
+	}
+
+	if(files.size() != 4) {
+		cout << "usage: " << argv[0] << " [-t tolerance] <frames A> <frames B> <hits A> <hits B>" << endl;
+		return 1;
+	}
+
+	Summary s[2];
+	for(int k = 0 ; k < 2 ; k++)
+		if(!readFrames(files[k], s[k]) || !readHits(files[2+k], s[k])) return 1;
+
+	cout << "events A " << s[0].events << " (" << s[0].withHits << " with hits, "
+	     << s[0].withPixels << "/" << s[0].frames << " frames with pixels), B " << s[1].events
+	     << " (" << s[1].withHits << " with hits, " << s[1].withPixels << "/" << s[1].frames
+	     << " frames with pixels)" << endl;
+	cout << setw(20) << "" << setw(14) << "A" << setw(14) << "B" << setw(10) << "rel. diff" << endl;
+
+	int failed = 0;
+	failed += check("edep MPV", s[0].mpv, s[1].mpv, tolerance);
+	failed += check("edep median", s[0].median, s[1].median, tolerance);
+	failed += check("edep mean (<3 med)", s[0].truncatedMean, s[1].truncatedMean, tolerance);
+	failed += check("cluster size", s[0].clusterSize, s[1].clusterSize, tolerance);
+	failed += check("frames with pixels", s[0].withPixels, s[1].withPixels, tolerance);
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+/**
+ *  Reading of the frames files of the old format: FrameContainer version
+ *  3 (std::map pixels) as base of a split FrameStruct, converted by the
+ *  read rule of AllPixDmLinkDef.h (FrameContainer::FillFromMaps).
+ *
+ *  allpix-test-frames-v3 <allpix-test-write-frames-v3>
+ *
+ *  Writes the file with the old classes, reads it back with the current
+ *  ones and checks every pixel, LVL1, energy and counter.  Returns 0 if
+ *  they are all there.
+ */
+
+#include "allpix_dm.h"
+#include "allpix-test-frames-v3.h"
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TClass.h>
+#include <TStreamerInfo.h>
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+static const char * c_file = "test_frames_v3.root";
+
+int main(int argc, char ** argv){
+
+	if(argc != 2) {
+		cout << "usage: " << argv[0] << " <allpix-test-write-frames-v3>" << endl;
+		return 1;
+	}
+
+	string cmd = string(argv[1]) + " " + c_file;
+	if(system(cmd.c_str()) != 0) {
+		cout << "[ERROR] " << cmd << " failed" << endl;
+		return 1;
+	}
+
+	TFile f(c_file, "READ");
+	TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("MPXTree");
+	if(!t || t->GetEntries() != framesV3::nFrames) {
+		cout << "[ERROR] " << c_file << " : " << framesV3::nFrames << " frames expected" << endl;
+		return 1;
+	}
+
+	// really the old format on file
+	TStreamerInfo * info = (TStreamerInfo *) TClass::GetClass("FrameContainer")->GetStreamerInfos()->At(3);
+	if(!info) {
+		cout << "[ERROR] no FrameContainer version 3 in " << c_file << endl;
+		return 1;
+	}
+
+	int failed = 0;
+	FrameStruct * frame = new FrameStruct("");
+	t->SetBranchAddress("FramesData", &frame);
+
+	for(int fr = 0 ; fr < framesV3::nFrames ; fr++) {
+
+		t->GetEntry(fr);
+
+		const vector<Int_t> & index = frame->GetPixelIndex();
+		const vector<Int_t> & counts = frame->GetPixelCounts();
+		const vector<Int_t> & lvl1 = frame->GetPixelLVL1();
+		const vector<Double_t> & truthE = frame->GetPixelTruthE();
+		const vector<Double_t> & E = frame->GetPixelE();
+
+		bool ok = frame->GetFrameId() == fr && frame->GetnX() == framesV3::width
+				&& (int)index.size() == framesV3::nPixels && counts.size() == index.size()
+				&& lvl1.size() == (framesV3::hasLVL1(fr) ? index.size() : 0)
+				&& truthE.size() == (framesV3::hasEnergies(fr) ? index.size() : 0)
+				&& E.size() == truthE.size()
+				&& frame->GetEntriesPad() == framesV3::nPixels
+				&& frame->GetHitsInPad() == framesV3::nPixels;
+
+		Int_t charge = 0;
+		for(int i = 0 ; ok && i < framesV3::nPixels ; i++) {
+			charge += framesV3::counts(fr, i);
+			ok = index[i] == framesV3::pixel(fr, i) && counts[i] == framesV3::counts(fr, i);
+			if(ok && framesV3::hasLVL1(fr)) ok = lvl1[i] == framesV3::lvl1(fr, i);
+			if(ok && framesV3::hasEnergies(fr))
+				ok = truthE[i] == framesV3::truthE(fr, i) && E[i] == framesV3::E(fr, i);
+		}
+		if(ok) ok = frame->GetChargeInPad() == charge;
+
+		if(!ok) {
+			cout << "[ERROR] frame " << fr << " (Id " << frame->GetFrameId() << ") : "
+			     << index.size() << " pixels, " << lvl1.size() << " LVL1, "
+			     << truthE.size() << " energies, not as written" << endl;
+			failed++;
+		}
+	}
+
+	t->ResetBranchAddresses();
+	delete frame;
+
+	if(!failed) cout << framesV3::nFrames << " version 3 frames read back" << endl;
+
+	return failed ? 1 : 0;
+}
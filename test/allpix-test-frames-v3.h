@@ -0,0 +1,26 @@
+/**
+ *  Content of the version 3 frames file, written by
+ *  allpix-test-write-frames-v3 and checked by allpix-test-frames-v3.
+ */
+
+#ifndef allpix_test_frames_v3_h
+#define allpix_test_frames_v3_h 1
+
+namespace framesV3 {
+
+	const int nFrames = 4;
+	const int nPixels = 3;  // per frame
+	const int width = 256;
+
+	inline int pixel(int f, int i) { return 7*(nPixels*f + i) + 1; }
+	inline int counts(int f, int i) { return 10*f + i + 1; }
+	// LVL1 in frame 1 only, energies in frames 2 and 3
+	inline bool hasLVL1(int f) { return f == 1; }
+	inline int lvl1(int f, int i) { return f + i + 2; }
+	inline bool hasEnergies(int f) { return f >= 2; }
+	inline int truthE(int f, int i) { return 100*f + i; }
+	inline int E(int f, int i) { return 50*f + i; }
+
+}
+
+#endif
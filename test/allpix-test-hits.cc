@@ -0,0 +1,54 @@
+/**
+ *  Checks the hits files of a test run (columns format).
+ *
+ *  allpix-test-hits <events> <hits file> [<hits file> ...]
+ *
+ *  Every file must hold one entry per event and most of the events must
+ *  have hits with energy in the sensor.  Returns 0 if so.
+ */
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+int main(int argc, char ** argv){
+
+	if(argc < 3) {
+		cout << "usage: " << argv[0] << " <events> <hits file> [<hits file> ...]" << endl;
+		return 1;
+	}
+
+	Long64_t events = atoll(argv[1]);
+	int failed = 0;
+
+	for(int i = 2 ; i < argc ; i++) {
+
+		TFile f(argv[i], "READ");
+		TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("AllPixHits");
+		if(!t) {
+			cout << "[ERROR] no AllPixHits tree in " << argv[i] << endl;
+			failed++;
+			continue;
+		}
+
+		Long64_t entries = t->GetEntries();
+		Long64_t withHits = t->GetEntries("nHits > 0 && edepTotal > 0");
+
+		cout << argv[i] << " : " << entries << " entries, " << withHits << " with hits" << endl;
+
+		if(entries != events) {
+			cout << "[ERROR] " << events << " entries expected" << endl;
+			failed++;
+		} else if(2*withHits < events) {
+			cout << "[ERROR] less than half of the events have hits" << endl;
+			failed++;
+		}
+
+	}
+
+	return failed ? 1 : 0;
+}
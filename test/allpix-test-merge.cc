@@ -0,0 +1,166 @@
+/**
+ *  Merge of two small jobs with allpix-merge.
+ *
+ *  allpix-test-merge <allpix-merge>
+ *
+ *  Writes the frames (MPXTree) and hits (AllPixHits, object format)
+ *  files of two jobs, both numbering their frames and runs from 0, with
+ *  two runs of hits each, events numbered from 0 in every run as
+ *  Geant4 does.  Merges them and checks the merged files: all the
+ *  entries in job order, the run Ids of the second job following the
+ *  first, the event Ids a global sequence, the pixels and energies
+ *  untouched.  Returns 0 if so.
+ */
+
+#include "allpix_dm.h"
+#include "AllPix_Hits_WriteToEntuple.h"
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+
+static const int c_jobs = 2;
+static const int c_frames = 5; // per job, one event per frame
+static const int c_width = 256;
+static const int c_eventsPerRun = 3; // hits, two runs per job
+
+// pixel counts of frame i of job k
+static int counts(int k, int i) { return 100*k + i + 1; }
+
+static void writeFrames(const string & file, int k) {
+
+	TFile f(file.c_str(), "RECREATE");
+	TTree * t = new TTree("MPXTree", "Medi/TimePix data");
+	FrameStruct * frame = new FrameStruct("test");
+	t->Branch("FramesData", "FrameStruct", &frame, 128000, 2);
+	for(int i = 0 ; i < c_frames ; i++) {
+		frame->CleanUpMatrix();
+		frame->ResetCountersPad();
+		frame->SetnX(c_width);
+		frame->SetnY(c_width);
+		frame->SetId(i);
+		frame->FillOneElement(i, k, c_width, counts(k, i));
+		t->Fill();
+	}
+	f.Write();
+	f.Close();
+	delete frame;
+
+}
+
+static void writeHits(const string & file, int k) {
+
+	TFile f(file.c_str(), "RECREATE");
+	TTree * t = new TTree("AllPixHits", "test");
+	SimpleHits * hits = new SimpleHits;
+	t->Branch("SimpleHits", "SimpleHits", &hits);
+	for(int i = 0 ; i < c_frames ; i++) {
+		hits->Rewind();
+		hits->edepTotal = counts(k, i);
+		hits->edep.push_back(counts(k, i));
+		hits->event = i % c_eventsPerRun;
+		hits->run = i / c_eventsPerRun;
+		t->Fill();
+	}
+	f.Write();
+	f.Close();
+	delete hits;
+
+}
+
+static int checkFrames(const string & file) {
+
+	TFile f(file.c_str(), "READ");
+	TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("MPXTree");
+	if(!t || t->GetEntries() != c_jobs*c_frames) {
+		cout << "[ERROR] " << file << " : " << c_jobs*c_frames << " frames expected" << endl;
+		return 1;
+	}
+
+	int failed = 0;
+	FrameStruct * frame = new FrameStruct("");
+	t->SetBranchAddress("FramesData", &frame);
+	for(int e = 0 ; e < c_jobs*c_frames ; e++) {
+		t->GetEntry(e);
+		int k = e / c_frames, i = e % c_frames;
+		vector<UInt_t> index;
+		vector<Int_t> pixelCounts;
+		frame->GetPixels(index, pixelCounts);
+		if(frame->GetFrameId() != e || index.size() != 1
+				|| index[0] != (UInt_t)(k*c_width + i) || pixelCounts[0] != counts(k, i)) {
+			cout << "[ERROR] " << file << " : frame " << e << " has Id " << frame->GetFrameId()
+			     << " and " << index.size() << " pixels" << endl;
+			failed++;
+		}
+	}
+	t->ResetBranchAddresses();
+	delete frame;
+
+	return failed;
+}
+
+static int checkHits(const string & file) {
+
+	TFile f(file.c_str(), "READ");
+	TTree * t = f.IsZombie() ? 0x0 : (TTree *) f.Get("AllPixHits");
+	if(!t || t->GetEntries() != c_jobs*c_frames) {
+		cout << "[ERROR] " << file << " : " << c_jobs*c_frames << " events expected" << endl;
+		return 1;
+	}
+
+	int failed = 0;
+	SimpleHits * hits = 0x0;
+	t->SetBranchAddress("SimpleHits", &hits);
+	for(int e = 0 ; e < c_jobs*c_frames ; e++) {
+		t->GetEntry(e);
+		int k = e / c_frames, i = e % c_frames;
+		// runs of job 1 after the frame Ids of job 0 (0 to c_frames - 1)
+		if(hits->event != e || hits->run != k*c_frames + i/c_eventsPerRun || hits->edepTotal != counts(k, i)
+				|| hits->edep.size() != 1) {
+			cout << "[ERROR] " << file << " : entry " << e << " has event " << hits->event
+			     << " run " << hits->run << " edep " << hits->edepTotal << endl;
+			failed++;
+		}
+	}
+	t->ResetBranchAddresses();
+	delete hits;
+
+	return failed;
+}
+
+int main(int argc, char ** argv){
+
+	if(argc != 2) {
+		cout << "usage: " << argv[0] << " <allpix-merge>" << endl;
+		return 1;
+	}
+
+	ostringstream frames, hits;
+	for(int k = 0 ; k < c_jobs ; k++) {
+		ostringstream job;
+		job << "test_merge_job" << k;
+		writeFrames(job.str() + "_frames.root", k);
+		writeHits(job.str() + "_hits.root", k);
+		frames << " " << job.str() << "_frames.root";
+		hits << " " << job.str() << "_hits.root";
+	}
+
+	string cmd = string(argv[1]) + " -o test_merge_frames.root" + frames.str()
+			+ " -o test_merge_hits.root" + hits.str();
+	cout << cmd << endl;
+	if(system(cmd.c_str()) != 0) {
+		cout << "[ERROR] allpix-merge failed" << endl;
+		return 1;
+	}
+
+	int failed = checkFrames("test_merge_frames.root") + checkHits("test_merge_hits.root");
+	if(!failed) cout << "merged files ok" << endl;
+
+	return failed ? 1 : 0;
+}
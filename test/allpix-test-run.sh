@@ -0,0 +1,16 @@
+#!/bin/sh
+#
+# Runs allpix in batch mode on a macro then the checks given after --
+#
+#  allpix-test-run.sh <allpix> <macro> -- <check> [args]
+#
+
+allpix=$1
+macro=$2
+shift 2
+[ "$1" = "--" ] && shift
+
+"$allpix" "$macro" 1 || { echo "[ERROR] allpix failed on $macro"; exit 1; }
+
+[ $# -gt 0 ] || exit 0
+exec "$@"
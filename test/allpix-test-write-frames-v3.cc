@@ -0,0 +1,54 @@
+/**
+ *  Writes a frames file of the old format (FrameContainer version 3,
+ *  std::map pixels), MPXTree/FramesData split as AllPix_Frames_WriteToEntuple
+ *  does.
+ *
+ *  allpix-test-write-frames-v3 <output.root>
+ */
+
+#include "allpix_dm_v3.h"
+#include "allpix-test-frames-v3.h"
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char ** argv){
+
+	if(argc != 2) {
+		cout << "usage: " << argv[0] << " <output.root>" << endl;
+		return 1;
+	}
+
+	TFile f(argv[1], "RECREATE");
+	if(f.IsZombie()) return 1;
+
+	TTree * t = new TTree("MPXTree", "Medi/TimePix data");
+	FrameStruct * frame = new FrameStruct;
+	t->Branch("FramesData", "FrameStruct", &frame, 128000, 2);
+
+	for(int fr = 0 ; fr < framesV3::nFrames ; fr++) {
+		frame->Clear();
+		frame->SetId(fr);
+		frame->SetnX(framesV3::width);
+		frame->SetnY(framesV3::width);
+		frame->SetDataSet("v3");
+		frame->SetFrameAsMCData();
+		for(int i = 0 ; i < framesV3::nPixels ; i++) {
+			int X = framesV3::pixel(fr, i);
+			frame->Fill(X, framesV3::counts(fr, i));
+			if(framesV3::hasLVL1(fr)) frame->SetLVL1(X, framesV3::lvl1(fr, i));
+			if(framesV3::hasEnergies(fr)) frame->SetEnergies(X, framesV3::truthE(fr, i), framesV3::E(fr, i));
+		}
+		t->Fill();
+	}
+
+	f.Write();
+	f.Close();
+	delete frame;
+
+	return 0;
+}
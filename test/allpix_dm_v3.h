@@ -0,0 +1,111 @@
+/**
+ *  FrameContainer version 3 and FrameStruct version 4, the members as
+ *  they were before the sorted arrays (std::map pixels), to write
+ *  frames files of the old format.  Only for allpix-test-write-frames-v3,
+ *  which doesn't link the allpix-dm library.
+ */
+
+#ifndef allpix_dm_v3_h
+#define allpix_dm_v3_h 1
+
+#include <map>
+#include <vector>
+#include "TROOT.h"
+#include "TObject.h"
+#include "TString.h"
+
+class FrameContainer {
+
+private:
+
+	std::map<int, int> m_frameXC;
+	std::map<int, int> m_lvl1;
+	std::map<int, int> m_frameXC_TruthE;
+	std::map<int, int> m_frameXC_E;
+
+	Int_t m_nEntriesPad;
+	Int_t m_nHitsInPad;
+	Int_t m_nChargeInPad;
+
+	Bool_t m_isMCData;
+
+public:
+	FrameContainer() : m_nEntriesPad(0), m_nHitsInPad(0), m_nChargeInPad(0), m_isMCData(false) {};
+	virtual ~FrameContainer(){};
+
+	void Clear() {
+		m_frameXC.clear(); m_lvl1.clear(); m_frameXC_TruthE.clear(); m_frameXC_E.clear();
+		m_nEntriesPad = m_nHitsInPad = m_nChargeInPad = 0;
+	};
+	void Fill(Int_t X, Int_t counts) {
+		m_frameXC[X] += counts;
+		m_nEntriesPad++;
+		m_nHitsInPad++;
+		m_nChargeInPad += counts;
+	};
+	void SetLVL1(Int_t X, Int_t lvl1) { m_lvl1[X] = lvl1; };
+	void SetEnergies(Int_t X, Int_t truthE, Int_t E) { m_frameXC_TruthE[X] = truthE; m_frameXC_E[X] = E; };
+	void SetFrameAsMCData(){m_isMCData = true;};
+
+	ClassDef(FrameContainer,3)
+};
+
+class FrameStruct : public FrameContainer {
+
+private:
+
+	/* head info */
+	Int_t    fFormat;
+	Int_t    fWidth;
+	Int_t    fHeight;
+
+	/* all metadata */
+	Int_t    fAcq_mode;
+	Double_t fAcq_time;
+	TString  fApplied_filters;
+	Double_t fAuto_erase_interval;
+	Int_t    fAutoerase_interval_counter;
+	Bool_t   fBS_active;
+	TString  fChipboardID;
+	Double_t fCoinc_live_time;
+	Byte_t   fCoincidence_delay;
+	Byte_t   fCoincidence_mode;
+	std::vector<Int_t> fCounters;
+	std::vector<Int_t> fDACs;
+	Double_t fHV;
+	Int_t    fHw_timer;
+	TString  fInterface;
+	Double_t fMpx_clock;
+	Int_t    fMpx_type;
+	Int_t    fPolarity;
+	Double_t fStart_time;
+	TString  fStart_timeS;
+	Byte_t   fTimepix_clock;
+	Double_t fTrigger_time;
+
+	/* MC only */
+	std::vector<Double_t> m_primaryVertex_x;
+	std::vector<Double_t> m_primaryVertex_y;
+	std::vector<Double_t> m_primaryVertex_z;
+
+	/* joint */
+	Long_t   fFrameId;
+	TString  fMPXDataSetNumber;
+
+public:
+	FrameStruct() : fFormat(0), fWidth(0), fHeight(0), fAcq_mode(0), fAcq_time(0.),
+		fAuto_erase_interval(0.), fAutoerase_interval_counter(0), fBS_active(false),
+		fCoinc_live_time(0.), fCoincidence_delay(0), fCoincidence_mode(0), fHV(0.),
+		fHw_timer(0), fMpx_clock(0.), fMpx_type(0), fPolarity(0), fStart_time(0.),
+		fTimepix_clock(0), fTrigger_time(0.), fFrameId(-1) {};
+	~FrameStruct(){};
+
+	void SetId(Int_t id){ fFrameId=id; }
+	void SetnX(int x){fWidth = x;};
+	void SetnY(int y){fHeight = y;};
+	void SetDataSet(TString ds){ fMPXDataSetNumber = ds; };
+
+	ClassDef(FrameStruct,4)
+};
+
+#endif
@@ -0,0 +1,6 @@
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ class FrameStruct+;
+#pragma link C++ class FrameContainer+;
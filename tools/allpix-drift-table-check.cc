@@ -0,0 +1,106 @@
+/**
+ *  Drift tables (AllPixDriftTable) against the full integration, the
+ *  check the digitizers used to run when building them.
+ *
+ *  allpix-drift-table-check [-n nodes] [-d thickness um] [-v bias V]
+ *                           [-r resistivity] [-t tolerance ns]
+ *
+ *  Sets up the field and the electron mobility of the FEI3Standard
+ *  and Timepix3 digitizers (linear field, zero beyond the depleted
+ *  depth, Caughey-Thomas mobility at 300 K) and drifts with their
+ *  full integration, AllPixDriftThroughSensor (AllPixDriftEngine.hh).
+ *  Default 250 um at 15 V and 5000, depleted to 156 um.  Builds the
+ *  table plain and split at the depleted depth and compares both to
+ *  the full integration at the bin centers.  Returns 1 if the
+ *  split table is off by more than the tolerance in drift time,
+ *  default 0.1 ns, the longest step of the integration (the drift
+ *  times themselves come in steps).  The plain table is off by ~30 ns
+ *  next to the depleted depth.
+ */
+
+#include "AllPixDriftTable.hh"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace std;
+
+// as AllPixFEI3StandardDigitizer::ComputeDriftTimeFullField
+static AllPixDriftResult drift(const AllPixLinearField1D & field, const AllPixCaugheyThomasMobility & mobility,
+		G4double thickness, G4double z) {
+
+	AllPixDriftEngine<kAllPixElectron, AllPixLinearField1D, AllPixCaugheyThomasMobility, false>
+	engine(field, mobility);
+
+	return AllPixDriftThroughSensor(engine, AllPixDriftStepControl(), 0., 0., z, 0., thickness);
+}
+
+static void build(AllPixDriftTable & table, const AllPixLinearField1D & field,
+		const AllPixCaugheyThomasMobility & mobility, G4double thickness) {
+
+	for(G4int i = 0 ; i < table.GetNNodes() ; i++)
+		table.Set(i, drift(field, mobility, thickness, table.GetZ(i)));
+	for(G4int i = 0 ; i < table.GetNBins() ; i++)
+		table.Validate(i, drift(field, mobility, thickness, table.GetBinCenter(i)));
+
+}
+
+int main(int argc, char ** argv){
+
+	G4int nNodes = 501;
+	G4double thickness = 250.*um;
+	G4double biasVoltage = 15.;
+	G4double resistivity = 5000.;
+	G4double tolerance = AllPixDriftStepControl().tup;
+
+	for(int i = 1 ; i < argc ; i++) {
+		if(!strcmp(argv[i], "-n") && i+1 < argc) nNodes = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-d") && i+1 < argc) thickness = atof(argv[++i])*um;
+		else if(!strcmp(argv[i], "-v") && i+1 < argc) biasVoltage = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-r") && i+1 < argc) resistivity = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-t") && i+1 < argc) tolerance = atof(argv[++i])*ns;
+		else {
+			cout << "usage: " << argv[0] << " [-n nodes] [-d thickness um] [-v bias V]"
+			     << " [-r resistivity] [-t tolerance ns]" << endl;
+			return 1;
+		}
+	}
+
+	// as in the FEI3Standard and Timepix3 digitizers
+	G4double mobility0 = 1562.0*cm2/s;
+	G4double vsat = 2.4e7*cm/s*pow(1.0 + 0.8*exp(300.0/600.0), -1.0);
+	G4double echarge = 1.60217646e-19;
+	G4double epsilon = 11.8*8.854187817e-12/m;
+	G4double Neff = 1.0/(resistivity*mobility0*(s/cm2)*echarge*cm3);
+	G4double depletedDepth = sqrt(2*epsilon*biasVoltage/(echarge*fabs(Neff)));
+	if(depletedDepth > thickness) depletedDepth = thickness;
+
+	AllPixLinearField1D field(thickness*biasVoltage/depletedDepth, -biasVoltage/depletedDepth, depletedDepth);
+	AllPixCaugheyThomasMobility mobility(mobility0, vsat/mobility0, 2.0);
+
+	AllPixDriftTable plain, split;
+	plain.Init(0., thickness, nNodes);
+	split.Init(0., thickness, nNodes, depletedDepth);
+	build(plain, field, mobility, thickness);
+	build(split, field, mobility, thickness);
+
+	cout << thickness/um << " um, " << biasVoltage << " V, depleted depth " << depletedDepth/um << " um" << endl;
+	cout << setw(8) << "table" << setw(8) << "nodes" << setw(16) << "max |dt| [ns]" << setw(10) << "at z [um]"
+	     << setw(16) << "max |dxy| [um]" << endl;
+	AllPixDriftTable * tables[2] = { &plain, &split };
+	const char * names[2] = { "plain", "split" };
+	for(int k = 0 ; k < 2 ; k++)
+		cout << setw(8) << names[k] << setw(8) << tables[k]->GetNNodes()
+		     << setw(16) << tables[k]->GetMaxDtValidation()/ns << setw(10) << tables[k]->GetMaxDtValidationZ()/um
+		     << setw(16) << tables[k]->GetMaxDxyValidation()/um << endl;
+
+	if(!(split.GetMaxDtValidation() <= tolerance)) {
+		cout << "[ERROR] the drift table is off by more than " << tolerance/ns << " ns" << endl;
+		return 1;
+	}
+
+	return 0;
+}
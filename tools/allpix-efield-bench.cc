@@ -0,0 +1,171 @@
+/**
+ *  Load time of the E-field maps, text (TCAD export) against binary
+ *  (allpix-efield-convert), and checks of the binary maps.
+ *
+ *  allpix-efield-bench [-n nx ny nz] [-r repeats]
+ *
+ *  Writes a text map of nx*ny*nz nodes (default 56 x 56 x 301, a 55 um
+ *  cell at 1 um, 300 um thick) in the current directory, converts it and
+ *  times both loads, alone and followed by a lookup at every node (the
+ *  binary map is only read from disk when touched).  Best of the repeats,
+ *  the files in the page cache for both.  Then checks that the binary map
+ *  gives the values of the text one, that a map written in V/m is read
+ *  back in V/cm and that an unknown unit is refused.  Returns 1 if a
+ *  check fails.
+ */
+
+#include "AllPixEFieldMap.hh"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace std;
+
+typedef std::chrono::steady_clock benchClock;
+
+static G4ThreeVector field(G4int i, G4int j, G4int k) {
+
+	return G4ThreeVector(10.*sin(0.1*i)*cos(0.2*j), 10.*cos(0.1*i)*sin(0.2*j), -1000. - 2.*k);
+}
+
+static G4bool writeText(const char * file, G4int nx, G4int ny, G4int nz) {
+
+	FILE * f = fopen(file, "w");
+	if ( !f ) return false;
+
+	fprintf(f, "%d %d %d\n", nx, ny, nz);
+	for ( G4int k = 0 ; k < nz ; k++ )
+		for ( G4int j = 0 ; j < ny ; j++ )
+			for ( G4int i = 0 ; i < nx ; i++ ) {
+				G4ThreeVector e = field(i, j, k);
+				fprintf(f, "%d %d %d %.7g %.7g %.7g\n", i, j, k, e.x(), e.y(), e.z());
+			}
+
+	return fclose(f) == 0;
+}
+
+// lookup at every node, the sum keeps it
+static G4double touch(const AllPixEFieldMap & m) {
+
+	G4double sum = 0.;
+	for ( G4int k = 0 ; k < m.GetNz() ; k++ )
+		for ( G4int j = 0 ; j < m.GetNy() ; j++ )
+			for ( G4int i = 0 ; i < m.GetNx() ; i++ )
+				sum += m.Interpolate((G4double)i/(m.GetNx() - 1), (G4double)j/(m.GetNy() - 1),
+						(G4double)k/(m.GetNz() - 1)).z();
+
+	return sum;
+}
+
+// max relative difference of a and scale*b over the nodes
+static G4double maxDifference(const AllPixEFieldMap & a, const AllPixEFieldMap & b, G4double scale) {
+
+	G4double d = 0.;
+	for ( G4int k = 0 ; k < a.GetNz() ; k++ )
+		for ( G4int j = 0 ; j < a.GetNy() ; j++ )
+			for ( G4int i = 0 ; i < a.GetNx() ; i++ ) {
+				G4double u = (G4double)i/(a.GetNx() - 1);
+				G4double v = (G4double)j/(a.GetNy() - 1);
+				G4double w = (G4double)k/(a.GetNz() - 1);
+				G4ThreeVector ea = a.Interpolate(u, v, w);
+				G4ThreeVector eb = scale * b.Interpolate(u, v, w);
+				G4double r = (ea - eb).mag() / (ea.mag() > 0. ? ea.mag() : 1.);
+				if ( r > d ) d = r;
+			}
+
+	return d;
+}
+
+int main(int argc, char ** argv) {
+
+	G4int n[3] = { 56, 56, 301 };
+	int repeats = 3;
+
+	for ( int i = 1 ; i < argc ; i++ ) {
+		if ( !strcmp(argv[i], "-n") && i + 3 < argc ) {
+			for ( int a = 0 ; a < 3 ; a++ ) n[a] = atoi(argv[++i]);
+		} else if ( !strcmp(argv[i], "-r") && i + 1 < argc ) repeats = atoi(argv[++i]);
+		else {
+			cout << "usage: " << argv[0] << " [-n nx ny nz] [-r repeats]" << endl;
+			return 1;
+		}
+	}
+
+	const char * textFile = "bench_efield.txt";
+	const char * binFile = "bench_efield.bin";
+	const char * binFileVm = "bench_efield_Vm.bin";
+	const char * binFileBad = "bench_efield_bad.bin";
+
+	if ( !writeText(textFile, n[0], n[1], n[2]) ) {
+		cout << "[ERROR] can't write " << textFile << endl;
+		return 1;
+	}
+
+	AllPixEFieldMap text;
+	if ( !text.LoadText(textFile) ) return 1;
+	G4double pitch[3] = { 0.055, 0.055, 0.3 };
+	if ( !text.WriteBinary(binFile, pitch, "V/cm") || !text.WriteBinary(binFileVm, pitch, "V/m")
+			|| !text.WriteBinary(binFileBad, pitch, "furlong") ) {
+		cout << "[ERROR] can't write the binary maps" << endl;
+		return 1;
+	}
+
+	// best of the repeats, [s]
+	G4double tText = 1e9, tTextTouch = 1e9, tBin = 1e9, tBinTouch = 1e9;
+	G4double sink = 0.;
+	for ( int r = 0 ; r < repeats ; r++ ) {
+		AllPixEFieldMap t, b;
+		benchClock::time_point t0 = benchClock::now();
+		t.LoadText(textFile);
+		benchClock::time_point t1 = benchClock::now();
+		sink += touch(t);
+		benchClock::time_point t2 = benchClock::now();
+		b.LoadBinary(binFile);
+		benchClock::time_point t3 = benchClock::now();
+		sink += touch(b);
+		benchClock::time_point t4 = benchClock::now();
+		tText = min(tText, std::chrono::duration<double>(t1 - t0).count());
+		tTextTouch = min(tTextTouch, std::chrono::duration<double>(t2 - t0).count());
+		tBin = min(tBin, std::chrono::duration<double>(t3 - t2).count());
+		tBinTouch = min(tBinTouch, std::chrono::duration<double>(t4 - t2).count());
+	}
+
+	cout << n[0] << " x " << n[1] << " x " << n[2] << " nodes" << endl;
+	cout << setprecision(3);
+	cout << "load            text " << tText*1e3 << " ms, binary " << tBin*1e3 << " ms, x" << tText/tBin << endl;
+	cout << "load + lookups  text " << tTextTouch*1e3 << " ms, binary " << tBinTouch*1e3 << " ms, x"
+	     << tTextTouch/tBinTouch << (tTextTouch/tBinTouch >= 10. ? " (>= 10)" : " (< 10)") << endl;
+	if ( sink == 1.2345 ) cout << sink << endl;
+
+	int failed = 0;
+
+	AllPixEFieldMap bin, binVm, binBad;
+	if ( !bin.LoadBinary(binFile) || !bin.IsMapped() || bin.GetFieldUnit() != "V/cm"
+			|| maxDifference(text, bin, 1.) > 0. ) {
+		cout << "[ERROR] the binary map doesn't give the values of the text one" << endl;
+		failed++;
+	}
+	if ( !binVm.LoadBinary(binFileVm) || binVm.GetFieldUnit() != "V/cm"
+			|| maxDifference(text, binVm, 100.) > 1e-6 ) {
+		cout << "[ERROR] the V/m map is not read back in V/cm" << endl;
+		failed++;
+	}
+	if ( binBad.LoadBinary(binFileBad) ) {
+		cout << "[ERROR] a map of unknown unit was loaded" << endl;
+		failed++;
+	}
+
+	remove(textFile);
+	remove(binFile);
+	remove(binFileVm);
+	remove(binFileBad);
+
+	if ( !failed ) cout << "binary maps ok" << endl;
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+/**
+ *  Converts a text E-field map (TCAD export, the format read by
+ *  /allpix/det/setEFieldFile) into the binary map format of
+ *  AllPixEFieldMap.hh.  /allpix/det/setEFieldFile takes either, the
+ *  binary one is mmap'ed instead of parsed.
+ *
+ *  allpix-efield-convert <input.txt> <output.bin> [pitchX pitchY pitchZ (mm)] [field unit]
+ */
+
+#include "AllPixEFieldMap.hh"
+
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace std;
+
+int main(int argc, char ** argv) {
+
+	if ( argc != 3 && argc != 6 && argc != 7 ) {
+		cout << "use: " << argv[0] << " <input.txt> <output.bin> [pitchX pitchY pitchZ (mm)] [field unit, default V/cm]" << endl;
+		return 1;
+	}
+
+	G4String input = argv[1];
+	G4String output = argv[2];
+
+	G4double pitch[3] = { 0., 0., 0. };
+	if ( argc >= 6 ) {
+		for ( int a = 0 ; a < 3 ; a++ ) pitch[a] = atof( argv[3 + a] );
+	}
+	G4String unit = "V/cm";
+	if ( argc == 7 ) unit = argv[6];
+	G4double scale = 1.;
+	if ( !AllPixEFieldMap::GetUnitScale(unit, scale) ) {
+		cout << "unknown field unit " << unit << ", use V/cm, V/m, V/mm, V/um, kV/cm or MV/m" << endl;
+		return 1;
+	}
+
+	clock_t start = clock();
+
+	AllPixEFieldMap efmap;
+	if ( !efmap.LoadText(input) ) {
+		cout << "can't read " << input << endl;
+		return 1;
+	}
+
+	cout << input << " : " << efmap.GetNx() << " x " << efmap.GetNy() << " x " << efmap.GetNz()
+			<< " nodes, read in " << (double)(clock() - start)/CLOCKS_PER_SEC << " s" << endl;
+
+	if ( !efmap.WriteBinary(output, pitch, unit) ) {
+		cout << "can't write " << output << endl;
+		return 1;
+	}
+
+	cout << "wrote " << output << " (" << unit << ")" << endl;
+
+	return 0;
+}
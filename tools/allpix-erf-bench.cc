@@ -0,0 +1,112 @@
+/**
+ *  Accuracy and speed of AllPixFastErf (AllPixErf.hh) against
+ *  TMath::Erf, the erf the digitizers used for charge sharing.
+ *
+ *  allpix-erf-bench [-n calls] [-r range]
+ *
+ *  Max abs error of AllPixFastErf and of AllPixGaussianBoxIntegral
+ *  over [-range, range] (default 6, beyond it both are +-1 to double
+ *  precision), then ns per call of both erfs and of the box integral
+ *  of the digitizers.  Returns 1 if the erf is off by more than the
+ *  1.5e-7 of the approximation, so it runs as a test as well.
+ */
+
+#include "AllPixErf.hh"
+
+#include <TMath.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace std;
+
+typedef std::chrono::steady_clock benchClock;
+
+static const double c_maxErfError = 1.5e-7;
+
+// the box integral as the digitizers computed it before AllPixErf.hh
+static double boxIntegralTMath(double xhit, double yhit, double Sigma,
+		double x1, double x2, double y1, double y2, double Energy) {
+
+	return Energy*(TMath::Erf((x2 - xhit)/(TMath::Sqrt(2.)*Sigma)) - TMath::Erf((x1 - xhit)/(TMath::Sqrt(2.)*Sigma)))
+			*(TMath::Erf((y2 - yhit)/(TMath::Sqrt(2.)*Sigma)) - TMath::Erf((y1 - yhit)/(TMath::Sqrt(2.)*Sigma)))/4.;
+}
+
+template <class F>
+static double nsPerCall(F f, const vector<double> & args, double & sink) {
+
+	benchClock::time_point t0 = benchClock::now();
+	double s = 0.;
+	for(size_t i = 0 ; i < args.size() ; i++) s += f(args[i]);
+	double ns = std::chrono::duration<double, std::nano>(benchClock::now() - t0).count();
+	sink += s;
+
+	return ns/args.size();
+}
+
+int main(int argc, char ** argv){
+
+	int n = 10000000;
+	double range = 6.;
+
+	for(int i = 1 ; i < argc ; i++) {
+		if(!strcmp(argv[i], "-n") && i+1 < argc) n = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-r") && i+1 < argc) range = atof(argv[++i]);
+		else {
+			cout << "usage: " << argv[0] << " [-n calls] [-r range]" << endl;
+			return 1;
+		}
+	}
+
+	// accuracy, 1e-5 steps
+	double maxErr = 0., maxErrAt = 0.;
+	for(double x = -range ; x <= range ; x += 1e-5) {
+		double d = fabs(AllPixFastErf(x) - TMath::Erf(x));
+		if(d > maxErr) { maxErr = d; maxErrAt = x; }
+	}
+
+	// box integral, unit energy: a 55 um pixel, hits across it and the
+	//  next one, charge cloud widths of 1 to 20 um
+	double maxBoxErr = 0.;
+	for(double sigma = 1e-3 ; sigma <= 20e-3 ; sigma += 1e-3)
+		for(double xhit = -0.055 ; xhit <= 0.110 ; xhit += 0.5e-3)
+			for(double yhit = -0.055 ; yhit <= 0.110 ; yhit += 5e-3) {
+				double d = fabs(AllPixGaussianBoxIntegral(xhit, yhit, sigma, 0., 0.055, 0., 0.055, 1.)
+						- boxIntegralTMath(xhit, yhit, sigma, 0., 0.055, 0., 0.055, 1.));
+				if(d > maxBoxErr) maxBoxErr = d;
+			}
+
+	cout << "max |AllPixFastErf - TMath::Erf| over [" << -range << ", " << range << "] : "
+	     << maxErr << " at x = " << maxErrAt << endl;
+	cout << "max |box integral difference| (unit energy) : " << maxBoxErr << endl;
+
+	// speed, arguments spread over the range
+	vector<double> args(n);
+	for(int i = 0 ; i < n ; i++) args[i] = -range + 2.*range*((i*7919L) % n)/n;
+
+	double sink = 0.;
+	double fast = nsPerCall([](double x){ return AllPixFastErf(x); }, args, sink);
+	double tmath = nsPerCall([](double x){ return TMath::Erf(x); }, args, sink);
+	// hits within a pixel of the box, 10 um cloud
+	for(int i = 0 ; i < n ; i++) args[i] = 0.0275 + 0.055*args[i]/range;
+	double boxFast = nsPerCall([](double x){ return AllPixGaussianBoxIntegral(x, 0.055 - x, 0.01, 0., 0.055, 0., 0.055, 1.); }, args, sink);
+	double boxTMath = nsPerCall([](double x){ return boxIntegralTMath(x, 0.055 - x, 0.01, 0., 0.055, 0., 0.055, 1.); }, args, sink);
+
+	cout << setprecision(3);
+	cout << "AllPixFastErf  " << fast << " ns/call, TMath::Erf " << tmath << " ns/call, x" << tmath/fast << endl;
+	cout << "box integral   " << boxFast << " ns/call, TMath " << boxTMath << " ns/call, x" << boxTMath/boxFast << endl;
+	// keeps the loops
+	if(sink == 1.2345) cout << sink << endl;
+
+	if(maxErr > c_maxErfError) {
+		cout << "[ERROR] AllPixFastErf off by more than " << c_maxErfError << endl;
+		return 1;
+	}
+
+	return 0;
+}
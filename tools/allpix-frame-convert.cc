@@ -0,0 +1,66 @@
+/**
+ *  Converts a Pixelman text frame (256x256 matrix, XYC or XC) and its
+ *  .dsc into the zero suppressed binary frame read by
+ *  FramesHandler::readOneFrame.  Format in AllPixFrameFile.hh.
+ *
+ *  allpix-frame-convert <frame.txt> <frame.dsc> <output.bin>
+ */
+
+#include "allpix_dm.h"
+#include "AllPixFrameFile.hh"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+
+using namespace std;
+
+int main(int argc, char ** argv) {
+
+	if ( argc != 4 ) {
+		cout << "use: " << argv[0] << " <frame.txt> <frame.dsc> <output.bin>" << endl;
+		return 1;
+	}
+
+	clock_t start = clock();
+
+	// Pixelman frames are Timepix sized
+	FramesHandler * handler = new FramesHandler("convert");
+	handler->SetnX(256);
+	handler->SetnY(256);
+	handler->readOneFrame(argv[1], argv[2]);
+
+	FrameStruct * frame = handler->getFrameStructObject();
+	vector<UInt_t> index;
+	vector<Int_t> counts;
+	frame->GetPixels(index, counts);
+
+	vector<uint32_t> fileIndex(index.begin(), index.end());
+	vector<uint16_t> fileCounts(counts.size());
+	int nClipped = 0;
+	for ( size_t i = 0 ; i < counts.size() ; i++ ) {
+		if ( counts[i] > 65535 || counts[i] < 0 ) nClipped++;
+		fileCounts[i] = counts[i] > 65535 ? 65535 : (counts[i] < 0 ? 0 : counts[i]);
+	}
+	if ( nClipped > 0 )
+		cout << "[WARNING] " << nClipped << " pixels out of the 16 bits counts range, clipped" << endl;
+
+	// the .dsc goes in the file, the frame is then self contained
+	ifstream dsc(argv[2]);
+	stringstream meta;
+	if ( dsc.is_open() ) meta << dsc.rdbuf();
+	else cout << "[WARNING] can't read " << argv[2] << ", no metadata stored" << endl;
+
+	if ( !AllPixFrameFile::Write(argv[3], frame->GetnX(), frame->GetnY(), fileIndex, fileCounts, meta.str()) ) {
+		cout << "can't write " << argv[3] << endl;
+		return 1;
+	}
+
+	cout << "wrote " << argv[3] << " : " << fileIndex.size() << " pixels in "
+			<< (double)(clock() - start)/CLOCKS_PER_SEC << " s" << endl;
+
+	delete handler;
+
+	return 0;
+}
@@ -0,0 +1,52 @@
+/**
+ *  Converts a binary LCIO bridge file (/allpix/config/setLCIOBridgeFormat
+ *  binary) back into the text bridge format, for the converters still
+ *  reading the text files.  Format in AllPixLCIOBridge.hh.
+ *
+ *  allpix-lciobridge-dump <input.bin> <output.txt>
+ */
+
+#include "AllPixLCIOBridge.hh"
+
+#include <iostream>
+#include <ctime>
+
+using namespace std;
+
+int main(int argc, char ** argv) {
+
+	if ( argc != 3 ) {
+		cout << "use: " << argv[0] << " <input.bin> <output.txt>" << endl;
+		return 1;
+	}
+
+	string input = argv[1];
+	string output = argv[2];
+	// the writer adds the extension
+	if ( output.size() > 4 && output.compare(output.size() - 4, 4, ".txt") == 0 )
+		output.erase(output.size() - 4);
+
+	clock_t start = clock();
+
+	AllPixLCIOBridgeReader reader;
+	if ( !reader.Open(input) ) {
+		cout << "can't read " << input << endl;
+		return 1;
+	}
+
+	AllPixLCIOBridgeWriter::SetFormat("text");
+	AllPixLCIOBridgeWriter writer(output);
+
+	AllPixLCIOBridgeEvent ev;
+	long nEvents = 0;
+	while ( reader.Next(ev) ) {
+		writer.Write(ev);
+		nEvents++;
+	}
+	writer.Close();
+
+	cout << "wrote " << output << ".txt : " << nEvents << " events in "
+			<< (double)(clock() - start)/CLOCKS_PER_SEC << " s" << endl;
+
+	return 0;
+}
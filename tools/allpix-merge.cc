@@ -0,0 +1,562 @@
+/**
+ *  Merges the ROOT outputs of the jobs of a campaign (one configuration
+ *  split in many jobs), one output per detector/file kind, outputs
+ *  merged in parallel.
+ *
+ *  allpix-merge [-j threads] [-c algorithm[:level]] [-k]
+ *               -o <output.root> <job 0 input.root> <job 1 input.root> ...
+ *              [-o <output.root> <job 0 input.root> <job 1 input.root> ...] ...
+ *
+ *  Every -o starts a group, its inputs are given in job order, the same
+ *  number of jobs in every group (i.e. one group per MPXNtuple_*_det_N,
+ *  one for the Hits file, one per RD53_N).  The kind of file is taken
+ *  from its trees: MPXTree (frames), AllPixHits (hits, object or
+ *  columns format) or tree (RD53).
+ *
+ *  Ids: every job starts its runs (frames) at 0.  The run/frame Ids of
+ *  job k are shifted to follow the last Id of job k-1, the same shift
+ *  for all the files of the job (fFrameId in the frames, run in the
+ *  hits).  Geant4 starts the event Ids again at every run, so the hits
+ *  event Ids are shifted per job and per run (in run order within a
+ *  job) to follow the last event of the previous run, and the merged
+ *  event Ids are a global sequence.  Runs or jobs already numbered
+ *  after the previous one are not shifted.  -k keeps the Ids untouched.
+ *
+ *  Columns hits: the process/volume codes of every input are mapped to
+ *  one merged AllPixHitsCodes table.
+ *
+ *  Output compression: -c (as /allpix/config/setCompression), or by
+ *  default the one of the first input.  An input which needs no change
+ *  (no Id shift, same codes) and has the output's compression is copied
+ *  basket by basket (fast merge, no decompression).
+ */
+
+#include "allpix_dm.h"
+#include "AllPix_Hits_WriteToEntuple.h"
+#include "AllPixOutputSettings.hh"
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <RVersion.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <climits>
+
+using namespace std;
+
+enum {
+	kUnknown = 0,
+	kFrames,
+	kHitsObject,
+	kHitsColumns,
+	kRD53
+};
+
+struct MergeGroup {
+	string output;
+	vector<string> inputs;
+	int kind;
+	// results
+	Long64_t entries;
+	int fastInputs;
+	double seconds;
+	bool ok;
+};
+
+// Event Id range of one run of a job, and the shift given to it
+struct RunEvents {
+	Long64_t eventMin, eventMax;
+	Long64_t eventShift;
+};
+
+// Id range of the files of one job, and the shifts given to it.  The
+//  events by (unshifted) run Id.
+struct JobIds {
+	Long64_t runMin, runMax;
+	Long64_t runShift;
+	map<Long64_t, RunEvents> runs;
+
+	Long64_t EventShift(Long64_t run) const {
+		map<Long64_t, RunEvents>::const_iterator itr = runs.find(run);
+		return itr == runs.end() ? 0 : itr->second.eventShift;
+	};
+	bool EventsShifted() const {
+		map<Long64_t, RunEvents>::const_iterator itr = runs.begin();
+		for( ; itr != runs.end() ; itr++) if(itr->second.eventShift != 0) return true;
+		return false;
+	};
+};
+
+static mutex g_coutMutex;
+
+static const char * TreeName(int kind) {
+
+	switch(kind) {
+	case kFrames: return "MPXTree";
+	case kHitsObject:
+	case kHitsColumns: return "AllPixHits";
+	case kRD53: return "tree";
+	}
+	return "";
+}
+
+static int FileKind(const string & file) {
+
+	TFile * f = TFile::Open(file.c_str());
+	if(!f || f->IsZombie()) {
+		delete f;
+		return kUnknown;
+	}
+
+	int kind = kUnknown;
+	TTree * t = 0x0;
+	if(f->Get("MPXTree")) kind = kFrames;
+	else if((t = (TTree *) f->Get("AllPixHits"))) kind = t->GetBranch("SimpleHits") ? kHitsObject : kHitsColumns;
+	else if(f->Get("tree")) kind = kRD53;
+
+	f->Close();
+	delete f;
+
+	return kind;
+}
+
+static void UpdateRange(Long64_t & min, Long64_t & max, TTree * t, const char * column) {
+
+	if(t->GetEntries() == 0 || !t->GetLeaf(column)) return;
+	Long64_t lo = (Long64_t) t->GetMinimum(column);
+	Long64_t hi = (Long64_t) t->GetMaximum(column);
+	if(lo < min) min = lo;
+	if(hi > max) max = hi;
+
+}
+
+/**
+ *  Event Id ranges per run of a hits tree.
+ */
+static void UpdateRunEvents(map<Long64_t, RunEvents> & runs, TTree * t) {
+
+	Long64_t n = t->GetEntries();
+	if(n == 0 || !t->GetLeaf("run") || !t->GetLeaf("event")) return;
+
+	t->SetEstimate(n);
+	t->Draw("run:event", "", "goff");
+	for(Long64_t i = 0 ; i < n ; i++) {
+		Long64_t run = (Long64_t) t->GetV1()[i];
+		Long64_t event = (Long64_t) t->GetV2()[i];
+		map<Long64_t, RunEvents>::iterator itr = runs.find(run);
+		if(itr == runs.end()) {
+			RunEvents r;
+			r.eventMin = r.eventMax = event;
+			r.eventShift = 0;
+			runs[run] = r;
+		} else {
+			if(event < itr->second.eventMin) itr->second.eventMin = event;
+			if(event > itr->second.eventMax) itr->second.eventMax = event;
+		}
+	}
+
+}
+
+/**
+ *  Id ranges of every job over all the groups, then the shifts: job k
+ *  goes right after the last Id of job k-1 unless it already does, the
+ *  events of a run right after the ones of the previous run.
+ */
+static void ComputeShifts(const vector<MergeGroup> & groups, vector<JobIds> & jobs, bool keepIds) {
+
+	size_t nJobs = groups[0].inputs.size();
+	jobs.resize(nJobs);
+	for(size_t k = 0 ; k < nJobs ; k++) {
+		jobs[k].runMin = LLONG_MAX;
+		jobs[k].runMax = LLONG_MIN;
+		jobs[k].runShift = 0;
+		jobs[k].runs.clear();
+	}
+	if(keepIds) return;
+
+	for(size_t g = 0 ; g < groups.size() ; g++) {
+		int kind = groups[g].kind;
+		if(kind == kRD53) continue;
+		for(size_t k = 0 ; k < nJobs ; k++) {
+			TFile * f = TFile::Open(groups[g].inputs[k].c_str());
+			if(!f || f->IsZombie()) { delete f; continue; }
+			TTree * t = (TTree *) f->Get(TreeName(kind));
+			if(t) {
+				UpdateRange(jobs[k].runMin, jobs[k].runMax, t, kind == kFrames ? "fFrameId" : "run");
+				if(kind != kFrames) UpdateRunEvents(jobs[k].runs, t);
+			}
+			f->Close();
+			delete f;
+		}
+	}
+
+	Long64_t nextRun = LLONG_MIN, nextEvent = LLONG_MIN;
+	for(size_t k = 0 ; k < nJobs ; k++) {
+		if(jobs[k].runMax >= jobs[k].runMin) {
+			if(nextRun > jobs[k].runMin) jobs[k].runShift = nextRun - jobs[k].runMin;
+			nextRun = jobs[k].runMax + jobs[k].runShift + 1;
+		}
+		map<Long64_t, RunEvents>::iterator itr = jobs[k].runs.begin();
+		for( ; itr != jobs[k].runs.end() ; itr++) {
+			RunEvents & r = itr->second;
+			if(nextEvent > r.eventMin) r.eventShift = nextEvent - r.eventMin;
+			nextEvent = r.eventMax + r.eventShift + 1;
+		}
+	}
+
+}
+
+/**
+ *  Columns hits codes.  Maps the codes of one input to the merged
+ *  tables, true if the mapping is the identity.
+ */
+struct CodeTables {
+	vector<string> process;
+	vector<string> volume;
+	map<string, UShort_t> processIndex;
+	map<string, UShort_t> volumeIndex;
+};
+
+static bool MapNames(const vector<string> & names, vector<string> & merged, map<string, UShort_t> & index,
+		vector<UShort_t> & remap) {
+
+	bool identity = true;
+	remap.resize(names.size());
+	for(size_t i = 0 ; i < names.size() ; i++) {
+		map<string, UShort_t>::iterator itr = index.find(names[i]);
+		UShort_t code;
+		if(itr != index.end()) code = itr->second;
+		else if(merged.size() < 0xffff) {
+			code = merged.size();
+			index[names[i]] = code;
+			merged.push_back(names[i]);
+		} else code = 0xffff; // overflow, as the writer
+		remap[i] = code;
+		if(code != i) identity = false;
+	}
+
+	return identity;
+}
+
+static bool MapCodes(TFile * in, CodeTables & tables, vector<UShort_t> & processRemap, vector<UShort_t> & volumeRemap) {
+
+	processRemap.clear();
+	volumeRemap.clear();
+
+	TTree * codes = (TTree *) in->Get("AllPixHitsCodes");
+	if(!codes || codes->GetEntries() == 0) return true;
+
+	vector<string> * process = 0x0;
+	vector<string> * volume = 0x0;
+	codes->SetBranchAddress("process", &process);
+	codes->SetBranchAddress("volume", &volume);
+	codes->GetEntry(0);
+
+	bool identity = MapNames(*process, tables.process, tables.processIndex, processRemap);
+	identity = MapNames(*volume, tables.volume, tables.volumeIndex, volumeRemap) && identity;
+
+	codes->ResetBranchAddresses();
+	delete process;
+	delete volume;
+
+	return identity;
+}
+
+/**
+ *  Columns hits, one buffer per branch shared by the input and the
+ *  output tree.  Arrays are sized for the largest nHits of the input.
+ */
+struct Column {
+	string name;
+	int typeSize;
+	bool array;
+	vector<char> buf;
+};
+
+static void SetupColumns(TTree * in, TTree * out, vector<Column> & columns) {
+
+	columns.clear();
+	Long64_t maxHits = (Long64_t) in->GetMaximum("nHits");
+	if(maxHits < 1) maxHits = 1;
+
+	TObjArray * branches = in->GetListOfBranches();
+	for(int i = 0 ; i < branches->GetEntriesFast() ; i++) {
+		TBranch * b = (TBranch *) branches->At(i);
+		TLeaf * leaf = (TLeaf *) b->GetListOfLeaves()->At(0);
+		Column c;
+		c.name = b->GetName();
+		c.typeSize = leaf->GetLenType();
+		c.array = leaf->GetLeafCount() != 0x0;
+		c.buf.resize(c.typeSize * (c.array ? maxHits : 1));
+		columns.push_back(c);
+	}
+
+	for(size_t i = 0 ; i < columns.size() ; i++) {
+		in->SetBranchAddress(columns[i].name.c_str(), &columns[i].buf[0]);
+		out->SetBranchAddress(columns[i].name.c_str(), &columns[i].buf[0]);
+	}
+
+}
+
+static void Remap(Column * c, Int_t n, const vector<UShort_t> & remap) {
+
+	if(!c) return;
+	UShort_t * codes = (UShort_t *) &c->buf[0];
+	for(Int_t i = 0 ; i < n ; i++)
+		if(codes[i] < remap.size()) codes[i] = remap[codes[i]];
+
+}
+
+static void MergeGroupFiles(MergeGroup & group, const vector<JobIds> & jobs, bool setCompression) {
+
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	group.ok = false;
+	group.entries = 0;
+	group.fastInputs = 0;
+
+	TFile * out = TFile::Open(group.output.c_str(), "RECREATE");
+	if(!out || out->IsZombie()) {
+		lock_guard<mutex> lock(g_coutMutex);
+		cout << "[ERROR] can't create " << group.output << endl;
+		delete out;
+		return;
+	}
+	if(setCompression) AllPixOutputSettings::GetInstance()->ApplyTo(out);
+
+	TTree * outTree = 0x0;
+	CodeTables tables;
+
+	for(size_t k = 0 ; k < group.inputs.size() ; k++) {
+
+		TFile * in = TFile::Open(group.inputs[k].c_str());
+		TTree * t = (in && !in->IsZombie()) ? (TTree *) in->Get(TreeName(group.kind)) : 0x0;
+		if(!t) {
+			lock_guard<mutex> lock(g_coutMutex);
+			cout << "[ERROR] " << group.inputs[k] << " : no " << TreeName(group.kind) << " tree, skipped" << endl;
+			delete in;
+			continue;
+		}
+
+		if(!outTree) {
+			if(!setCompression) out->SetCompressionSettings(in->GetCompressionSettings());
+			out->cd();
+			outTree = t->CloneTree(0);
+			outTree->ResetBranchAddresses();
+		}
+
+		Long64_t runShift = group.kind == kRD53 ? 0 : jobs[k].runShift;
+		bool eventsShifted = group.kind != kRD53 && group.kind != kFrames && jobs[k].EventsShifted();
+
+		vector<UShort_t> processRemap, volumeRemap;
+		bool sameCodes = true;
+		if(group.kind == kHitsColumns) sameCodes = MapCodes(in, tables, processRemap, volumeRemap);
+
+		bool copy = runShift == 0 && !eventsShifted && sameCodes;
+		bool fast = copy && in->GetCompressionSettings() == out->GetCompressionSettings();
+		Long64_t n = t->GetEntries();
+
+		if(copy) {
+
+			// basket copy when possible, else TTree's own entry copy
+			outTree->CopyEntries(t, -1, fast ? "fast" : "");
+			if(fast) group.fastInputs++;
+
+		} else if(group.kind == kFrames) {
+
+			FrameStruct * frame = new FrameStruct("");
+			t->SetBranchAddress("FramesData", &frame);
+			outTree->SetBranchAddress("FramesData", &frame);
+			for(Long64_t i = 0 ; i < n ; i++) {
+				t->GetEntry(i);
+				frame->SetId(frame->GetFrameId() + runShift);
+				outTree->Fill();
+			}
+			delete frame;
+
+		} else if(group.kind == kHitsObject) {
+
+			SimpleHits * hits = new SimpleHits;
+			t->SetBranchAddress("SimpleHits", &hits);
+			outTree->SetBranchAddress("SimpleHits", &hits);
+			for(Long64_t i = 0 ; i < n ; i++) {
+				t->GetEntry(i);
+				hits->event += jobs[k].EventShift(hits->run);
+				hits->run += runShift;
+				outTree->Fill();
+			}
+			delete hits;
+
+		} else if(group.kind == kHitsColumns) {
+
+			vector<Column> columns;
+			SetupColumns(t, outTree, columns);
+			Column * run = 0x0, * event = 0x0, * nHits = 0x0;
+			Column * process = 0x0, * trackVolume = 0x0, * parentVolume = 0x0;
+			for(size_t c = 0 ; c < columns.size() ; c++) {
+				if(columns[c].name == "run") run = &columns[c];
+				else if(columns[c].name == "event") event = &columns[c];
+				else if(columns[c].name == "nHits") nHits = &columns[c];
+				else if(columns[c].name == "process") process = &columns[c];
+				else if(columns[c].name == "trackVolume") trackVolume = &columns[c];
+				else if(columns[c].name == "parentVolume") parentVolume = &columns[c];
+			}
+
+			for(Long64_t i = 0 ; i < n ; i++) {
+				t->GetEntry(i);
+				if(event) *(Int_t *) &event->buf[0] += jobs[k].EventShift(run ? *(Int_t *) &run->buf[0] : 0);
+				if(run) *(Int_t *) &run->buf[0] += runShift;
+				Int_t nh = nHits ? *(Int_t *) &nHits->buf[0] : 0;
+				Remap(process, nh, processRemap);
+				Remap(trackVolume, nh, volumeRemap);
+				Remap(parentVolume, nh, volumeRemap);
+				outTree->Fill();
+			}
+
+		}
+
+		group.entries += n;
+		outTree->ResetBranchAddresses();
+		t->ResetBranchAddresses();
+		in->Close();
+		delete in;
+
+	}
+
+	if(outTree) {
+		out->cd();
+		outTree->Write();
+		if(group.kind == kHitsColumns) {
+			TTree * codes = new TTree("AllPixHitsCodes", "names of the process and volume codes, index = code");
+			vector<string> * processNames = &tables.process;
+			vector<string> * volumeNames = &tables.volume;
+			codes->Branch("process", &processNames);
+			codes->Branch("volume", &volumeNames);
+			codes->Fill();
+			codes->Write();
+		}
+		lock_guard<mutex> lock(g_coutMutex);
+		AllPixOutputSettings::GetInstance()->PrintSummary(outTree, group.output.c_str(), cout);
+	}
+
+	out->Close();
+	delete out;
+
+	group.ok = outTree != 0x0;
+	group.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+}
+
+static void Usage(const char * name) {
+
+	cout << "use: " << name << " [-j threads] [-c algorithm[:level]] [-k]" << endl
+			<< "        -o <output.root> <job 0 input.root> <job 1 input.root> ..." << endl
+			<< "       [-o <output.root> <job 0 input.root> <job 1 input.root> ...] ..." << endl
+			<< "  -j  number of outputs merged in parallel, default: number of cores" << endl
+			<< "  -c  output compression, default|zlib|lzma|lz4|zstd[:level], default: the first input's" << endl
+			<< "  -k  keep the run/frame/event Ids as they are" << endl;
+
+}
+
+int main(int argc, char ** argv) {
+
+	unsigned int nThreads = thread::hardware_concurrency();
+	bool keepIds = false;
+	bool setCompression = false;
+	vector<MergeGroup> groups;
+
+	for(int a = 1 ; a < argc ; a++) {
+		string arg = argv[a];
+		if(arg == "-j" && a + 1 < argc) nThreads = atoi(argv[++a]);
+		else if(arg == "-k") keepIds = true;
+		else if(arg == "-c" && a + 1 < argc) {
+			string c = argv[++a];
+			size_t colon = c.find(':');
+			int level = colon == string::npos ? -1 : atoi(c.substr(colon + 1).c_str());
+			if(!AllPixOutputSettings::GetInstance()->SetCompression(c.substr(0, colon).c_str(), level)) return 1;
+			setCompression = true;
+		}
+		else if(arg == "-o" && a + 1 < argc) {
+			groups.push_back(MergeGroup());
+			groups.back().output = argv[++a];
+		}
+		else if(arg[0] != '-' && !groups.empty()) groups.back().inputs.push_back(arg);
+		else {
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(groups.empty()) {
+		Usage(argv[0]);
+		return 1;
+	}
+	for(size_t g = 0 ; g < groups.size() ; g++) {
+		if(groups[g].inputs.size() != groups[0].inputs.size() || groups[g].inputs.empty()) {
+			cout << "[ERROR] every output needs one input per job, " << groups[g].output << " has "
+					<< groups[g].inputs.size() << ", " << groups[0].output << " has " << groups[0].inputs.size() << endl;
+			return 1;
+		}
+		groups[g].kind = FileKind(groups[g].inputs[0]);
+		if(groups[g].kind == kUnknown) {
+			cout << "[ERROR] " << groups[g].inputs[0] << " is not a frames, hits or RD53 file" << endl;
+			return 1;
+		}
+	}
+	if(nThreads < 1) nThreads = 1;
+	if(nThreads > groups.size()) nThreads = groups.size();
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+	ROOT::EnableThreadSafety();
+#endif
+
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+	vector<JobIds> jobs;
+	ComputeShifts(groups, jobs, keepIds);
+	for(size_t k = 0 ; k < jobs.size() ; k++) {
+		if(jobs[k].runShift != 0)
+			cout << "job " << k << " : run/frame Ids +" << jobs[k].runShift << endl;
+		map<Long64_t, RunEvents>::const_iterator itr = jobs[k].runs.begin();
+		for( ; itr != jobs[k].runs.end() ; itr++)
+			if(itr->second.eventShift != 0)
+				cout << "job " << k << " run " << itr->first << " : event Ids +" << itr->second.eventShift << endl;
+	}
+
+	// one output per thread at a time
+	atomic<size_t> next(0);
+	vector<thread> workers;
+	for(unsigned int i = 0 ; i < nThreads ; i++) {
+		workers.push_back(thread([&]() {
+			size_t g;
+			while((g = next++) < groups.size()) MergeGroupFiles(groups[g], jobs, setCompression);
+		}));
+	}
+	for(size_t i = 0 ; i < workers.size() ; i++) workers[i].join();
+
+	int failed = 0;
+	for(size_t g = 0 ; g < groups.size() ; g++) {
+		if(!groups[g].ok) {
+			failed++;
+			continue;
+		}
+		cout << groups[g].output << " : " << groups[g].entries << " entries from " << groups[g].inputs.size()
+				<< " jobs (" << groups[g].fastInputs << " fast merged) in " << groups[g].seconds << " s" << endl;
+	}
+
+	cout << "merged " << groups.size() - failed << "/" << groups.size() << " outputs with " << nThreads
+			<< " thread(s) in " << chrono::duration<double>(chrono::steady_clock::now() - t0).count() << " s" << endl;
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+/**
+ *  Scaling of the per event output with the number of worker threads.
+ *  Every thread simulates events (a busy wait of the given time, the
+ *  Geant4 part) and writes each one to the shared lcio bridge files,
+ *  either under one lock (as AllPixRun did) or through the
+ *  AllPixOutputQueue (as AllPixRun does now).
+ *
+ *  allpix-output-bench [-e events per thread] [-w event time us]
+ *                      [-p pixels per plane] [-q queue depth] [threads ...]
+ *
+ *  Prints, per number of threads, the events/s of both and the speedup
+ *  with respect to one thread.  Writes bench_lcio*.txt in the current
+ *  directory.
+ */
+
+#include "AllPixLCIOBridge.hh"
+#include "AllPixOutputQueue.hh"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+typedef std::chrono::steady_clock benchClock;
+
+static int g_events = 2000;
+static double g_eventTime = 200.; // [us]
+static int g_pixels = 50;
+static int g_depth = 1024;
+
+static void simulate(double us) {
+
+	benchClock::time_point t0 = benchClock::now();
+	while(std::chrono::duration<double, std::micro>(benchClock::now() - t0).count() < us);
+
+}
+
+static void fillEvent(AllPixLCIOBridgeEvent & ev, int frame) {
+
+	ev.Clear(frame);
+	for(int plane = 0 ; plane < 6 ; plane++) {
+		ev.AddPlane(300 + plane);
+		for(int i = 0 ; i < g_pixels ; i++) ev.AddPixel((frame + i) % 1152, (7*i) % 576, 1);
+	}
+
+}
+
+/**
+ * events/s of nThreads workers, the lcio files shared
+ */
+static double run(int nThreads, bool queued) {
+
+	AllPixLCIOBridgeWriter f(queued ? "bench_lcio_queue" : "bench_lcio_lock");
+	std::mutex lock;
+
+	if(queued) AllPixOutputQueue::GetInstance()->Start(g_depth);
+
+	benchClock::time_point t0 = benchClock::now();
+
+	vector<std::thread> workers;
+	for(int t = 0 ; t < nThreads ; t++) {
+		workers.push_back(std::thread([&f, &lock, queued, t]{
+			AllPixLCIOBridgeEvent ev;
+			for(int i = 0 ; i < g_events ; i++) {
+				simulate(g_eventTime);
+				fillEvent(ev, t*g_events + i);
+				if(queued) {
+					std::shared_ptr<AllPixLCIOBridgeEvent> job(new AllPixLCIOBridgeEvent);
+					std::swap(*job, ev);
+					AllPixLCIOBridgeWriter * fp = &f;
+					AllPixOutputQueue::GetInstance()->Push([fp, job]{ fp->Write(*job); });
+				} else {
+					std::lock_guard<std::mutex> l(lock);
+					f.Write(ev);
+				}
+			}
+		}));
+	}
+	for(size_t t = 0 ; t < workers.size() ; t++) workers[t].join();
+
+	// everything on disk
+	if(queued) AllPixOutputQueue::GetInstance()->Stop();
+	f.Close();
+
+	double seconds = std::chrono::duration<double>(benchClock::now() - t0).count();
+
+	return nThreads*g_events/seconds;
+}
+
+int main(int argc, char ** argv){
+
+	vector<int> threads;
+
+	for(int i = 1 ; i < argc ; i++) {
+		if(!strcmp(argv[i], "-e") && i+1 < argc) g_events = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-w") && i+1 < argc) g_eventTime = atof(argv[++i]);
+		else if(!strcmp(argv[i], "-p") && i+1 < argc) g_pixels = atoi(argv[++i]);
+		else if(!strcmp(argv[i], "-q") && i+1 < argc) g_depth = atoi(argv[++i]);
+		else if(argv[i][0] != '-') threads.push_back(atoi(argv[i]));
+		else {
+			cout << "usage: " << argv[0] << " [-e events per thread] [-w event time us]"
+			     << " [-p pixels per plane] [-q queue depth] [threads ...]" << endl;
+			return 1;
+		}
+	}
+
+	if(threads.empty()) {
+		threads.push_back(1);
+		threads.push_back(2);
+		threads.push_back(4);
+		threads.push_back(8);
+	}
+
+	AllPixLCIOBridgeWriter::SetFormat("both");
+
+	cout << g_events << " events per thread, " << g_eventTime << " us per event, "
+	     << 6*g_pixels << " pixels per event, " << std::thread::hardware_concurrency() << " cores" << endl;
+	cout << setw(8) << "threads" << setw(14) << "lock ev/s" << setw(10) << "speedup"
+	     << setw(14) << "queue ev/s" << setw(10) << "speedup" << endl;
+
+	double lock1 = 0., queue1 = 0.;
+	for(size_t i = 0 ; i < threads.size() ; i++) {
+		double lockRate = run(threads[i], false);
+		double queueRate = run(threads[i], true);
+		if(i == 0) {
+			lock1 = lockRate/threads[i];
+			queue1 = queueRate/threads[i];
+		}
+		cout << setw(8) << threads[i]
+		     << setw(14) << (long)lockRate << setw(10) << setprecision(3) << lockRate/lock1
+		     << setw(14) << (long)queueRate << setw(10) << setprecision(3) << queueRate/queue1 << endl;
+	}
+
+	return 0;
+}